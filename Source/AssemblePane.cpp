@@ -1,23 +1,47 @@
 
 #include "AssemblePane.h"
 
+#include <cmath>
 #include <cstdlib>
 #include <memory>
 #include <string>
 
+#include "Log.h"
+#include "Tracer.h"
 #include "WaveDisplay.h"
 #include "juce_core/system/juce_PlatformDefs.h"
 #include "juce_gui_basics/juce_gui_basics.h"
 
 AssemblePane::AssemblePane(AudioPlayer* _player, juce::AudioFormatManager& _formatManagerToUse,
-                           juce::AudioThumbnailCache& _cacheToUse)
-    : player(_player), waveDisplay(_formatManagerToUse, _cacheToUse), liveAudioVisualiser(new LiveAudioVisualiser()) {
+                           juce::AudioThumbnailCache& _cacheToUse, TrackAnalyser& _trackAnalyser,
+                           MemoryGovernor& _memoryGovernor)
+    : waveDisplay(_formatManagerToUse, _cacheToUse, _trackAnalyser),
+      meterDisplay(_player->getMeter(), "DECK"),
+      player(_player),
+      memoryGovernor(_memoryGovernor) {
         // In your constructor, you should add any child components, and initialise any special settings that your
         // component needs.
 
         setupButton(&playButton);
         setupButton(&stopButton);
         setupButton(&loadButton);
+        setupButton(&syncButton);
+        syncButton.setClickingTogglesState(true);
+        syncButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::forestgreen);
+        setupButton(&keyLockButton);
+        keyLockButton.setClickingTogglesState(true);
+        keyLockButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::forestgreen);
+
+        // item ids are the quality tiers plus one
+        for (auto quality : {TimeStretchAudioSource::Quality::draft, TimeStretchAudioSource::Quality::normal,
+                             TimeStretchAudioSource::Quality::high}) {
+                keyLockQualityBox.addItem(TimeStretchAudioSource::getQualityName(quality), (int) quality + 1);
+        }
+        keyLockQualityBox.setSelectedId((int) TimeStretchAudioSource::Quality::normal + 1, juce::dontSendNotification);
+        keyLockQualityBox.onChange = [this] {
+                player->setKeyLockQuality((TimeStretchAudioSource::Quality) (keyLockQualityBox.getSelectedId() - 1));
+        };
+        addAndMakeVisible(keyLockQualityBox);
 
         otherLookAndFeel1.setColour(juce::Slider::thumbColourId, juce::Colours::orangered);
         otherLookAndFeel2.setColour(juce::Slider::thumbColourId, juce::Colours::forestgreen);
@@ -46,23 +70,44 @@ AssemblePane::AssemblePane(AudioPlayer* _player, juce::AudioFormatManager& _form
         setupSlider(&speedSlider, &otherLookAndFeel2, speedSliderParams);
         setupLabel(&speedSlider, &speedLabel, "Speed");
 
-        SliderParams dampingSliderParams = {
+        SliderParams reverbSliderParams = {
             .range = {0.0, 1.0},
             .defaultValue = 0.0,
             .numDecimalPlaces = 2,
             .style = juce::Slider::LinearHorizontal,
-            .textValueSuffix = new std::string(" factor"),
+            .textValueSuffix = " wet",
         };
 
-        setupSlider(&dampingSlider, &otherLookAndFeel3, dampingSliderParams);
-        setupLabel(&dampingSlider, &dampingLabel, "Damping");
+        setupSlider(&reverbSlider, &otherLookAndFeel3, reverbSliderParams);
+        setupLabel(&reverbSlider, &reverbLabel, "Reverb");
+        setupButton(&loadImpulseButton);
+
+        // item ids are log2 of the length in beats plus three, 1/4 beat up to 16 beats
+        for (int id = 1; id <= 7; ++id) {
+                const double beats = std::pow(2.0, id - 3);
+                beatLoopBox.addItem(beats < 1.0 ? "1/" + juce::String((int) (1.0 / beats)) : juce::String((int) beats),
+                                    id);
+        }
+        beatLoopBox.setTextWhenNothingSelected("Loop");
+        beatLoopBox.onChange = [this] {
+                if (beatLoopBox.getSelectedId() > 0) {
+                        player->setBeatLoop(std::pow(2.0, beatLoopBox.getSelectedId() - 3));
+                        // back to "Loop", so the same length can be chosen again
+                        beatLoopBox.setSelectedId(0, juce::dontSendNotification);
+                }
+        };
+        addAndMakeVisible(beatLoopBox);
+        setupButton(&loopInButton);
+        setupButton(&loopOutButton);
+        setupButton(&exitLoopButton);
+        exitLoopButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::forestgreen);
 
         SliderParams positionSliderParams = {
             .range = {0.0, 100.0},
             .defaultValue = 10.0,
             .numDecimalPlaces = 2,
             .style = juce::Slider::LinearHorizontal,
-            .textValueSuffix = new std::string(" % of track"),
+            .textValueSuffix = " % of track",
         };
 
         setupSlider(&positionSlider, &otherLookAndFeel3, positionSliderParams);
@@ -74,7 +119,7 @@ AssemblePane::AssemblePane(AudioPlayer* _player, juce::AudioFormatManager& _form
             .defaultValue = 0.0,
             .numDecimalPlaces = 1,
             .style = juce::Slider::Rotary,
-            .textValueSuffix = new std::string("Bass"),
+            .textValueSuffix = "Bass",
         };
 
         // Setup label for knobs
@@ -83,7 +128,7 @@ AssemblePane::AssemblePane(AudioPlayer* _player, juce::AudioFormatManager& _form
             .defaultValue = 0.0,
             .numDecimalPlaces = 1,
             .style = juce::Slider::Rotary,
-            .textValueSuffix = new std::string("Mid"),
+            .textValueSuffix = "Mid",
         };
 
         // Setup label for knobs
@@ -92,38 +137,34 @@ AssemblePane::AssemblePane(AudioPlayer* _player, juce::AudioFormatManager& _form
             .defaultValue = 0.0,
             .numDecimalPlaces = 1,
             .style = juce::Slider::Rotary,
-            .textValueSuffix = new std::string("Tremble"),
+            .textValueSuffix = "Tremble",
         };
 
         setupSlider(&bassSlider,  &otherLookAndFeel2, bassKnobParam);
         setupSlider(&midSlider, &otherLookAndFeel1, midKnobParam);
         setupSlider(&trembleSlider, &otherLookAndFeel1, trembleKnobParam);
 
+        // the DJ filter, low-pass to the left of centre and high-pass to the right
         SliderParams freqSliderParams = {
-            .range = {20.0, 20000.0},
-            .defaultValue = 20.0,
-            .numDecimalPlaces = 0,
+            .range = {-1.0, 1.0},
+            .defaultValue = 0.0,
+            .numDecimalPlaces = 2,
             .style = juce::Slider::Rotary,
-            .textValueSuffix = new std::string(" Hz"),
         };
 
-        setupSlider(&freqSlider, &otherLookAndFeel1, freqSliderParams);
+        freqSlider.textFromValueFunction = [](double value) { return DJFilter::getDescription(value); };
+        setupSlider(&freqSlider, &otherLookAndFeel3, freqSliderParams);
+        freqSlider.setDoubleClickReturnValue(true, 0.0);
         addAndMakeVisible(waveDisplay);
+        memoryGovernor.addClient(&waveDisplay);
 
-        if (liveAudioVisualiser == nullptr) {
-                DBG("AssemblePane.cpp::liveAudioVisualiser is null");
-        }
-
-        liveAudioVisualiser->setBufferSize(1024);
-        liveAudioVisualiser->setSamplesPerBlock(16);
-
-        addAndMakeVisible(*liveAudioVisualiser);
-        player->setPlayerVisualiser(liveAudioVisualiser);
+        addAndMakeVisible(meterDisplay);
 
-        startTimer(500);
+        // the playhead follows the audio clock at display rate
+        startTimerHz(60);
 }
 
-AssemblePane::~AssemblePane() {};
+AssemblePane::~AssemblePane() { memoryGovernor.removeClient(&waveDisplay); };
 
 void AssemblePane::setupButton(juce::Button* component) {
         addAndMakeVisible(component);
@@ -143,9 +184,8 @@ void AssemblePane::setupSlider(juce::Slider* component, LookAndFeel* lookAndFeel
         component->setTextBoxStyle(juce::Slider::TextBoxLeft, false, component->getTextBoxWidth(),
                                    component->getTextBoxHeight());
 
-        if (params.textValueSuffix != nullptr) {
-                component->setTextValueSuffix(*params.textValueSuffix);
-                DBG(*params.textValueSuffix);
+        if (params.textValueSuffix.isNotEmpty()) {
+                component->setTextValueSuffix(params.textValueSuffix);
         }
 };
 
@@ -171,12 +211,15 @@ void AssemblePane::resized() {
         double width = getWidth() - 20;
         int sliderLeftMargin = 60;
 
-        double thirdWidth = width / 3;
+        double sixthWidth = width / 6;
 
         // 1st (1) row of buttons
-        playButton.setBounds(15, 0, thirdWidth - 10, rowHeight);
-        stopButton.setBounds(thirdWidth + 15, 0, thirdWidth - 10, rowHeight);
-        loadButton.setBounds(2 * thirdWidth + 15, 0, thirdWidth - 10, rowHeight);
+        playButton.setBounds(15, 0, sixthWidth - 10, rowHeight);
+        stopButton.setBounds(sixthWidth + 15, 0, sixthWidth - 10, rowHeight);
+        loadButton.setBounds(2 * sixthWidth + 15, 0, sixthWidth - 10, rowHeight);
+        syncButton.setBounds(3 * sixthWidth + 15, 0, sixthWidth - 10, rowHeight);
+        keyLockButton.setBounds(4 * sixthWidth + 15, 0, sixthWidth - 10, rowHeight);
+        keyLockQualityBox.setBounds(5 * sixthWidth + 15, 0, sixthWidth - 10, rowHeight);
 
         // 2nd (3) row of rotary sliders
         volSlider.setBounds(sliderLeftMargin, 10 + playButton.getBounds().getBottom(), width / 2 - sliderLeftMargin,
@@ -187,31 +230,36 @@ void AssemblePane::resized() {
         // 3nd (5) row of rotary sliders
         positionSlider.setBounds(sliderLeftMargin, 10 + speedSlider.getBounds().getBottom(), width - sliderLeftMargin,
                                  rowHeight);
-        dampingSlider.setBounds(sliderLeftMargin, 10 + positionSlider.getBounds().getBottom(), width - sliderLeftMargin,
-                                rowHeight);
+        reverbSlider.setBounds(sliderLeftMargin, 10 + positionSlider.getBounds().getBottom(),
+                               width / 2 - sliderLeftMargin - 90, rowHeight);
+        loadImpulseButton.setBounds(reverbSlider.getBounds().getRight() + 5, reverbSlider.getY(), 80, rowHeight);
 
-        // 4th (7) row of rotary sliders
-        bassSlider.setBounds(sliderLeftMargin, 10 + dampingSlider.getBounds().getBottom(), width / 3 - sliderLeftMargin,
-                             rowHeight * 2);
-        midSlider.setBounds(bassSlider.getBounds().getRight(), 10 + dampingSlider.getBounds().getBottom(),
-                            width / 3 - sliderLeftMargin, rowHeight * 2);
-        trembleSlider.setBounds(midSlider.getBounds().getRight(), 10 + dampingSlider.getBounds().getBottom(),
-                                width / 3 - sliderLeftMargin, rowHeight * 2);
+        // loop controls share the reverb row
+        double loopWidth = width / 8;
+        beatLoopBox.setBounds(width / 2 + 15, reverbSlider.getY(), loopWidth - 5, rowHeight);
+        loopInButton.setBounds(width / 2 + loopWidth + 15, reverbSlider.getY(), loopWidth - 5, rowHeight);
+        loopOutButton.setBounds(width / 2 + 2 * loopWidth + 15, reverbSlider.getY(), loopWidth - 5, rowHeight);
+        exitLoopButton.setBounds(width / 2 + 3 * loopWidth + 15, reverbSlider.getY(), loopWidth - 5, rowHeight);
+
+        // 4th (7) row of rotary sliders, the EQ and the filter
+        double knobWidth = (width - sliderLeftMargin) / 4;
+        bassSlider.setBounds(sliderLeftMargin, 10 + reverbSlider.getBounds().getBottom(), knobWidth, rowHeight * 2);
+        midSlider.setBounds(bassSlider.getBounds().getRight(), bassSlider.getY(), knobWidth, rowHeight * 2);
+        trembleSlider.setBounds(midSlider.getBounds().getRight(), bassSlider.getY(), knobWidth, rowHeight * 2);
+        freqSlider.setBounds(trembleSlider.getBounds().getRight(), bassSlider.getY(), knobWidth, rowHeight * 2);
 
 
         // 5th (9) row of wave display
         waveDisplay.setBounds(5, trembleSlider.getBounds().getBottom(), width - 10, rowHeight * 2);
 
         // 6th (10) row of wave display
-        liveAudioVisualiser->setBounds(5, waveDisplay.getBounds().getBottom(), width - 10, rowHeight);
+        meterDisplay.setBounds(5, waveDisplay.getBounds().getBottom(), width - 10, rowHeight);
 }
 
 // intended to handle button click listener events
 void AssemblePane::buttonClicked(juce::Button* button) {
         if (button == &playButton) {
-                std::cout << "Play button clicked" << std::endl;
-                int secs = player->getLengthInSeconds();
-                DBG("Length of track: " << secs);
+                OTODECK_LOG(debug, "AssemblePane", "Play, length of track: " << player->getLengthInSeconds());
 
                 // player calls start function from DJaudio
                 player->start();
@@ -219,13 +267,38 @@ void AssemblePane::buttonClicked(juce::Button* button) {
         if (button == &stopButton) {
                 player->stop();
         }
+        if (button == &syncButton) {
+                player->setSyncEnabled(syncButton.getToggleState());
+        }
+        if (button == &keyLockButton) {
+                player->setKeyLockEnabled(keyLockButton.getToggleState());
+        }
+        if (button == &loopInButton) {
+                player->setLoopIn();
+        }
+        if (button == &loopOutButton) {
+                player->setLoopOut();
+        }
+        if (button == &exitLoopButton) {
+                player->exitLoop();
+        }
+        if (button == &loadImpulseButton) {
+                constexpr auto fileChooserFlags = FileBrowserComponent::canSelectFiles | FileBrowserComponent::openMode;
+
+                fChooser.launchAsync(fileChooserFlags, [this](const juce::FileChooser& chooser) {
+                        const juce::File file(chooser.getResult());
+                        if (file.existsAsFile()) {
+                                player->loadImpulseResponse(file);
+                        }
+                });
+        }
         if (button == &loadButton) {
                 constexpr auto folderChooserFlags = FileBrowserComponent::canSelectFiles |
                                                     FileBrowserComponent::openMode;
 
                 fChooser.launchAsync(folderChooserFlags, [this](const juce::FileChooser& chooser) {
                         const juce::File file(chooser.getResult());
-                        DBG(file.getFullPathName());
+                        OTODECK_LOG(debug, "AssemblePane", "Chosen file: " << file.getFullPathName());
                         loadFile(juce::URL{file});
                 });
         }
@@ -235,57 +308,72 @@ void AssemblePane::sliderValueChanged(juce::Slider* slider) {
         double value = slider->getValue();
 
         if (slider == &volSlider) {
-                std::cout << value << std::endl;
-                std::cout << "Vol Slider handle" << std::endl;
+                OTODECK_LOG(debug, "AssemblePane", "Volume slider changed " << value);
                 player->setGain(value);
-                std::cout << "After Vol Slider handle" << std::endl;
         }
 
         if (slider == &speedSlider) {
-                std::cout << "Speed Slider changed" << value << std::endl;
+                OTODECK_LOG(debug, "AssemblePane", "Speed slider changed " << value);
                 player->setSpeed(value);
         }
 
         if (slider == &positionSlider) {
-                std::cout << "Position Slider changed" << value << std::endl;
+                OTODECK_LOG(debug, "AssemblePane", "Position slider changed " << value);
                 // player->setPositionRelative(value);
                 if (abs(value - player->getPositionRelative()) > 2) {
                         player->setPositionRelative(value / 100);
                 }
         }
-        if (slider == &dampingSlider) {
-                std::cout << "Damping Slider changed" << value << std::endl;
-                player->setDamping(value);
+        if (slider == &reverbSlider) {
+                OTODECK_LOG(debug, "AssemblePane", "Reverb slider changed " << value);
+                player->setReverbWet(value);
         }
 
         if (slider == &bassSlider) {
-                std::cout << "Bass Slider changed" << value << std::endl;
+                OTODECK_LOG(debug, "AssemblePane", "Bass slider changed " << value);
                 player->setBassGain(value);
         }
 
         if (slider == &trembleSlider) {
-                std::cout << "Tremble Slider changed" << value << std::endl;
+                OTODECK_LOG(debug, "AssemblePane", "Treble slider changed " << value);
                 player->setTrebleGain(value);
         }
+
+        if (slider == &freqSlider) {
+                OTODECK_LOG(debug, "AssemblePane", "Filter knob changed " << value);
+                player->setFilterPosition(value);
+        }
 }
 
 bool AssemblePane::isInterestedInFileDrag(const juce::StringArray& files) { return false; }
 
 void AssemblePane::filesDropped(const juce::StringArray& files, int, int y) {
-        DBG("Files dropped");
+        OTODECK_LOG(debug, "AssemblePane", "Files dropped");
         if (files.size() == 1) {
                 loadFile(juce::URL{files[0]});
         }
 }
 
 void AssemblePane::timerCallback() {
-        positionSlider.setValue(player->getPositionRelative());
-        waveDisplay.setPositionRelative(player->getPositionRelative());
+        OTODECK_TRACE_SCOPE("AssemblePane timer");
+        const double position = player->getAudiblePositionRelative();
+
+        // no notification, moving the slider here must not seek the player
+        if (!positionSlider.isMouseButtonDown()) {
+                positionSlider.setValue(position, juce::dontSendNotification);
+        }
+        waveDisplay.setPositionRelative(position);
+        exitLoopButton.setToggleState(player->isLoopActive(), juce::dontSendNotification);
 }
 
 void AssemblePane::loadFile(juce::URL audioURL) {
-        DBG("AssemblePane::loadFile called");
-        DBG(audioURL.toString(true));
+        OTODECK_LOG(debug, "AssemblePane", "Loading " << audioURL.toString(true));
+        // both calls return straight away, decoding carries on in the background
         player->loadUrl(audioURL);
-        waveDisplay.loadURL(audioURL);
+        waveDisplay.loadTrack(player->getTrack());
+}
+
+void AssemblePane::unloadTrack() {
+        player->loadTrack(nullptr);
+        waveDisplay.loadTrack(nullptr);
 }
@@ -5,7 +5,8 @@
 #include <tuple>
 
 #include "AudioPlayer.h"
-#include "MixerVisualiser.h"
+#include "LevelMeterDisplay.h"
+#include "MemoryGovernor.h"
 #include "WaveDisplay.h"
 #include "juce_gui_basics/juce_gui_basics.h"
 
@@ -19,7 +20,7 @@ class AssemblePane : public juce::Component,
 {
        public:
         AssemblePane(AudioPlayer* player, juce::AudioFormatManager& formatManagerToUse,
-                     juce::AudioThumbnailCache& cacheToUse);
+                     juce::AudioThumbnailCache& cacheToUse, TrackAnalyser& trackAnalyser, MemoryGovernor& memoryGovernor);
 
         // AssemblePane gets DJ audio player via the constructor, and use assignment list
         ~AssemblePane() override;
@@ -41,6 +42,8 @@ class AssemblePane : public juce::Component,
 
         void timerCallback() override;
         void loadFile(juce::URL audioURL);
+        // the deck and the waveform both let go of the track
+        void unloadTrack();
 
        private:
         // Add instances of the components beeing processed
@@ -51,6 +54,9 @@ class AssemblePane : public juce::Component,
         juce::TextButton playButton{"Start"};
         juce::TextButton stopButton{"Stop"};
         juce::TextButton loadButton{"Load track"};
+        juce::TextButton syncButton{"Sync"};
+        juce::TextButton keyLockButton{"Key Lock"};
+        juce::ComboBox keyLockQualityBox;
 
         juce::Slider volSlider;
         juce::Label volLabel;
@@ -58,8 +64,15 @@ class AssemblePane : public juce::Component,
         juce::Slider speedSlider;
         juce::Label speedLabel;
 
-        juce::Slider dampingSlider;
-        juce::Label dampingLabel;
+        juce::Slider reverbSlider;
+        juce::Label reverbLabel;
+        juce::TextButton loadImpulseButton{"Load IR"};
+
+        // beat loops by length, manual loops by in and out points
+        juce::ComboBox beatLoopBox;
+        juce::TextButton loopInButton{"In"};
+        juce::TextButton loopOutButton{"Out"};
+        juce::TextButton exitLoopButton{"Exit"};
 
         juce::Slider positionSlider;
         juce::Label positionLabel;
@@ -78,19 +91,20 @@ class AssemblePane : public juce::Component,
         juce::Label freqLabel;
 
         WaveDisplay waveDisplay;
-        std::shared_ptr<LiveAudioVisualiser> liveAudioVisualiser;
+        LevelMeterDisplay meterDisplay;
 
         juce::FileChooser fChooser{"Select a file...", File::getSpecialLocation(File::userHomeDirectory),
                                    "*.wav;*.mp3;*.aiff"};
 
         AudioPlayer* player;
+        MemoryGovernor& memoryGovernor;
 
         struct SliderParams {
                 std::tuple<double, double> range;
                 double defaultValue;
                 int numDecimalPlaces;
                 juce::Slider::SliderStyle style;
-                std::string* textValueSuffix = nullptr;
+                juce::String textValueSuffix;
         };
 
         void setupButton(juce::Button* component);
@@ -1,20 +1,18 @@
 #include "AudioPlayer.h"
+#include <cmath>
 #include <memory>
 
+#include "Log.h"
+#include "Tracer.h"
+
 #include "juce_audio_formats/juce_audio_formats.h"
 #include "juce_core/juce_core.h"
 
 using namespace juce;
 
-AudioPlayer::AudioPlayer(AudioFormatManager& _formatManager) : formatManager(_formatManager) {
-    // Initialize reverb parameters
-    reverbParameters.roomSize = 0.0f;
-    reverbParameters.damping = 0.0f;
-    reverbParameters.wetLevel = 0.0f;
-    reverbParameters.dryLevel = 1.0f;
-
-    reverbSource.setParameters(reverbParameters);
-
+AudioPlayer::AudioPlayer(AudioFormatManager& _formatManager, DecodedAudioCache& _decodedAudioCache,
+                         TrackAnalyser& _trackAnalyser)
+    : formatManager(_formatManager), decodedAudioCache(_decodedAudioCache), trackAnalyser(_trackAnalyser) {
     // Initialize filter gain
     bassGain = 1.0f;
     midGain = 1.0f;
@@ -32,7 +30,9 @@ void AudioPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
     // Prepare audio sources
     resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
     transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    reverbSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    reverb.prepare(sampleRate, samplesPerBlockExpected);
+    filter.prepare(sampleRate);
+    meter.prepare(sampleRate);
 
     currentSampleRate = sampleRate;
     const uint32 numChannels = 2; // For stereo processing
@@ -44,6 +44,9 @@ void AudioPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
     trebleFilterDuplicator.prepare(spec);
 
     // Update filter coefficients with new sample rate
+    bassGain = bassTarget.load();
+    midGain = midTarget.load();
+    trebleGain = trebleTarget.load();
     bassFilterDuplicator.state = dsp::IIR::Coefficients<float>::makeLowShelf(sampleRate, 200.0f, 0.707f, bassGain);
     midFilterDuplicator.state = dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, 1000.0f, 1.0f, midGain);
     trebleFilterDuplicator.state = dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, 5000.0f, 0.707f, trebleGain);
@@ -51,103 +54,259 @@ void AudioPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 
 void AudioPlayer::releaseResources() {
     // Release resources from all audio sources
-    reverbSource.releaseResources();
+    reverb.release();
     resampleSource.releaseResources();
     transportSource.releaseResources();
 }
 
 void AudioPlayer::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) {
-    // Fetch the audio block
-    resampleSource.getNextAudioBlock(bufferToFill);
-
-    if (liveVisualiser == nullptr) {
-        DBG("AudioPlayer::getNextAudioBlock: liveVisualiser is not null");
-        return;
-    }
+    OTODECK_TRACE_SCOPE("Deck");
 
-    const juce::AudioBuffer<float> bufferCopy = *bufferToFill.buffer;
-    float magnitude = bufferCopy.getMagnitude(bufferToFill.startSample, bufferToFill.numSamples);
+    // Where this block starts, for the playhead, including a cue jump the source is about to take up
+    const double cueSeek = pendingCueSeek.load();
+    playbackClock.publish(cueSeek >= 0.0 ? cueSeek : transportSource.getCurrentPosition(),
+                          transportSource.getLengthInSeconds(), currentSpeed.load(), transportSource.isPlaying());
 
-    // Multi-channel processing: Apply the filters
-    const int numChannels = bufferToFill.buffer->getNumChannels();
-    if (numChannels == 1) {
-        // Mono processing
-        dsp::AudioBlock<float> block(*bufferToFill.buffer);
-        dsp::ProcessContextReplacing<float> context(block);
+    // controller changes are taken up here, so they work the same from the message thread and the audio thread
+    if (eqChanged.exchange(false)) {
+        updateEqCoefficients();
+    }
+    const double jog = jogFactor.load();
+    if (jog != appliedJogFactor) {
+        appliedJogFactor = jog;
+        routeSpeed(currentSpeed.load() * jog);
+    }
 
-        // Apply bass, mid, and treble filters for mono signal
-        bassFilterDuplicator.process(context);
-        midFilterDuplicator.process(context);
-        trebleFilterDuplicator.process(context);
-    } else {
-        // Stereo or multi-channel processing
-        for (int channel = 0; channel < numChannels; ++channel) {
-            float* channelData = bufferToFill.buffer->getWritePointer(channel);
-            float* channelPtr[1] = {channelData};
+    // each stage is a trace marker, so a slow block shows which part of the deck it was
+    {
+        OTODECK_TRACE_SCOPE("Deck source");
+        resampleSource.getNextAudioBlock(bufferToFill);
+    }
 
-            dsp::AudioBlock<float> block(channelPtr, 1, bufferToFill.buffer->getNumSamples());
+    {
+        OTODECK_TRACE_SCOPE("Deck EQ");
+        // Multi-channel processing: Apply the filters
+        const int numChannels = bufferToFill.buffer->getNumChannels();
+        if (numChannels == 1) {
+            // Mono processing
+            dsp::AudioBlock<float> block(*bufferToFill.buffer);
             dsp::ProcessContextReplacing<float> context(block);
 
-            // Apply bass, mid, and treble filters for each channel
+            // Apply bass, mid, and treble filters for mono signal
             bassFilterDuplicator.process(context);
             midFilterDuplicator.process(context);
             trebleFilterDuplicator.process(context);
+        } else {
+            // Stereo or multi-channel processing
+            for (int channel = 0; channel < numChannels; ++channel) {
+                float* channelData = bufferToFill.buffer->getWritePointer(channel);
+                float* channelPtr[1] = {channelData};
+
+                dsp::AudioBlock<float> block(channelPtr, 1, bufferToFill.buffer->getNumSamples());
+                dsp::ProcessContextReplacing<float> context(block);
+
+                // Apply bass, mid, and treble filters for each channel
+                bassFilterDuplicator.process(context);
+                midFilterDuplicator.process(context);
+                trebleFilterDuplicator.process(context);
+            }
         }
     }
 
-    // Optional: Update live visualizer (only if it's initialized)
-    juce::MessageManager::callAsync([this, bufferCopy, magnitude]() mutable {
-        liveVisualiser->setBuffer(bufferCopy, magnitude);
-    });
+    {
+        OTODECK_TRACE_SCOPE("Deck filter");
+        filter.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    }
+
+    {
+        OTODECK_TRACE_SCOPE("Deck reverb");
+        reverb.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    }
+
+    // measured in place, the display reads the results on its own timer
+    OTODECK_TRACE_SCOPE("Deck meter");
+    meter.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
 }
 
 void AudioPlayer::loadUrl(URL audioUrl) {
+    OTODECK_TRACE_SCOPE("Load track");
     File audioFile = audioUrl.getLocalFile();
-    formatManager.registerBasicFormats();
-
-    // Enable MP3 support
-#if JUCE_USE_MP3AUDIOFORMAT
-    DBG("MP3 support enabled");
-    formatManager.registerFormat(new MP3AudioFormat(), true);
-#endif
 
     if (!audioFile.existsAsFile()) {
-        DBG("Error: File does not exist -> " + audioFile.getFullPathName());
+        OTODECK_LOG(warning, "AudioPlayer", "File does not exist -> " + audioFile.getFullPathName());
         return;
     }
 
-    std::unique_ptr<InputStream> inputStream(audioFile.createInputStream());
-    AudioFormatReader* reader = formatManager.createReaderFor(audioFile);
+    // let go of the previous track first, so its decode is cancelled if nobody else needs it
+    loadTrack(nullptr);
+    OTODECK_LOG(info, "AudioPlayer", "Audio file requested: " << audioUrl.toString(true));
+    loadTrack(decodedAudioCache.getOrLoad(audioFile, formatManager));
+}
 
-    if (reader == nullptr) {
-        DBG("Error: could not create reader for file");
+void AudioPlayer::loadTrack(std::shared_ptr<const DecodedTrack> decodedTrack) {
+    stopTimer();
+    startWhenReady = false;
+    loopInPoint = -1;
+    cuePoint.store(0.0);
+    pendingCueSeek.store(-1.0);
+    transportSource.setSource(nullptr);
+    trackSource.reset();
+    track.reset();
+    analysisReceived = false;
+    beatGridBpm.store(0.0);
+
+    track = std::move(decodedTrack);
+
+    if (track != nullptr) {
+        startTimer(20);
+        timerCallback();
+    }
+}
+
+void AudioPlayer::timerCallback() {
+    if (track == nullptr || track->hasFailed()) {
+        OTODECK_LOG(warning, "AudioPlayer", "Could not decode file");
+        stopTimer();
+        return;
+    }
+
+    if (!track->isReady()) {
         return;
     }
 
-    DBG("Audio file loaded: " << audioUrl.toString(true));
+    if (trackSource == nullptr) {
+        // every player gets its own source over the shared decoded samples
+        std::unique_ptr<DecodedAudioSource> newSource(new DecodedAudioSource(track, &pendingCueSeek));
 
-    // create audio format reader source, when file is read
-    std::unique_ptr<juce::AudioFormatReaderSource> newSource(new juce::AudioFormatReaderSource(reader, true));
+        // control playback of audio
+        transportSource.setSource(newSource.get(), 0, nullptr, track->sampleRate);
 
-    // control playback of audio
-    transportSource.setSource(newSource.get(), 0, nullptr, reader->sampleRate);
+        // transfer ownership to class variable
+        trackSource.reset(newSource.release());
+
+        if (startWhenReady) {
+            startWhenReady = false;
+            transportSource.start();
+        }
+
+        // keep polling, slower, until the analysis arrives
+        startTimer(200);
+    }
+
+    if (!analysisReceived) {
+        std::shared_ptr<const TrackAnalysis> analysis = trackAnalyser.requestAnalysis(track);
+
+        if (analysis == nullptr) {
+            return;
+        }
+
+        beatGridFirstBeat.store(analysis->beatGrid.firstBeatSeconds);
+        beatGridBpm.store(analysis->beatGrid.bpm);
+        analysisReceived = true;
+        OTODECK_LOG(info, "AudioPlayer", "Beat grid: " << analysis->beatGrid.bpm << " BPM");
+    }
 
-    // transfer ownership to class variable
-    readerSource.reset(newSource.release());
+    stopTimer();
+}
+
+std::shared_ptr<const DecodedTrack> AudioPlayer::getTrack() const {
+    return track;
+}
+
+void AudioPlayer::holdTrackAsStandby(std::function<bool()> letGo) {
+    if (track != nullptr) {
+        decodedAudioCache.holdAsStandby(track, std::move(letGo));
+    }
+}
+
+void AudioPlayer::holdTrackAsLive() {
+    if (track != nullptr) {
+        decodedAudioCache.holdAsLive(track);
+    }
+}
+
+double AudioPlayer::probeLengthInSeconds(URL audioUrl) {
+    return decodedAudioCache.probeLengthInSeconds(audioUrl.getLocalFile(), formatManager);
 }
 
 void AudioPlayer::setGain(double gain) {
-    if (gain > 0 && gain < 10.0) {
+    // zero is allowed, a fader pulled all the way down mutes the deck
+    if (gain >= 0 && gain < 10.0) {
         transportSource.setGain(gain);
     }
 }
 
 void AudioPlayer::setSpeed(double ratio) {
     if (ratio > 0 && ratio < 100.0) {
+        userSpeed.store(ratio);
+
+        // while synced BeatSync owns the ratio, the user speed comes back when sync is switched off
+        if (!syncEnabled.load()) {
+            applySpeed(ratio);
+        }
+    }
+}
+
+void AudioPlayer::applySyncSpeed(double ratio) {
+    if (ratio > 0 && ratio < 100.0) {
+        applySpeed(ratio);
+    }
+}
+
+void AudioPlayer::applySpeed(double ratio) {
+    currentSpeed.store(ratio);
+    routeSpeed(ratio * jogFactor.load());
+}
+
+void AudioPlayer::routeSpeed(double ratio) {
+    if (keyLockSource.isEnabled()) {
+        keyLockSource.setTempo(ratio);
+        resampleSource.setResamplingRatio(1.0);
+    } else {
         resampleSource.setResamplingRatio(ratio);
     }
 }
 
+void AudioPlayer::setKeyLockEnabled(bool shouldLock) {
+    keyLockSource.setEnabled(shouldLock);
+    applySpeed(currentSpeed.load());
+}
+
+bool AudioPlayer::isKeyLockEnabled() const {
+    return keyLockSource.isEnabled();
+}
+
+void AudioPlayer::setKeyLockQuality(TimeStretchAudioSource::Quality quality) {
+    keyLockSource.setQuality(quality);
+}
+
+float AudioPlayer::getKeyLockCpuLoad() const {
+    return keyLockSource.isEnabled() ? keyLockSource.getCpuLoad() : 0.0f;
+}
+
+void AudioPlayer::setSyncEnabled(bool shouldSync) {
+    syncEnabled.store(shouldSync);
+}
+
+bool AudioPlayer::isSyncEnabled() const {
+    return syncEnabled.load();
+}
+
+BeatGrid AudioPlayer::getBeatGrid() const {
+    BeatGrid grid;
+    grid.bpm = beatGridBpm.load();
+    grid.firstBeatSeconds = beatGridFirstBeat.load();
+    return grid;
+}
+
+double AudioPlayer::getUserSpeed() const {
+    return userSpeed.load();
+}
+
+double AudioPlayer::getCurrentSpeed() const {
+    return currentSpeed.load();
+}
+
 void AudioPlayer::setPositionRelative(double pos) {
     if (pos > 0 && pos < 1.0) {
         double posInSecs = transportSource.getLengthInSeconds() * pos;
@@ -155,8 +314,8 @@ void AudioPlayer::setPositionRelative(double pos) {
     }
 }
 
-void AudioPlayer::setPlayerVisualiser(std::shared_ptr<LiveAudioVisualiser>& _liveVisualiser) {
-    liveVisualiser = _liveVisualiser;
+LevelMeter& AudioPlayer::getMeter() {
+    return meter;
 }
 
 double AudioPlayer::getPositionRelative() {
@@ -170,36 +329,163 @@ double AudioPlayer::getLengthInSeconds() {
     return transportSource.getLengthInSeconds();
 }
 
+double AudioPlayer::getPositionInSeconds() const {
+    return transportSource.getCurrentPosition();
+}
+
+double AudioPlayer::getAudiblePositionRelative() const {
+    const double length = playbackClock.getLengthInSeconds();
+    return length > 0 ? playbackClock.getAudiblePosition() * 100 / length : 0;
+}
+
+void AudioPlayer::setOutputLatency(double seconds) {
+    playbackClock.setOutputLatency(seconds);
+}
+
+bool AudioPlayer::isPlaying() const {
+    return transportSource.isPlaying();
+}
+
 void AudioPlayer::setPosition(double posInSecs) {
     transportSource.setPosition(posInSecs);
 }
 
 void AudioPlayer::start() {
+    if (trackSource == nullptr && track != nullptr) {
+        startWhenReady = true;
+    }
     transportSource.start();
 }
 
 void AudioPlayer::stop() {
+    startWhenReady = false;
     transportSource.stop();
 }
 
-void AudioPlayer::setDamping(float damping) {
-    reverbParameters.damping = damping;
-    reverbSource.setParameters(reverbParameters);
+void AudioPlayer::setBeatLoop(double beats) {
+    if (trackSource == nullptr || beats <= 0) {
+        return;
+    }
+
+    const double rate = track->sampleRate;
+    const double bpm = beatGridBpm.load();
 
-    DBG("Damping set to: " << damping);
+    if (bpm <= 0) {
+        // no beat grid (yet), loop from here at 120 BPM
+        trackSource->setLoopFromHere((int64) std::round(beats * 0.5 * rate));
+        return;
+    }
+
+    // start on the beat (or the fraction of a beat) just played, so the loop stays on the grid
+    const double beatSeconds = 60.0 / bpm;
+    const double step = beatSeconds * jmin(1.0, beats);
+    const double firstBeat = beatGridFirstBeat.load();
+    const double startSeconds =
+        jmax(0.0, firstBeat + std::floor((getPositionInSeconds() - firstBeat) / step) * step);
+
+    const int64 start = (int64) std::round(startSeconds * rate);
+    trackSource->setLoop(start, start + (int64) std::round(beats * beatSeconds * rate));
+}
+
+void AudioPlayer::setLoopIn() {
+    if (trackSource != nullptr) {
+        loopInPoint = trackSource->getNextReadPosition();
+    }
+}
+
+void AudioPlayer::setLoopOut() {
+    // the out point is taken by the audio thread, at the sample it is playing
+    if (trackSource != nullptr && loopInPoint >= 0) {
+        trackSource->setLoop(loopInPoint, DecodedAudioSource::loopHere);
+    }
+}
+
+void AudioPlayer::exitLoop() {
+    if (trackSource != nullptr) {
+        trackSource->exitLoop();
+    }
+}
+
+bool AudioPlayer::isLoopActive() const {
+    return trackSource != nullptr && trackSource->isInLoop();
+}
+
+double AudioPlayer::getLoopLatencyMs() const {
+    return trackSource != nullptr ? trackSource->getLoopLatencyMs() : 0.0;
+}
+
+void AudioPlayer::setReverbWet(float wet) {
+    // the plain two second room is only built once the reverb is first raised, not at startup
+    if (wet > 0.0f && !hasImpulseResponse) {
+        reverb.loadImpulseResponse(ConvolutionReverb::makeRoomImpulseResponse(44100.0, 2.0), 44100.0);
+        hasImpulseResponse = true;
+    }
+    reverb.setWetLevel(wet);
+}
+
+void AudioPlayer::setNonRealtime(bool isNonRealtime) {
+    reverb.setNonRealtime(isNonRealtime);
+}
+
+bool AudioPlayer::loadImpulseResponse(const File& file) {
+    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0) {
+        OTODECK_LOG(warning, "AudioPlayer", "Could not read impulse response -> " + file.getFullPathName());
+        return false;
+    }
+
+    // anything past ten seconds is inaudible in a mix
+    const int length = (int) jmin<int64>(reader->lengthInSamples, (int64) (reader->sampleRate * 10.0));
+    AudioBuffer<float> impulse((int) reader->numChannels, length);
+    reader->read(&impulse, 0, length, 0, true, true);
+
+    reverb.loadImpulseResponse(impulse, reader->sampleRate);
+    hasImpulseResponse = true;
+    OTODECK_LOG(info, "AudioPlayer", "Impulse response loaded: " << file.getFileName());
+    return true;
 }
 
 void AudioPlayer::setBassGain(float gain) {
-    bassGain = gain;
-    bassFilterDuplicator.state = dsp::IIR::Coefficients<float>::makeLowShelf(currentSampleRate, 200.0f, 0.707f, bassGain);
+    bassTarget.store(gain);
+    eqChanged.store(true);
 }
 
 void AudioPlayer::setMidGain(float gain) {
-    midGain = gain;
-    midFilterDuplicator.state = dsp::IIR::Coefficients<float>::makePeakFilter(currentSampleRate, 1000.0f, 1.0f, midGain);
+    midTarget.store(gain);
+    eqChanged.store(true);
 }
 
 void AudioPlayer::setTrebleGain(float gain) {
-    trebleGain = gain;
-    trebleFilterDuplicator.state = dsp::IIR::Coefficients<float>::makeHighShelf(currentSampleRate, 5000.0f, 0.707f, trebleGain);
+    trebleTarget.store(gain);
+    eqChanged.store(true);
+}
+
+void AudioPlayer::setFilterPosition(float position) {
+    filter.setPosition(position);
+}
+
+void AudioPlayer::updateEqCoefficients() {
+    bassGain = bassTarget.load();
+    midGain = midTarget.load();
+    trebleGain = trebleTarget.load();
+
+    // written into the existing coefficient objects, which keeps this free of allocations on the audio thread
+    *bassFilterDuplicator.state = dsp::IIR::ArrayCoefficients<float>::makeLowShelf(currentSampleRate, 200.0f, 0.707f, bassGain);
+    *midFilterDuplicator.state = dsp::IIR::ArrayCoefficients<float>::makePeakFilter(currentSampleRate, 1000.0f, 1.0f, midGain);
+    *trebleFilterDuplicator.state = dsp::IIR::ArrayCoefficients<float>::makeHighShelf(currentSampleRate, 5000.0f, 0.707f, trebleGain);
+}
+
+void AudioPlayer::setJogFactor(double factor) {
+    jogFactor.store(jlimit(0.5, 1.5, factor));
+}
+
+void AudioPlayer::cue() {
+    // a stopped deck remembers where it stands, a playing one jumps back there; cue() runs on the audio
+    // thread from MIDI, so the jump is left to the track source instead of the transport, which locks
+    if (transportSource.isPlaying()) {
+        pendingCueSeek.store(cuePoint.load());
+    } else {
+        cuePoint.store(transportSource.getCurrentPosition());
+    }
 }
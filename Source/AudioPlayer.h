@@ -1,50 +1,130 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 
-#include "MixerVisualiser.h"
+#include "ConvolutionReverb.h"
+#include "DecodedAudioCache.h"
+#include "DecodedAudioSource.h"
+#include "DJFilter.h"
+#include "LevelMeter.h"
+#include "PlaybackClock.h"
+#include "TimeStretchAudioSource.h"
+#include "TrackAnalyser.h"
 #include "juce_audio_basics/juce_audio_basics.h"
 #include "juce_audio_devices/juce_audio_devices.h"
 #include "juce_audio_formats/juce_audio_formats.h"
+#include "juce_events/juce_events.h"
 
 using namespace juce;
 
-class AudioPlayer : public AudioSource {
+class AudioPlayer : public AudioSource, private Timer {
        public:
-        AudioPlayer(AudioFormatManager& _formatManager);
+        AudioPlayer(AudioFormatManager& _formatManager, DecodedAudioCache& _decodedAudioCache,
+                    TrackAnalyser& _trackAnalyser);
 
         ~AudioPlayer();
         virtual void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
         virtual void releaseResources() override;
         virtual void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
 
+        // returns straight away, the track is decoded in the background and attached once its format is known
         void loadUrl(URL audioUrl);
+        // attaches an already decoded track, straight away if it is ready
+        void loadTrack(std::shared_ptr<const DecodedTrack> decodedTrack);
+        // the track most recently requested by loadUrl, possibly still decoding
+        std::shared_ptr<const DecodedTrack> getTrack() const;
+        // how the cache treats the track under memory pressure, see DecodedAudioCache
+        void holdTrackAsStandby(std::function<bool()> letGo);
+        void holdTrackAsLive();
+        // length of a track without loading it into the player
+        double probeLengthInSeconds(URL audioUrl);
 
         void setGain(double gain);
         void setSpeed(double ratio);
         void setPosition(double posInSecs);
         void setPositionRelative(double pos);
-        void setPlayerVisualiser(std::shared_ptr<LiveAudioVisualiser>& _liveVisualiser);
+        // levels after the EQ and reverb, what the deck sends to the mixer
+        LevelMeter& getMeter();
 
         double getPositionRelative();
         double getLengthInSeconds();
-
+        // safe to call from the audio thread
+        double getPositionInSeconds() const;
+        // what is being heard right now, for drawing the playhead; percent like getPositionRelative
+        double getAudiblePositionRelative() const;
+        void setOutputLatency(double seconds);
+        bool isPlaying() const;
+
+        // beat sync, the speed set by the user is kept and restored when sync is switched off
+        void setSyncEnabled(bool shouldSync);
+        bool isSyncEnabled() const;
+        BeatGrid getBeatGrid() const;
+        double getUserSpeed() const;
+        double getCurrentSpeed() const;
+        // audio thread, used by BeatSync to drive the resampling ratio
+        void applySyncSpeed(double ratio);
+
+        // key lock keeps the pitch when the speed changes, by time-stretching instead of resampling
+        void setKeyLockEnabled(bool shouldLock);
+        bool isKeyLockEnabled() const;
+        void setKeyLockQuality(TimeStretchAudioSource::Quality quality);
+        // fraction of one core the time-stretch currently takes
+        float getKeyLockCpuLoad() const;
+
+        // loops: a beat-length loop from the beat just played, or manual in and out points
+        void setBeatLoop(double beats);
+        void setLoopIn();
+        void setLoopOut();
+        void exitLoop();
+        bool isLoopActive() const;
+        // how long the last loop engage or exit took to reach the audio thread
+        double getLoopLatencyMs() const;
+
+        // EQ gains take effect at the start of the next block, safe to call from the audio thread
         void setBassGain(float gain);
         void setMidGain(float gain);
         void setTrebleGain(float gain);
-        void setDamping(float damping);
+        // DJ filter knob, -1 low-pass through 0 off to 1 high-pass, smoothed on the audio thread
+        void setFilterPosition(float position);
+
+        // controller paths, safe to call from the audio thread
+        // temporary speed multiplier on top of the deck's speed, for jog wheel nudges
+        void setJogFactor(double factor);
+        // sets the cue point when stopped, jumps back to it while playing
+        void cue();
+        // reverb level 0..1 added on top of the dry deck
+        void setReverbWet(float wet);
+        // replaces the built-in room with an impulse response from an audio file
+        bool loadImpulseResponse(const File& file);
+        // offline rendering, everything is computed in the callback so the output never depends on timing
+        void setNonRealtime(bool isNonRealtime);
 
         void start();
         void stop();
 
        private:
+        // attaches the requested track to the transport once it can be played
+        void timerCallback() override;
+        // records the deck speed and routes it, with the jog factor, to the time-stretch or the resampler
+        void applySpeed(double ratio);
+        void routeSpeed(double ratio);
+        void updateEqCoefficients();
+
         double currentSampleRate = 44100.0;
         // Handle audio file formats
         AudioFormatManager& formatManager;
-        // Optional visuliser
-        std::shared_ptr<LiveAudioVisualiser> liveVisualiser;
-
+        // Decoded tracks shared between all players
+        DecodedAudioCache& decodedAudioCache;
+        // Beat grid and other per-track analysis
+        TrackAnalyser& trackAnalyser;
+        // measured on the audio thread
+        LevelMeter meter;
+
+        // gains in use on the audio thread, and the targets set from any thread
         float bassGain{1.0f}, midGain{1.0f}, trebleGain{1.0f};
+        std::atomic<float> bassTarget{1.0f}, midTarget{1.0f}, trebleTarget{1.0f};
+        std::atomic<bool> eqChanged{false};
         // juce::dsp::IIR::Filter<float> bassFilter, midFilter, trebleFilter;
 
         juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>>
@@ -56,14 +136,39 @@ class AudioPlayer : public AudioSource {
 
         // Audio playback control and audio volume
         AudioTransportSource transportSource;
-
-        // To create on the fly, to read a file once the file is identified, smart pointer requiered by the JUCE
-        std::unique_ptr<AudioFormatReaderSource> readerSource;
-
-        // Audio speed control
-        ResamplingAudioSource resampleSource{&transportSource, false, 2};
-        ReverbAudioSource reverbSource{&resampleSource, false};
-
-        // Reverb stuf
-        Reverb::Parameters reverbParameters;
+        // Position published by the audio thread for the UI
+        PlaybackClock playbackClock;
+
+        // To create on the fly, plays the shared decoded track, smart pointer requiered by the JUCE
+        std::unique_ptr<DecodedAudioSource> trackSource;
+        std::shared_ptr<const DecodedTrack> track;
+        // start() was pressed before the requested track could be attached
+        bool startWhenReady = false;
+        // track sample set by setLoopIn, -1 until then
+        int64 loopInPoint = -1;
+        bool analysisReceived = false;
+
+        // Beat sync state, read by BeatSync on the audio thread
+        std::atomic<bool> syncEnabled{false};
+        std::atomic<double> beatGridBpm{0.0};
+        std::atomic<double> beatGridFirstBeat{0.0};
+        std::atomic<double> userSpeed{1.0};
+        std::atomic<double> currentSpeed{1.0};
+        std::atomic<double> jogFactor{1.0};
+        double appliedJogFactor = 1.0;
+        std::atomic<double> cuePoint{0.0};
+        // a cue jump from the audio thread, seconds, taken up by the track source; negative when none is pending
+        std::atomic<double> pendingCueSeek{-1.0};
+
+        // Audio speed control, with key lock the stretch follows the speed and the resampler stays at 1
+        TimeStretchAudioSource keyLockSource{&transportSource, 2};
+        ResamplingAudioSource resampleSource{&keyLockSource, false, 2};
+
+        // applied after the EQ, before the reverb
+        DJFilter filter;
+
+        // Reverb, applied after the EQ and the filter
+        ConvolutionReverb reverb;
+        // message thread, false until an IR has been loaded or the room built
+        bool hasImpulseResponse = false;
 };
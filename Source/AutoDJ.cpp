@@ -0,0 +1,382 @@
+/*
+  ==============================================================================
+
+    AutoDJ.cpp
+    Created: 19/10/2026 20:41:03
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "AutoDJ.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+
+#include "Log.h"
+
+//==============================================================================
+AutoDJ::DeckOutput::DeckOutput(AutoDJ& _owner, int _deck) : owner(_owner), deck(_deck) {}
+
+void AutoDJ::DeckOutput::prepareToPlay(int samplesPerBlockExpected, double sampleRate) {
+        owner.decks[deck]->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void AutoDJ::DeckOutput::releaseResources() { owner.decks[deck]->releaseResources(); }
+
+void AutoDJ::DeckOutput::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) {
+        if (!owner.enabled.load()) {
+                owner.decks[deck]->getNextAudioBlock(bufferToFill);
+                return;
+        }
+
+        // a shut deck is not pulled, so it stays exactly on its cue until the sample it opens at
+        const juce::int64 opensAt = owner.states[deck].opensAt.load();
+        const int offset = (int) juce::jlimit<juce::int64>(0, bufferToFill.numSamples, opensAt - owner.blockStart);
+
+        bufferToFill.buffer->clear(bufferToFill.startSample, offset);
+        if (offset == bufferToFill.numSamples) {
+                return;
+        }
+
+        owner.decks[deck]->getNextAudioBlock(juce::AudioSourceChannelInfo(
+            bufferToFill.buffer, bufferToFill.startSample + offset, bufferToFill.numSamples - offset));
+
+        const juce::int64 fadeStart = owner.states[deck].fadeStart.load();
+        const juce::int64 fadeEnd = fadeStart + owner.states[deck].fadeLength.load();
+        const juce::int64 blockEnd = owner.blockStart + bufferToFill.numSamples;
+
+        if (fadeEnd <= owner.blockStart || fadeStart >= blockEnd) {
+                // the whole block is before or after the fade, one gain for all of it
+                const float gain = owner.getGain(deck, owner.blockStart);
+                if (gain != 1.0f) {
+                        bufferToFill.buffer->applyGain(bufferToFill.startSample + offset, bufferToFill.numSamples - offset,
+                                                       gain);
+                }
+                return;
+        }
+
+        for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel) {
+                float* data = bufferToFill.buffer->getWritePointer(channel, bufferToFill.startSample);
+
+                for (int i = offset; i < bufferToFill.numSamples; ++i) {
+                        data[i] *= owner.getGain(deck, owner.blockStart + i);
+                }
+        }
+}
+
+//==============================================================================
+AutoDJ::AutoDJ(AudioPlayer& deckA, AudioPlayer& deckB, AssemblePane& paneA, AssemblePane& paneB,
+               TrackAnalyser& _trackAnalyser)
+    : decks{&deckA, &deckB}, panes{&paneA, &paneB}, trackAnalyser(_trackAnalyser) {}
+
+AutoDJ::~AutoDJ() {
+        stopTimer();
+
+        // the cache must not call back into a deleted AutoDJ
+        const int standby = standbyDeck.load();
+        if (standby >= 0) {
+                decks[standby]->holdTrackAsLive();
+        }
+}
+
+void AutoDJ::enqueue(const juce::File& file) { queue.push_back(file); }
+
+void AutoDJ::setEnabled(bool shouldBeEnabled) {
+        if (shouldBeEnabled == enabled.load()) {
+                return;
+        }
+
+        if (!shouldBeEnabled) {
+                // a standby deck is already started, without its gate it would come in straight away
+                const int standby = standbyDeck.load();
+                if (standby >= 0 && !transitioning.load()) {
+                        decks[standby]->stop();
+                }
+                // whatever it holds is now an ordinary deck's track
+                if (standby >= 0) {
+                        decks[standby]->holdTrackAsLive();
+                }
+
+                stopTimer();
+                enabled.store(false);
+                standbyReady.store(false);
+                transitioning.store(false);
+                standbyDeck.store(-1);
+                return;
+        }
+
+        // a deck already playing carries on as the current one, the other deck becomes the standby
+        int current = -1;
+        for (int deck = 0; deck < 2; ++deck) {
+                if (decks[deck]->isPlaying()) {
+                        current = deck;
+                        break;
+                }
+        }
+
+        currentDeck.store(current);
+        standbyDeck.store(-1);
+        standbyReady.store(false);
+        transitionFinished.store(false);
+        for (int deck = 0; deck < 2; ++deck) {
+                if (deck == current) {
+                        open(deck);
+                } else {
+                        shut(deck);
+                }
+        }
+
+        enabled.store(true);
+        startTimer(100);
+}
+
+bool AutoDJ::isEnabled() const { return enabled.load(); }
+
+juce::String AutoDJ::getStatusText() const {
+        if (!enabled.load()) {
+                return queue.empty() ? juce::String() : "Auto DJ off, " + juce::String((int) queue.size()) + " queued";
+        }
+
+        juce::String status = "Auto DJ " + juce::String((int) queue.size()) + " queued";
+        const int standby = standbyDeck.load();
+
+        if (transitioning.load()) {
+                status << ", mixing into " << loadedTitles[standby];
+        } else if (standby >= 0) {
+                status << ", next " << loadedTitles[standby] << (standbyReady.load() ? " (ready)" : " (warming up)");
+        }
+        return status;
+}
+
+juce::AudioSource& AutoDJ::getDeckOutput(int deck) { return outputs[deck]; }
+
+//==============================================================================
+void AutoDJ::timerCallback() {
+        if (transitionFinished.exchange(false)) {
+                // the old deck has faded out, it becomes the standby for the next track
+                const int previous = currentDeck.load();
+                decks[previous]->stop();
+                shut(previous);
+
+                currentDeck.store(standbyDeck.load());
+                standbyDeck.store(-1);
+        }
+
+        skipFailedStandby();
+
+        int current = currentDeck.load();
+
+        // nothing playing: the first track starts as soon as it is warm
+        if (current < 0) {
+                int standby = standbyDeck.load();
+
+                if (standby < 0 && !queue.empty() && juce::Time::getMillisecondCounter() >= retryStandbyAt) {
+                        standby = 0;
+                        loadNext(standby);
+                } else if (standby >= 0 && isWarm(standby)) {
+                        standbyReady.store(false);
+                        decks[standby]->holdTrackAsLive();
+                        cue(standby);
+                        open(standby);
+                        decks[standby]->start();
+                        currentDeck.store(standby);
+                        standbyDeck.store(-1);
+                }
+                return;
+        }
+
+        if (!decks[current]->isPlaying() && !transitioning.load()) {
+                // the queue ran dry and the last track ended
+                currentDeck.store(-1);
+                return;
+        }
+
+        const int standby = standbyDeck.load();
+
+        if (standby < 0) {
+                if (!queue.empty() && juce::Time::getMillisecondCounter() >= retryStandbyAt) {
+                        loadNext(1 - current);
+                }
+                return;
+        }
+
+        if (!standbyReady.load() && isWarm(standby)) {
+                decks[standby]->holdTrackAsLive();
+                cue(standby);
+
+                // mix over the last 16 beats, or 8 seconds unless both tracks have a beat grid, never more than a
+                // third of the track
+                const double length = decks[current]->getLengthInSeconds();
+                const BeatGrid grid = decks[current]->getBeatGrid();
+                const bool beatMatched = grid.isValid() && decks[standby]->getBeatGrid().isValid();
+                const double fade = juce::jmin(beatMatched ? 16.0 * 60.0 / grid.bpm : 8.0, length / 3.0);
+
+                fadeSeconds.store(fade);
+                mixOutSeconds.store(length - fade);
+
+                // started but shut, so the deck waits on its cue until the audio thread opens it
+                decks[standby]->start();
+                standbyReady.store(true);
+        }
+}
+
+bool AutoDJ::isWarm(int deck) const {
+        const std::shared_ptr<const DecodedTrack> track = decks[deck]->getTrack();
+
+        if (track == nullptr || !track->isComplete() || decks[deck]->getLengthInSeconds() <= 0) {
+                return false;
+        }
+
+        // both are cached by the analyser, asking again only looks them up
+        const std::shared_ptr<const TrackAnalysis> analysis = trackAnalyser.requestAnalysis(track);
+        if (analysis == nullptr || trackAnalyser.requestWaveform(track) == nullptr) {
+                return false;
+        }
+
+        // a track too short or too loose for a beat grid is warm without one; with one, the deck must have it
+        return !analysis->beatGrid.isValid() || decks[deck]->getBeatGrid().isValid();
+}
+
+void AutoDJ::skipFailedStandby() {
+        const int standby = standbyDeck.load();
+        if (standby < 0 || standbyReady.load()) {
+                return;
+        }
+
+        const std::shared_ptr<const DecodedTrack> track = decks[standby]->getTrack();
+        if (track == nullptr || !track->hasFailed()) {
+                return;
+        }
+
+        // a file that could not be decoded would never warm up and hold the queue for good
+        OTODECK_LOG(warning, "AutoDJ", "Skipping " << loadedTitles[standby] << ", it could not be decoded");
+        panes[standby]->unloadTrack();
+        standbyDeck.store(-1);
+        loadedFiles[standby] = juce::File();
+        loadedTitles[standby] = {};
+
+        if (!queue.empty()) {
+                loadNext(standby);
+        }
+}
+
+void AutoDJ::loadNext(int deck) {
+        const juce::File file = queue.front();
+        queue.pop_front();
+
+        shut(deck);
+        standbyReady.store(false);
+        standbyDeck.store(deck);
+        loadedFiles[deck] = file;
+        loadedTitles[deck] = file.getFileNameWithoutExtension();
+
+        // decoding, analysis and the waveform all start here, long before the deck is needed
+        panes[deck]->loadFile(juce::URL{file});
+
+        const DecodedTrack* track = decks[deck]->getTrack().get();
+        decks[deck]->holdTrackAsStandby([this, deck, track] { return letGoOfStandby(deck, track); });
+}
+
+bool AutoDJ::letGoOfStandby(int deck, const DecodedTrack* track) {
+        // once ready, the audio thread may open the deck at any moment, so only a warming standby gives way
+        if (!enabled.load() || standbyDeck.load() != deck || standbyReady.load() ||
+            decks[deck]->getTrack().get() != track) {
+                return false;
+        }
+
+        OTODECK_LOG(info, "AutoDJ", "Low on memory, unloading " << loadedTitles[deck] << " until later");
+        panes[deck]->unloadTrack();
+        standbyDeck.store(-1);
+        queue.push_front(loadedFiles[deck]);
+        loadedFiles[deck] = juce::File();
+        loadedTitles[deck] = {};
+        retryStandbyAt = juce::Time::getMillisecondCounter() + standbyRetryMs;
+        return true;
+}
+
+void AutoDJ::cue(int deck) {
+        // the mix comes in on the first beat, or at the start of a track without a grid
+        const BeatGrid grid = decks[deck]->getBeatGrid();
+        decks[deck]->setPosition(grid.isValid() ? grid.firstBeatSeconds : 0.0);
+}
+
+void AutoDJ::shut(int deck) {
+        states[deck].opensAt.store(never);
+        states[deck].fadeStart.store(never);
+        states[deck].fadeLength.store(0);
+        states[deck].fadingIn.store(true);
+}
+
+void AutoDJ::open(int deck) {
+        states[deck].opensAt.store(0);
+        states[deck].fadeStart.store(0);
+        states[deck].fadeLength.store(0);
+        states[deck].fadingIn.store(true);
+}
+
+float AutoDJ::getGain(int deck, juce::int64 sample) const {
+        const juce::int64 fadeStart = states[deck].fadeStart.load(std::memory_order_relaxed);
+        const juce::int64 fadeLength = states[deck].fadeLength.load(std::memory_order_relaxed);
+        const bool fadingIn = states[deck].fadingIn.load(std::memory_order_relaxed);
+
+        double progress = 0.0;
+        if (sample >= fadeStart) {
+                progress = fadeLength > 0 ? juce::jmin(1.0, (double) (sample - fadeStart) / (double) fadeLength) : 1.0;
+        }
+
+        const double angle = progress * juce::MathConstants<double>::halfPi;
+        return (float) (fadingIn ? std::sin(angle) : std::cos(angle));
+}
+
+//==============================================================================
+void AutoDJ::prepare(double _sampleRate) { sampleRate = _sampleRate; }
+
+void AutoDJ::process(int numSamples) {
+        blockStart = nextBlockStart;
+        nextBlockStart += numSamples;
+
+        if (!enabled.load()) {
+                return;
+        }
+
+        if (transitioning.load()) {
+                if (blockStart >= transitionEnd) {
+                        transitioning.store(false);
+                        standbyReady.store(false);
+                        transitionFinished.store(true);
+                }
+                return;
+        }
+
+        const int current = currentDeck.load();
+        const int standby = standbyDeck.load();
+
+        if (!standbyReady.load() || current < 0 || standby < 0) {
+                return;
+        }
+
+        // output samples until the playing track reaches its mix-out point
+        const double speed = juce::jmax(0.01, decks[current]->getCurrentSpeed());
+        const double untilMixOut = (mixOutSeconds.load() - decks[current]->getPositionInSeconds()) / speed * sampleRate;
+
+        if (untilMixOut >= numSamples) {
+                return;
+        }
+
+        const juce::int64 start = blockStart + juce::jmax<juce::int64>(0, (juce::int64) std::llround(untilMixOut));
+        const juce::int64 length = (juce::int64) (fadeSeconds.load() / speed * sampleRate);
+
+        states[current].fadingIn.store(false);
+        states[current].fadeStart.store(start);
+        states[current].fadeLength.store(length);
+
+        states[standby].fadingIn.store(true);
+        states[standby].fadeStart.store(start);
+        states[standby].fadeLength.store(length);
+        states[standby].opensAt.store(start);
+
+        transitionEnd = start + length;
+        transitioning.store(true);
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    AutoDJ.h
+    Created: 19/10/2026 20:41:03
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <deque>
+#include <limits>
+
+#include "AssemblePane.h"
+#include "AudioPlayer.h"
+#include "TrackAnalyser.h"
+
+//==============================================================================
+/*
+ * AutoDJ plays a queue of library tracks across the two decks. While one deck
+ * plays, the next track is loaded into the other one. That deck only counts as
+ * standing by once it is fully warm: decoded, attached to its transport, with
+ * its analysis and waveform ready and cued to its first beat. A track without
+ * a beat grid is cued to its start and mixed over 8 seconds, and one that
+ * cannot be decoded is skipped.
+ *
+ * Each deck reaches the mixer through a DeckOutput. While Auto DJ is on, the
+ * standby deck's output stays shut and does not pull its deck at all. The
+ * transition is scheduled on the audio thread in output samples. The block
+ * that crosses the mix-out point of the playing track opens the standby deck
+ * at that exact sample, and both decks cross-fade from there. With Auto DJ
+ * off, both outputs pass their decks through untouched.
+ *
+ * Until it is ready, the standby track gives way under memory pressure. The
+ * deck is unloaded, the track goes back to the front of the queue, and it is
+ * loaded again a little later.
+ */
+class AutoDJ : private juce::Timer {
+       public:
+        AutoDJ(AudioPlayer& deckA, AudioPlayer& deckB, AssemblePane& paneA, AssemblePane& paneB,
+               TrackAnalyser& trackAnalyser);
+        ~AutoDJ() override;
+
+        // message thread
+        void enqueue(const juce::File& file);
+        void setEnabled(bool shouldBeEnabled);
+        bool isEnabled() const;
+        juce::String getStatusText() const;
+
+        // what the mixer plays instead of the decks themselves, 0 = deck A
+        juce::AudioSource& getDeckOutput(int deck);
+
+        // audio thread, once per block before the decks are pulled
+        void prepare(double sampleRate);
+        void process(int numSamples);
+
+       private:
+        class DeckOutput : public juce::AudioSource {
+               public:
+                DeckOutput(AutoDJ& owner, int deck);
+
+                void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+                void releaseResources() override;
+                void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+               private:
+                AutoDJ& owner;
+                const int deck;
+        };
+
+        // per deck, written by the message thread between transitions and by the audio thread during one
+        struct DeckState {
+                // the deck is not pulled before this output sample
+                std::atomic<juce::int64> opensAt{0};
+                // equal-power fade, the gain is that of its start before and of its end after
+                std::atomic<juce::int64> fadeStart{0};
+                std::atomic<juce::int64> fadeLength{0};
+                std::atomic<bool> fadingIn{true};
+        };
+
+        void timerCallback() override;
+        bool isWarm(int deck) const;
+        void skipFailedStandby();
+        void loadNext(int deck);
+        bool letGoOfStandby(int deck, const DecodedTrack* track);
+        void cue(int deck);
+        void shut(int deck);
+        void open(int deck);
+        float getGain(int deck, juce::int64 sample) const;
+
+        static constexpr juce::int64 never = std::numeric_limits<juce::int64>::max();
+        static constexpr juce::uint32 standbyRetryMs = 10000;
+
+        AudioPlayer* decks[2];
+        AssemblePane* panes[2];
+        TrackAnalyser& trackAnalyser;
+        DeckOutput outputs[2]{{*this, 0}, {*this, 1}};
+        DeckState states[2];
+
+        // message thread
+        std::deque<juce::File> queue;
+        juce::File loadedFiles[2];
+        juce::String loadedTitles[2];
+        // a standby let go under memory pressure is not loaded again before this millisecond counter
+        juce::uint32 retryStandbyAt = 0;
+
+        // shared
+        std::atomic<bool> enabled{false};
+        std::atomic<int> currentDeck{-1};
+        std::atomic<int> standbyDeck{-1};
+        std::atomic<bool> standbyReady{false};
+        std::atomic<double> mixOutSeconds{0.0};
+        std::atomic<double> fadeSeconds{8.0};
+        std::atomic<bool> transitioning{false};
+        std::atomic<bool> transitionFinished{false};
+
+        // audio thread
+        double sampleRate = 44100.0;
+        // output samples rendered so far; blockStart is the first sample of the block being rendered
+        juce::int64 nextBlockStart = 0;
+        juce::int64 blockStart = 0;
+        juce::int64 transitionEnd = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AutoDJ)
+};
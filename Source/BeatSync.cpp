@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    BeatSync.cpp
+    Created: 19/10/2026 13:05:18
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "BeatSync.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+
+//==============================================================================
+BeatSync::BeatSync(AudioPlayer& _deckA, AudioPlayer& _deckB) : deckA(_deckA), deckB(_deckB) {}
+
+BeatSync::~BeatSync() {}
+
+void BeatSync::prepare(double _sampleRate) {
+        sampleRate = _sampleRate;
+        errorIntegral[0] = errorIntegral[1] = 0.0;
+}
+
+void BeatSync::process(int numSamples) {
+        const double blockSeconds = numSamples / sampleRate;
+        follow(0, deckA, deckB, blockSeconds);
+        follow(1, deckB, deckA, blockSeconds);
+}
+
+void BeatSync::follow(int followerIndex, AudioPlayer& follower, AudioPlayer& leader, double blockSeconds) {
+        // deck A leads when both are in sync mode
+        const bool shouldFollow = follower.isSyncEnabled() && !(followerIndex == 0 && leader.isSyncEnabled());
+        const BeatGrid followerGrid = follower.getBeatGrid();
+        const BeatGrid leaderGrid = leader.getBeatGrid();
+
+        if (!shouldFollow || !followerGrid.isValid() || !leaderGrid.isValid() || !leader.isPlaying()) {
+                if (following[followerIndex].exchange(false)) {
+                        follower.applySyncSpeed(follower.getUserSpeed());
+                }
+                phaseErrorMs[followerIndex].store(0.0);
+                errorIntegral[followerIndex] = 0.0;
+                return;
+        }
+
+        following[followerIndex].store(true);
+
+        // match tempo first
+        const double leaderTempo = leaderGrid.bpm * leader.getCurrentSpeed();
+        const double tempoRatio = leaderTempo / followerGrid.bpm;
+
+        // then pull the follower's beat phase onto the leader's, wrapped to the nearest beat
+        const double leaderBeats = leaderGrid.getBeatPosition(leader.getPositionInSeconds());
+        const double followerBeats = followerGrid.getBeatPosition(follower.getPositionInSeconds());
+        double phaseError = (leaderBeats - std::floor(leaderBeats)) - (followerBeats - std::floor(followerBeats));
+        phaseError -= std::round(phaseError);
+
+        const double errorSeconds = phaseError * 60.0 / leaderTempo;
+        const double correction = (errorSeconds + errorIntegral[followerIndex] / integralSeconds) / convergenceSeconds;
+        const double nudge = juce::jlimit(-maxNudge, maxNudge, correction);
+
+        // no winding up while the nudge is at its limit, e.g. pulling in after a seek
+        if (std::abs(correction) < maxNudge) {
+                errorIntegral[followerIndex] += errorSeconds * blockSeconds;
+        }
+
+        follower.applySyncSpeed(tempoRatio * (1.0 + nudge));
+        phaseErrorMs[followerIndex].store(errorSeconds * 1000.0);
+}
+
+double BeatSync::getPhaseErrorMs(int deck) const { return phaseErrorMs[deck].load(); }
+
+bool BeatSync::isFollowing(int deck) const { return following[deck].load(); }
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    BeatSync.h
+    Created: 19/10/2026 13:05:18
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+
+#include "AudioPlayer.h"
+
+//==============================================================================
+/*
+ * BeatSync locks the tempo and beat phase of a deck in sync mode to the other
+ * deck. It runs on the audio thread once per block, before the decks render,
+ * so every correction is based on the exact sample positions of both decks.
+ * When both decks are in sync mode the left deck leads.
+ *
+ * The phase correction is proportional plus integral. A beat grid whose BPM
+ * is slightly off makes the tempo match slightly off, and a proportional
+ * correction alone would hold the follower a constant distance behind or
+ * ahead to make up for it; the integral term takes that offset out.
+ */
+class BeatSync {
+       public:
+        BeatSync(AudioPlayer& deckA, AudioPlayer& deckB);
+        ~BeatSync();
+
+        // before the first process(), and again whenever the device restarts
+        void prepare(double sampleRate);
+        // audio thread, call once per block before the decks are pulled
+        void process(int numSamples);
+
+        // last measured phase difference of a following deck to its leader, 0 = deck A, 1 = deck B
+        double getPhaseErrorMs(int deck) const;
+        bool isFollowing(int deck) const;
+
+       private:
+        void follow(int followerIndex, AudioPlayer& follower, AudioPlayer& leader, double blockSeconds);
+
+        // proportional phase correction: remaining error is closed over this many seconds
+        static constexpr double convergenceSeconds = 0.5;
+        // integral time; with the proportional term above this is critically damped
+        static constexpr double integralSeconds = 2.0;
+        // largest speed change the correction may add on top of the tempo match
+        static constexpr double maxNudge = 0.04;
+
+        AudioPlayer& deckA;
+        AudioPlayer& deckB;
+
+        double sampleRate = 44100.0;
+        // audio thread only: the phase error summed over time, in seconds squared
+        double errorIntegral[2] = {0.0, 0.0};
+
+        std::atomic<double> phaseErrorMs[2] = {0.0, 0.0};
+        std::atomic<bool> following[2] = {false, false};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BeatSync)
+};
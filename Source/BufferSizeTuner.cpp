@@ -0,0 +1,261 @@
+/*
+  ==============================================================================
+
+    BufferSizeTuner.cpp
+    Created: 19/10/2026 18:57:41
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "BufferSizeTuner.h"
+
+#include <JuceHeader.h>
+
+#include "Log.h"
+
+namespace {
+// kept with the library in the working directory
+juce::File getStateFile() { return juce::File::getCurrentWorkingDirectory().getChildFile("audioDeviceState.xml"); }
+
+juce::String describeLatency(juce::AudioIODevice& device) {
+        const double sampleRate = device.getCurrentSampleRate();
+        const int bufferSize = device.getCurrentBufferSizeSamples();
+
+        if (sampleRate <= 0) {
+                return {};
+        }
+
+        // output: one buffer plus what the driver reports; round trip adds the input side and a second buffer
+        const double outputMs = (device.getOutputLatencyInSamples() + bufferSize) * 1000.0 / sampleRate;
+        const double roundTripMs =
+            (device.getInputLatencyInSamples() + device.getOutputLatencyInSamples() + 2 * bufferSize) * 1000.0 /
+            sampleRate;
+
+        return "Buffer " + juce::String(bufferSize) + " samples, output " + juce::String(outputMs, 1) +
+               " ms, round trip " + juce::String(roundTripMs, 1) + " ms";
+}
+}        // namespace
+
+//==============================================================================
+void BufferSizeTuner::NoiseSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) {
+        for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel) {
+                float* data = bufferToFill.buffer->getWritePointer(channel, bufferToFill.startSample);
+
+                for (int i = 0; i < bufferToFill.numSamples; ++i) {
+                        data[i] = 0.1f * (random.nextFloat() * 2.0f - 1.0f);
+                }
+        }
+}
+
+//==============================================================================
+BufferSizeTuner::BufferSizeTuner(juce::AudioDeviceManager& _deviceManager) : deviceManager(_deviceManager) {
+        // a slightly sped up key-locked deck, the most expensive thing a deck does
+        for (LoadDeck& deck : loadDecks) {
+                deck.keyLock.setEnabled(true);
+                deck.keyLock.setTempo(1.04);
+        }
+}
+
+BufferSizeTuner::~BufferSizeTuner() { stopTimer(); }
+
+std::unique_ptr<juce::XmlElement> BufferSizeTuner::loadSavedState() {
+        const juce::File file = getStateFile();
+        return file.existsAsFile() ? juce::parseXML(file) : nullptr;
+}
+
+void BufferSizeTuner::start() {
+        if (isRunning()) {
+                return;
+        }
+
+        juce::AudioIODevice* device = deviceManager.getCurrentAudioDevice();
+        if (device == nullptr) {
+                statusText = "Tuning: no audio device";
+                return;
+        }
+
+        originalSetup = deviceManager.getAudioDeviceSetup();
+        candidates.clear();
+
+        for (int size : device->getAvailableBufferSizes()) {
+                if (size >= 32 && size <= 4096) {
+                        candidates.addIfNotAlreadyThere(size);
+                }
+        }
+        candidates.sort();
+
+        if (candidates.isEmpty()) {
+                statusText = "Tuning: the device offers no buffer sizes";
+                return;
+        }
+
+        candidateIndex = 0;
+        applyCandidate();
+        startTimer(100);
+}
+
+void BufferSizeTuner::cancel() {
+        if (isRunning()) {
+                finish(false);
+                statusText = "Tuning cancelled";
+        }
+}
+
+bool BufferSizeTuner::isRunning() const { return phase != Phase::idle; }
+
+juce::String BufferSizeTuner::getStatusText() const {
+        if (statusText.isNotEmpty()) {
+                return statusText;
+        }
+
+        juce::AudioIODevice* device = deviceManager.getCurrentAudioDevice();
+        return device != nullptr ? describeLatency(*device) : juce::String();
+}
+
+//==============================================================================
+void BufferSizeTuner::applyCandidate() {
+        measuring.store(false);
+
+        juce::AudioDeviceManager::AudioDeviceSetup setup = deviceManager.getAudioDeviceSetup();
+        setup.bufferSize = candidates[candidateIndex];
+
+        const juce::String error = deviceManager.setAudioDeviceSetup(setup, true);
+        if (error.isNotEmpty()) {
+                OTODECK_LOG(info, "BufferSizeTuner", setup.bufferSize << " samples rejected: " << error);
+        }
+
+        loadActive.store(true);
+        phase = Phase::settling;
+        phaseEnds = juce::Time::getMillisecondCounter() + settleMs;
+        statusText = "Tuning: trying " + juce::String(setup.bufferSize) + " samples";
+}
+
+void BufferSizeTuner::timerCallback() {
+        if (juce::Time::getMillisecondCounter() < phaseEnds) {
+                return;
+        }
+
+        juce::AudioIODevice* device = deviceManager.getCurrentAudioDevice();
+        if (device == nullptr) {
+                finish(false);
+                return;
+        }
+
+        if (phase == Phase::settling) {
+                // the device has restarted and warmed up, measure from here
+                maxLoad.store(0.0f);
+                lateCallbacks.store(0);
+                callbacks.store(0);
+                xrunsAtStart = device->getXRunCount();
+                measuring.store(true);
+
+                phase = Phase::measuring;
+                phaseEnds = juce::Time::getMillisecondCounter() + measureMs;
+                return;
+        }
+
+        measuring.store(false);
+
+        // devices that cannot count xruns return -1, late callbacks still catch most of them
+        const int xrunsNow = device->getXRunCount();
+        const int xruns = xrunsAtStart >= 0 && xrunsNow >= 0 ? xrunsNow - xrunsAtStart : 0;
+        const bool passed = callbacks.load() > 0 && xruns == 0 && lateCallbacks.load() == 0 &&
+                            maxLoad.load() < maxCallbackLoad;
+
+        OTODECK_LOG(info, "BufferSizeTuner",
+                    candidates[candidateIndex] << " samples, " << xruns << " xruns, " << lateCallbacks.load()
+                                               << " late, peak load " << maxLoad.load());
+
+        if (passed) {
+                finish(true);
+        } else if (++candidateIndex < candidates.size()) {
+                applyCandidate();
+        } else {
+                finish(false);
+        }
+}
+
+void BufferSizeTuner::finish(bool succeeded) {
+        stopTimer();
+        phase = Phase::idle;
+        loadActive.store(false);
+        measuring.store(false);
+
+        if (!succeeded) {
+                deviceManager.setAudioDeviceSetup(originalSetup, true);
+                statusText = "Tuning: no buffer size was glitch-free, settings unchanged";
+                return;
+        }
+
+        if (std::unique_ptr<juce::XmlElement> state = deviceManager.createStateXml()) {
+                state->writeTo(getStateFile());
+        }
+
+        juce::AudioIODevice* device = deviceManager.getCurrentAudioDevice();
+        statusText = device != nullptr ? "Tuned: " + describeLatency(*device) : juce::String();
+}
+
+//==============================================================================
+void BufferSizeTuner::prepare(int samplesPerBlockExpected, double _sampleRate) {
+        sampleRate = _sampleRate;
+        loadBuffer.setSize(2, juce::jmax(1, samplesPerBlockExpected));
+
+        const juce::dsp::ProcessSpec spec{sampleRate, (juce::uint32) loadBuffer.getNumSamples(), 2};
+
+        for (LoadDeck& deck : loadDecks) {
+                deck.keyLock.prepareToPlay(loadBuffer.getNumSamples(), sampleRate);
+
+                deck.bass.prepare(spec);
+                deck.mid.prepare(spec);
+                deck.treble.prepare(spec);
+                deck.bass.state = juce::dsp::IIR::Coefficients<float>::makeLowShelf(sampleRate, 200.0f, 0.707f, 1.5f);
+                deck.mid.state = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, 1000.0f, 1.0f, 0.8f);
+                deck.treble.state = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, 5000.0f, 0.707f, 1.2f);
+        }
+}
+
+void BufferSizeTuner::callbackFinished(juce::int64 callbackStartTicks, int numSamples) {
+        if (loadActive.load()) {
+                runLoad(numSamples);
+        }
+
+        const double startSeconds = juce::Time::highResolutionTicksToSeconds(callbackStartTicks);
+        const double blockDuration = numSamples / sampleRate;
+
+        if (measuring.load() && blockDuration > 0) {
+                const double elapsed =
+                    juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - callbackStartTicks);
+                const float load = (float) (elapsed / blockDuration);
+
+                if (load > maxLoad.load()) {
+                        maxLoad.store(load);
+                }
+
+                // a callback that comes much later than one block after the previous one means the device starved
+                if (lastCallbackSeconds > 0 && startSeconds - lastCallbackSeconds > 1.5 * blockDuration + 0.002) {
+                        lateCallbacks.fetch_add(1);
+                }
+                callbacks.fetch_add(1);
+        }
+
+        lastCallbackSeconds = startSeconds;
+}
+
+void BufferSizeTuner::runLoad(int numSamples) {
+        for (LoadDeck& deck : loadDecks) {
+                for (int done = 0; done < numSamples;) {
+                        const int blockSize = juce::jmin(loadBuffer.getNumSamples(), numSamples - done);
+
+                        deck.keyLock.getNextAudioBlock(juce::AudioSourceChannelInfo(&loadBuffer, 0, blockSize));
+
+                        juce::dsp::AudioBlock<float> block = juce::dsp::AudioBlock<float>(loadBuffer).getSubBlock(0, (size_t) blockSize);
+                        juce::dsp::ProcessContextReplacing<float> context(block);
+                        deck.bass.process(context);
+                        deck.mid.process(context);
+                        deck.treble.process(context);
+
+                        done += blockSize;
+                }
+        }
+}
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    BufferSizeTuner.h
+    Created: 19/10/2026 18:57:41
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <memory>
+
+#include "TimeStretchAudioSource.h"
+
+//==============================================================================
+/*
+ * BufferSizeTuner finds the smallest device buffer size that plays without
+ * glitches. It steps through the buffer sizes the device offers, smallest
+ * first, and at each one runs a silent load standing in for two key-locked
+ * decks with EQ on top of the real audio callback. A size passes when the
+ * device reports no xruns, no callback arrives late and the callback never
+ * uses more than maxCallbackLoad of its time. The first size that passes is
+ * kept and the device state is saved, so it is restored on the next start.
+ */
+class BufferSizeTuner : private juce::Timer {
+       public:
+        explicit BufferSizeTuner(juce::AudioDeviceManager& deviceManager);
+        ~BufferSizeTuner() override;
+
+        // device state saved by the last calibration, nullptr if there is none
+        static std::unique_ptr<juce::XmlElement> loadSavedState();
+
+        // message thread
+        void start();
+        void cancel();
+        bool isRunning() const;
+        // progress while running, the result afterwards
+        juce::String getStatusText() const;
+
+        // audio thread, from prepareToPlay and at the end of every callback
+        void prepare(int samplesPerBlockExpected, double sampleRate);
+        void callbackFinished(juce::int64 callbackStartTicks, int numSamples);
+
+       private:
+        // white noise at zero cost, the input of the calibration load
+        class NoiseSource : public juce::AudioSource {
+               public:
+                void prepareToPlay(int, double) override {}
+                void releaseResources() override {}
+                void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+               private:
+                juce::Random random;
+        };
+
+        // one deck worth of work: noise through key lock and a three-band EQ
+        struct LoadDeck {
+                NoiseSource noise;
+                TimeStretchAudioSource keyLock{&noise, 2};
+                juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> bass,
+                    mid, treble;
+        };
+
+        enum class Phase { idle, settling, measuring };
+
+        void timerCallback() override;
+        void applyCandidate();
+        void finish(bool succeeded);
+        void runLoad(int numSamples);
+
+        static constexpr int settleMs = 500;
+        static constexpr int measureMs = 3000;
+        static constexpr float maxCallbackLoad = 0.7f;
+
+        juce::AudioDeviceManager& deviceManager;
+
+        // message thread
+        Phase phase = Phase::idle;
+        juce::Array<int> candidates;
+        int candidateIndex = 0;
+        juce::uint32 phaseEnds = 0;
+        int xrunsAtStart = -1;
+        juce::AudioDeviceManager::AudioDeviceSetup originalSetup;
+        juce::String statusText;
+
+        // audio thread, measured between reset and evaluation
+        std::atomic<bool> loadActive{false};
+        std::atomic<bool> measuring{false};
+        std::atomic<float> maxLoad{0.0f};
+        std::atomic<int> lateCallbacks{0};
+        std::atomic<int> callbacks{0};
+        double lastCallbackSeconds = 0.0;
+        double sampleRate = 44100.0;
+
+        LoadDeck loadDecks[2];
+        juce::AudioBuffer<float> loadBuffer;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BufferSizeTuner)
+};
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    ColouredWaveform.cpp
+    Created: 19/10/2026 17:48:36
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "ColouredWaveform.h"
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const int fileMagic = 0x57424752;        // "RGBW"
+const int fileVersion = 1;
+
+std::vector<juce::uint8> quantise(const std::vector<float>& values, float scale) {
+        std::vector<juce::uint8> bytes(values.size());
+        std::transform(values.begin(), values.end(), bytes.begin(),
+                       [scale](float value) { return (juce::uint8) juce::jlimit(0, 255, juce::roundToInt(value * scale)); });
+        return bytes;
+}
+}        // namespace
+
+//==============================================================================
+std::shared_ptr<const ColouredWaveform> ColouredWaveform::compute(const DecodedTrack& track) {
+        constexpr int fftOrder = 10;
+        constexpr int fftSize = 1 << fftOrder;
+
+        const int length = (int) track.getLengthInSamples();
+        const int numChannels = track.samples.getNumChannels();
+
+        if (length <= 0 || numChannels <= 0 || track.sampleRate <= 0) {
+                return nullptr;
+        }
+
+        const int hop = juce::jmax(1, juce::roundToInt(track.sampleRate / columnsPerSecond));
+        const int numColumns = (length + hop - 1) / hop;
+        const int lowEnd = juce::jlimit(1, fftSize / 2, juce::roundToInt(250.0 * fftSize / track.sampleRate));
+        const int midEnd = juce::jlimit(lowEnd, fftSize / 2, juce::roundToInt(4000.0 * fftSize / track.sampleRate));
+
+        juce::dsp::FFT fft(fftOrder);
+        juce::dsp::WindowingFunction<float> window((size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false);
+        std::vector<float> frame((size_t) fftSize * 2);
+
+        std::vector<float> peaks((size_t) numColumns), lows((size_t) numColumns), mids((size_t) numColumns),
+            highs((size_t) numColumns);
+
+        auto bandEnergy = [&frame](int first, int last) {
+                float sum = 0.0f;
+                for (int bin = first; bin < last; ++bin) {
+                        sum += frame[(size_t) bin];
+                }
+                return std::sqrt(sum);
+        };
+
+        for (int column = 0; column < numColumns; ++column) {
+                const int start = column * hop;
+                const int numSamples = juce::jmin(fftSize, length - start);
+                float* data = frame.data();
+
+                // mono mix of the frame, then peak, window and magnitude spectrum, all on whole blocks
+                juce::FloatVectorOperations::copy(data, track.samples.getReadPointer(0, start), numSamples);
+                for (int channel = 1; channel < numChannels; ++channel) {
+                        juce::FloatVectorOperations::add(data, track.samples.getReadPointer(channel, start), numSamples);
+                }
+                juce::FloatVectorOperations::multiply(data, 1.0f / (float) numChannels, numSamples);
+                juce::FloatVectorOperations::clear(data + numSamples, fftSize * 2 - numSamples);
+
+                const juce::Range<float> range =
+                    juce::FloatVectorOperations::findMinAndMax(data, juce::jmin(hop, numSamples));
+                peaks[(size_t) column] = juce::jmax(-range.getStart(), range.getEnd());
+
+                window.multiplyWithWindowingTable(data, (size_t) fftSize);
+                fft.performFrequencyOnlyForwardTransform(data, true);
+                juce::FloatVectorOperations::multiply(data, data, fftSize / 2 + 1);
+
+                lows[(size_t) column] = bandEnergy(1, lowEnd);
+                mids[(size_t) column] = bandEnergy(lowEnd, midEnd);
+                highs[(size_t) column] = bandEnergy(midEnd, fftSize / 2 + 1);
+        }
+
+        auto maxOf = [](const std::vector<float>& values) {
+                const float max = *std::max_element(values.begin(), values.end());
+                return max > 0.0f ? 255.0f / max : 0.0f;
+        };
+
+        auto waveform = std::make_shared<ColouredWaveform>();
+        waveform->peaks = quantise(peaks, 255.0f);
+        waveform->lows = quantise(lows, maxOf(lows));
+        waveform->mids = quantise(mids, maxOf(mids));
+        waveform->highs = quantise(highs, maxOf(highs));
+        return waveform;
+}
+
+//==============================================================================
+std::shared_ptr<const ColouredWaveform> ColouredWaveform::load(const juce::File& file) {
+        juce::FileInputStream stream(file);
+
+        if (!stream.openedOk() || stream.readInt() != fileMagic || stream.readInt() != fileVersion) {
+                return nullptr;
+        }
+
+        const int numColumns = stream.readInt();
+        if (numColumns <= 0 || stream.getNumBytesRemaining() != (juce::int64) numColumns * 4) {
+                return nullptr;
+        }
+
+        auto waveform = std::make_shared<ColouredWaveform>();
+        for (auto* values : {&waveform->peaks, &waveform->lows, &waveform->mids, &waveform->highs}) {
+                values->resize((size_t) numColumns);
+                stream.read(values->data(), numColumns);
+        }
+        return waveform;
+}
+
+bool ColouredWaveform::save(const juce::File& file) const {
+        file.getParentDirectory().createDirectory();
+
+        // written next to the target and moved over it, so a crash never leaves half a file
+        juce::TemporaryFile temporary(file);
+        {
+                juce::FileOutputStream stream(temporary.getFile());
+
+                if (!stream.openedOk()) {
+                        return false;
+                }
+
+                stream.writeInt(fileMagic);
+                stream.writeInt(fileVersion);
+                stream.writeInt(getNumColumns());
+                for (const auto* values : {&peaks, &lows, &mids, &highs}) {
+                        stream.write(values->data(), values->size());
+                }
+        }
+        return temporary.overwriteTargetFileWithTemporary();
+}
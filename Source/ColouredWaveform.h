@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    ColouredWaveform.h
+    Created: 19/10/2026 17:48:36
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <memory>
+#include <vector>
+
+#include "DecodedAudioCache.h"
+
+//==============================================================================
+/*
+ * Overview waveform with three-band colour: for every 10 ms column it keeps
+ * the peak level and the energy below 250 Hz, between 250 Hz and 4 kHz and
+ * above 4 kHz, each quantised to a byte. Bands are scaled to their own
+ * maximum over the track, so colour changes show where the mix changes.
+ *
+ * Computed once per track and cached on disk, keyed by track identity.
+ */
+struct ColouredWaveform {
+        static constexpr int columnsPerSecond = 100;
+
+        std::vector<juce::uint8> peaks;
+        std::vector<juce::uint8> lows;
+        std::vector<juce::uint8> mids;
+        std::vector<juce::uint8> highs;
+
+        int getNumColumns() const { return (int) peaks.size(); }
+        size_t getSizeInBytes() const { return sizeof(ColouredWaveform) + 4 * peaks.size(); }
+
+        // FFT per column over the mono mix, needs the complete track
+        static std::shared_ptr<const ColouredWaveform> compute(const DecodedTrack& track);
+
+        // nullptr if the file is missing or not a waveform of this version
+        static std::shared_ptr<const ColouredWaveform> load(const juce::File& file);
+        bool save(const juce::File& file) const;
+};
@@ -0,0 +1,413 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.cpp
+    Created: 19/10/2026 17:05:52
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "ConvolutionReverb.h"
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "Log.h"
+
+//==============================================================================
+ConvolutionReverb::ConvolutionReverb() : juce::Thread("Reverb tail") {}
+
+ConvolutionReverb::~ConvolutionReverb() { stopThread(2000); }
+
+void ConvolutionReverb::prepare(double _sampleRate, int _maximumBlockSize) {
+        stopThread(2000);
+
+        sampleRate = _sampleRate;
+        maximumBlockSize = juce::jmax(1, _maximumBlockSize);
+
+        head.prepare({sampleRate, (juce::uint32) maximumBlockSize, (juce::uint32) numChannels});
+        wetBuffer.setSize(numChannels, maximumBlockSize);
+        wetGain.reset(sampleRate, 0.05);
+        wetGain.setCurrentAndTargetValue(wetLevel.load());
+
+        const int inputSize = 4 * tailPartitionSize + maximumBlockSize + 1;
+        inputFifoBuffer.setSize(numChannels, inputSize);
+        inputFifo.setTotalSize(inputSize);
+        inputFifo.reset();
+
+        const int outputSize = headSize + 2 * tailPartitionSize + 2 * maximumBlockSize + 1;
+        outputFifoBuffer.setSize(numChannels, outputSize);
+        outputFifo.setTotalSize(outputSize);
+        outputFifo.reset();
+
+        // the tail only starts headSize samples into the IR, so its output stream starts with that much silence
+        int start1, size1, start2, size2;
+        outputFifo.prepareToWrite(headSize, start1, size1, start2, size2);
+        outputFifoBuffer.clear();
+        outputFifo.finishedWrite(size1 + size2);
+        tailSamplesOwed = 0;
+
+        previousInput.setSize(numChannels, tailPartitionSize);
+        previousInput.clear();
+        fftBuffer.assign((size_t) fftSize * 2, 0.0f);
+        spectrumSum.assign((size_t) numBins, {});
+        kernel.reset();
+        delayLine.clear();
+        delayLineIndex = 0;
+
+        rebuild();
+        if (!nonRealtime.load()) {
+                startThread();
+        }
+}
+
+void ConvolutionReverb::release() {
+        stopThread(2000);
+        head.reset();
+}
+
+void ConvolutionReverb::loadImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double impulseSampleRate) {
+        {
+                const juce::ScopedLock sl(impulseLock);
+                loadedImpulse.makeCopyOf(impulseResponse);
+                loadedImpulseRate = impulseSampleRate;
+        }
+        rebuild();
+}
+
+double ConvolutionReverb::getImpulseResponseSeconds() const { return impulseSeconds.load(); }
+
+void ConvolutionReverb::setWetLevel(float newWetLevel) { wetLevel.store(juce::jlimit(0.0f, 1.0f, newWetLevel)); }
+
+juce::int64 ConvolutionReverb::getMissedTailSamples() const { return missedTailSamples.load(); }
+
+void ConvolutionReverb::setNonRealtime(bool isNonRealtime) {
+        if (isNonRealtime) {
+                stopThread(2000);
+        }
+        nonRealtime.store(isNonRealtime);
+
+        if (!isNonRealtime && sampleRate > 0) {
+                startThread();
+        }
+}
+
+juce::AudioBuffer<float> ConvolutionReverb::makeRoomImpulseResponse(double sampleRate, double seconds) {
+        const int length = juce::jmax(1, (int) (sampleRate * seconds));
+        const int preDelay = (int) (sampleRate * 0.01);
+
+        juce::AudioBuffer<float> impulse(numChannels, length);
+        impulse.clear();
+        juce::Random random(0x5eed);
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+                float* data = impulse.getWritePointer(channel);
+
+                // 60 dB of exponential decay over the length
+                for (int i = preDelay; i < length; ++i) {
+                        const float envelope = std::exp(-6.9f * (float) i / (float) length);
+                        data[i] = (random.nextFloat() * 2.0f - 1.0f) * envelope;
+                }
+        }
+        return impulse;
+}
+
+//==============================================================================
+void ConvolutionReverb::rebuild() {
+        juce::AudioBuffer<float> impulse;
+        {
+                const juce::ScopedLock sl(impulseLock);
+
+                if (loadedImpulse.getNumSamples() == 0 || loadedImpulseRate <= 0 || sampleRate <= 0) {
+                        return;
+                }
+
+                // resample to the playback rate, reading from a padded copy as the interpolator looks ahead
+                const double ratio = loadedImpulseRate / sampleRate;
+                const int length = (int) std::ceil(loadedImpulse.getNumSamples() / ratio);
+                juce::HeapBlock<float> padded((size_t) loadedImpulse.getNumSamples() + 8, true);
+                impulse.setSize(numChannels, length);
+
+                for (int channel = 0; channel < numChannels; ++channel) {
+                        const int source = juce::jmin(channel, loadedImpulse.getNumChannels() - 1);
+                        juce::FloatVectorOperations::copy(padded, loadedImpulse.getReadPointer(source),
+                                                          loadedImpulse.getNumSamples());
+
+                        juce::LagrangeInterpolator interpolator;
+                        interpolator.process(ratio, padded, impulse.getWritePointer(channel), length);
+                }
+        }
+
+        // unit energy per channel, so different IRs come out at a similar level
+        double energy = 0.0;
+        for (int channel = 0; channel < numChannels; ++channel) {
+                const float rms = impulse.getRMSLevel(channel, 0, impulse.getNumSamples());
+                energy += (double) rms * rms * impulse.getNumSamples();
+        }
+        if (energy > 1.0e-12) {
+                impulse.applyGain((float) (1.0 / std::sqrt(energy / numChannels)));
+        }
+
+        juce::AudioBuffer<float> headImpulse(numChannels, juce::jmin(headSize, impulse.getNumSamples()));
+        for (int channel = 0; channel < numChannels; ++channel) {
+                headImpulse.copyFrom(channel, 0, impulse, channel, 0, headImpulse.getNumSamples());
+        }
+        head.loadImpulseResponse(std::move(headImpulse), sampleRate, juce::dsp::Convolution::Stereo::yes,
+                                 juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+
+        std::unique_ptr<TailKernel> tail = makeTailKernel(impulse);
+        OTODECK_LOG(info, "ConvolutionReverb",
+                    impulse.getNumSamples() << " sample IR, " << tail->numPartitions << " tail partitions");
+        {
+                const juce::ScopedLock sl(impulseLock);
+                pendingKernel = std::move(tail);
+        }
+        kernelPending.store(true);
+
+        impulseSeconds.store(impulse.getNumSamples() / sampleRate);
+        headSettled.store(false);
+        loaded.store(true);
+}
+
+std::unique_ptr<ConvolutionReverb::TailKernel> ConvolutionReverb::makeTailKernel(
+    const juce::AudioBuffer<float>& impulseResponse) const {
+        auto tail = std::make_unique<TailKernel>();
+        const int tailLength = juce::jmax(0, impulseResponse.getNumSamples() - headSize);
+
+        tail->numPartitions = (tailLength + tailPartitionSize - 1) / tailPartitionSize;
+        tail->spectra.assign((size_t) (numChannels * tail->numPartitions * numBins), {});
+
+        // the worker owns the member FFT, this runs on the loading thread
+        juce::dsp::FFT partitionFft(fftOrder);
+        std::vector<float> buffer((size_t) fftSize * 2);
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+                for (int partition = 0; partition < tail->numPartitions; ++partition) {
+                        const int offset = headSize + partition * tailPartitionSize;
+                        const int length = juce::jmin(tailPartitionSize, impulseResponse.getNumSamples() - offset);
+
+                        std::fill(buffer.begin(), buffer.end(), 0.0f);
+                        juce::FloatVectorOperations::copy(buffer.data(), impulseResponse.getReadPointer(channel, offset),
+                                                          length);
+                        partitionFft.performRealOnlyForwardTransform(buffer.data(), true);
+
+                        const auto* bins = reinterpret_cast<const std::complex<float>*>(buffer.data());
+                        std::copy(bins, bins + numBins,
+                                  tail->spectra.begin() + (channel * tail->numPartitions + partition) * numBins);
+                }
+        }
+        return tail;
+}
+
+//==============================================================================
+void ConvolutionReverb::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+        if (!loaded.load() || wetBuffer.getNumSamples() == 0) {
+                return;
+        }
+
+        if (nonRealtime.load() && !headSettled.load()) {
+                settleHead();
+        }
+
+        wetGain.setTargetValue(wetLevel.load());
+        const int lastChannel = juce::jmin(buffer.getNumChannels(), numChannels) - 1;
+
+        for (int done = 0; done < numSamples;) {
+                const int blockSize = juce::jmin(maximumBlockSize, numSamples - done);
+                const int position = startSample + done;
+                int start1, size1, start2, size2;
+
+                // the tail worker sees every sample even while the reverb is silent, so it stays in time
+                inputFifo.prepareToWrite(blockSize, start1, size1, start2, size2);
+                for (int channel = 0; channel < numChannels; ++channel) {
+                        const int source = juce::jmin(channel, lastChannel);
+                        if (size1 > 0) {
+                                inputFifoBuffer.copyFrom(channel, start1, buffer, source, position, size1);
+                        }
+                        if (size2 > 0) {
+                                inputFifoBuffer.copyFrom(channel, start2, buffer, source, position + size1, size2);
+                        }
+                }
+                inputFifo.finishedWrite(size1 + size2);
+
+                if (nonRealtime.load()) {
+                        serviceTail();
+                }
+
+                const bool silent = !wetGain.isSmoothing() && wetGain.getTargetValue() <= 0.0f;
+
+                if (!silent) {
+                        for (int channel = 0; channel < numChannels; ++channel) {
+                                wetBuffer.copyFrom(channel, 0, buffer, juce::jmin(channel, lastChannel), position, blockSize);
+                        }
+
+                        juce::dsp::AudioBlock<float> block(wetBuffer.getArrayOfWritePointers(), (size_t) numChannels, 0,
+                                                           (size_t) blockSize);
+                        head.process(juce::dsp::ProcessContextReplacing<float>(block));
+                }
+
+                // samples the worker delivered too late are thrown away to keep the tail aligned
+                if (tailSamplesOwed > 0) {
+                        const int skip = juce::jmin(tailSamplesOwed, outputFifo.getNumReady());
+                        outputFifo.prepareToRead(skip, start1, size1, start2, size2);
+                        outputFifo.finishedRead(size1 + size2);
+                        tailSamplesOwed -= size1 + size2;
+                }
+
+                const int ready = tailSamplesOwed > 0 ? 0 : juce::jmin(blockSize, outputFifo.getNumReady());
+                outputFifo.prepareToRead(ready, start1, size1, start2, size2);
+
+                if (!silent) {
+                        for (int channel = 0; channel < numChannels; ++channel) {
+                                if (size1 > 0) {
+                                        wetBuffer.addFrom(channel, 0, outputFifoBuffer, channel, start1, size1);
+                                }
+                                if (size2 > 0) {
+                                        wetBuffer.addFrom(channel, size1, outputFifoBuffer, channel, start2, size2);
+                                }
+                        }
+                }
+                outputFifo.finishedRead(size1 + size2);
+
+                if (ready < blockSize) {
+                        tailSamplesOwed += blockSize - ready;
+                        missedTailSamples.fetch_add(blockSize - ready);
+                }
+
+                const float startGain = wetGain.getCurrentValue();
+                wetGain.skip(blockSize);
+
+                if (!silent) {
+                        for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+                                buffer.addFromWithRamp(channel, position,
+                                                       wetBuffer.getReadPointer(juce::jmin(channel, numChannels - 1)),
+                                                       blockSize, startGain, wetGain.getCurrentValue());
+                        }
+                }
+
+                done += blockSize;
+        }
+}
+
+//==============================================================================
+void ConvolutionReverb::run() {
+        while (!threadShouldExit()) {
+                serviceTail();
+
+                // a partition is ~90 ms of audio, polling every 2 ms leaves almost all of it for the FFTs
+                wait(2);
+        }
+}
+
+void ConvolutionReverb::serviceTail() {
+        if (kernelPending.exchange(false)) {
+                std::unique_ptr<TailKernel> newKernel;
+                {
+                        const juce::ScopedLock sl(impulseLock);
+                        newKernel = std::move(pendingKernel);
+                }
+                adoptKernel(std::move(newKernel));
+        }
+
+        // a partition is a few milliseconds of work, so the worker still exits promptly between calls
+        while (inputFifo.getNumReady() >= tailPartitionSize && outputFifo.getFreeSpace() >= tailPartitionSize) {
+                processTailBlock();
+        }
+}
+
+void ConvolutionReverb::settleHead() {
+        // juce::dsp::Convolution builds the new IR on its own thread and cross-fades to it inside process().
+        // Offline that would make the first blocks depend on timing, so wait for it on silence, then let the
+        // cross-fade finish. Silence in leaves the convolution state silent, so nothing of this is heard.
+        juce::dsp::AudioBlock<float> block(wetBuffer.getArrayOfWritePointers(), (size_t) numChannels, 0,
+                                           (size_t) maximumBlockSize);
+        const juce::uint32 giveUpAt = juce::Time::getMillisecondCounter() + 5000;
+
+        while (head.getCurrentIRSize() == 0 && juce::Time::getMillisecondCounter() < giveUpAt) {
+                block.clear();
+                head.process(juce::dsp::ProcessContextReplacing<float>(block));
+                juce::Thread::sleep(1);
+        }
+
+        for (int done = 0; done < (int) (sampleRate * 0.2); done += maximumBlockSize) {
+                block.clear();
+                head.process(juce::dsp::ProcessContextReplacing<float>(block));
+        }
+
+        headSettled.store(true);
+}
+
+void ConvolutionReverb::adoptKernel(std::unique_ptr<TailKernel> newKernel) {
+        if (newKernel == nullptr) {
+                return;
+        }
+
+        // the old kernel is freed here, on the worker
+        kernel = std::move(newKernel);
+        delayLine.assign((size_t) (numChannels * kernel->numPartitions * numBins), {});
+        delayLineIndex = 0;
+}
+
+void ConvolutionReverb::processTailBlock() {
+        int inStart1, inSize1, inStart2, inSize2;
+        int outStart1, outSize1, outStart2, outSize2;
+        inputFifo.prepareToRead(tailPartitionSize, inStart1, inSize1, inStart2, inSize2);
+        outputFifo.prepareToWrite(tailPartitionSize, outStart1, outSize1, outStart2, outSize2);
+
+        const int numPartitions = kernel != nullptr ? kernel->numPartitions : 0;
+        float* time = fftBuffer.data();
+        auto* bins = reinterpret_cast<std::complex<float>*>(time);
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+                float* output = outputFifoBuffer.getWritePointer(channel);
+
+                if (numPartitions == 0) {
+                        juce::FloatVectorOperations::clear(output + outStart1, outSize1);
+                        juce::FloatVectorOperations::clear(output + outStart2, outSize2);
+                        continue;
+                }
+
+                // overlap-save: the previous partition followed by the new one
+                const float* input = inputFifoBuffer.getReadPointer(channel);
+                juce::FloatVectorOperations::copy(time, previousInput.getReadPointer(channel), tailPartitionSize);
+                juce::FloatVectorOperations::copy(time + tailPartitionSize, input + inStart1, inSize1);
+                juce::FloatVectorOperations::copy(time + tailPartitionSize + inSize1, input + inStart2, inSize2);
+                previousInput.copyFrom(channel, 0, time + tailPartitionSize, tailPartitionSize);
+                std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+
+                fft.performRealOnlyForwardTransform(time, true);
+
+                std::complex<float>* channelDelayLine = delayLine.data() + channel * numPartitions * numBins;
+                std::copy(bins, bins + numBins, channelDelayLine + delayLineIndex * numBins);
+
+                // the newest input spectrum meets the first tail partition, older ones the later partitions
+                std::fill(spectrumSum.begin(), spectrumSum.end(), std::complex<float>{});
+                const std::complex<float>* channelKernel = kernel->spectra.data() + channel * numPartitions * numBins;
+
+                for (int partition = 0; partition < numPartitions; ++partition) {
+                        const int slot = (delayLineIndex - partition + numPartitions) % numPartitions;
+                        const std::complex<float>* x = channelDelayLine + slot * numBins;
+                        const std::complex<float>* h = channelKernel + partition * numBins;
+
+                        for (int bin = 0; bin < numBins; ++bin) {
+                                spectrumSum[(size_t) bin] += x[bin] * h[bin];
+                        }
+                }
+
+                std::copy(spectrumSum.begin(), spectrumSum.end(), bins);
+                fft.performRealOnlyInverseTransform(time);
+
+                juce::FloatVectorOperations::copy(output + outStart1, time + tailPartitionSize, outSize1);
+                juce::FloatVectorOperations::copy(output + outStart2, time + tailPartitionSize + outSize1, outSize2);
+        }
+
+        if (numPartitions > 0) {
+                delayLineIndex = (delayLineIndex + 1) % numPartitions;
+        }
+
+        inputFifo.finishedRead(inSize1 + inSize2);
+        outputFifo.finishedWrite(outSize1 + outSize2);
+}
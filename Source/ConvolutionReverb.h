@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.h
+    Created: 19/10/2026 17:05:52
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/*
+ * ConvolutionReverb convolves a deck with a loadable impulse response at zero
+ * added latency, split non-uniformly:
+ *
+ *  - the head (the first 2 * tailPartitionSize samples of the IR) runs on the
+ *    audio thread through juce::dsp::Convolution, which has no latency;
+ *  - the rest of the IR is cut into partitions of tailPartitionSize samples
+ *    and convolved on a background thread with uniformly partitioned FFT
+ *    convolution. Because the tail starts two partitions into the IR, each
+ *    input partition has a full partition of time to be processed before its
+ *    output is due.
+ *
+ * The audio thread only copies samples into and out of two FIFOs for the
+ * tail, so the cost of a long IR is paid off the audio thread. If the tail
+ * worker ever misses its deadline the late samples are skipped and counted.
+ */
+class ConvolutionReverb : private juce::Thread {
+       public:
+        ConvolutionReverb();
+        ~ConvolutionReverb() override;
+
+        // allocates everything and rebuilds the loaded IR for the sample rate, not called while processing
+        void prepare(double sampleRate, int maximumBlockSize);
+        void release();
+
+        // message thread, the IR is resampled to the playback rate if needed
+        void loadImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double impulseSampleRate);
+        double getImpulseResponseSeconds() const;
+
+        // level of the reverb added to the dry signal, 0 bypasses it
+        void setWetLevel(float wetLevel);
+
+        // audio thread
+        void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+        // tail samples skipped because the worker was late
+        juce::int64 getMissedTailSamples() const;
+
+        // offline rendering: the tail is convolved inside process() instead of on the worker, so the output
+        // depends only on the input and never on timing. Set before prepare().
+        void setNonRealtime(bool isNonRealtime);
+
+        // decaying stereo noise, a plain room to use until an IR is loaded
+        static juce::AudioBuffer<float> makeRoomImpulseResponse(double sampleRate, double seconds);
+
+       private:
+        // FFT spectra of the tail partitions, built off the audio thread
+        struct TailKernel {
+                int numPartitions = 0;
+                // [channel][partition][bin]
+                std::vector<std::complex<float>> spectra;
+        };
+
+        void run() override;
+        void rebuild();
+        std::unique_ptr<TailKernel> makeTailKernel(const juce::AudioBuffer<float>& impulseResponse) const;
+        void adoptKernel(std::unique_ptr<TailKernel> kernel);
+        void serviceTail();
+        void processTailBlock();
+        void settleHead();
+
+        static constexpr int tailPartitionSize = 4096;
+        static constexpr int headSize = 2 * tailPartitionSize;
+        static constexpr int fftOrder = 13;
+        static constexpr int fftSize = 2 * tailPartitionSize;
+        static constexpr int numBins = fftSize / 2 + 1;
+        static constexpr int numChannels = 2;
+
+        juce::dsp::Convolution head{juce::dsp::Convolution::NonUniform{256}};
+
+        double sampleRate = 0.0;
+        int maximumBlockSize = 0;
+
+        // the IR as loaded, kept so it can be rebuilt for another sample rate
+        juce::CriticalSection impulseLock;
+        juce::AudioBuffer<float> loadedImpulse;
+        double loadedImpulseRate = 0.0;
+        std::atomic<double> impulseSeconds{0.0};
+        std::atomic<bool> loaded{false};
+
+        // handed from the message thread to the worker
+        std::unique_ptr<TailKernel> pendingKernel;
+        std::atomic<bool> kernelPending{false};
+
+        // offline mode, the worker is not running and process() does its work
+        std::atomic<bool> nonRealtime{false};
+        std::atomic<bool> headSettled{false};
+
+        // audio thread -> worker -> audio thread
+        juce::AbstractFifo inputFifo{1};
+        juce::AudioBuffer<float> inputFifoBuffer;
+        juce::AbstractFifo outputFifo{1};
+        juce::AudioBuffer<float> outputFifoBuffer;
+        int tailSamplesOwed = 0;
+        std::atomic<juce::int64> missedTailSamples{0};
+
+        // audio thread
+        juce::AudioBuffer<float> wetBuffer;
+        juce::SmoothedValue<float> wetGain;
+        std::atomic<float> wetLevel{0.0f};
+
+        // worker thread
+        std::unique_ptr<TailKernel> kernel;
+        juce::dsp::FFT fft{fftOrder};
+        std::vector<std::complex<float>> delayLine;        // [channel][partition][bin], input spectra
+        int delayLineIndex = 0;
+        juce::AudioBuffer<float> previousInput;
+        std::vector<float> fftBuffer;
+        std::vector<std::complex<float>> spectrumSum;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionReverb)
+};
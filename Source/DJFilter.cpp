@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    DJFilter.cpp
+    Created: 20/10/2026 01:07:52
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "DJFilter.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+
+//==============================================================================
+DJFilter::DJFilter() {
+        s1 = Vector::expand(0.0f);
+        s2 = Vector::expand(0.0f);
+        current = design(0.0f);
+}
+
+void DJFilter::prepare(double _sampleRate) {
+        sampleRate = _sampleRate;
+        position.reset(sampleRate, 0.05);
+        position.setCurrentAndTargetValue(targetPosition.load());
+        reset();
+}
+
+void DJFilter::reset() {
+        s1 = Vector::expand(0.0f);
+        s2 = Vector::expand(0.0f);
+        current = design(position.getCurrentValue());
+        active = position.getCurrentValue() != 0.0f;
+}
+
+void DJFilter::setPosition(float newPosition) {
+        const float clamped = juce::jlimit(-1.0f, 1.0f, newPosition);
+        targetPosition.store(std::abs(clamped) < centreDetent ? 0.0f : clamped);
+}
+
+double DJFilter::getCutoffForPosition(double position) {
+        if (std::abs(position) < centreDetent) {
+                return 0.0;
+        }
+
+        // exponential in the knob, so equal turns are equal musical intervals
+        return position < 0.0 ? 20000.0 * std::pow(40.0 / 20000.0, -position) : 20.0 * std::pow(10000.0 / 20.0, position);
+}
+
+juce::String DJFilter::getDescription(double position) {
+        const double cutoff = getCutoffForPosition(position);
+
+        if (cutoff <= 0.0) {
+                return "Off";
+        }
+
+        return juce::String(position < 0.0 ? "LPF " : "HPF ") +
+               (cutoff >= 1000.0 ? juce::String(cutoff / 1000.0, 1) + " kHz" : juce::String(juce::roundToInt(cutoff)) + " Hz");
+}
+
+DJFilter::Coefficients DJFilter::design(float knob) const {
+        const float amount = std::abs(knob);
+        // inside the detent the knob still fades a little filter in, sat at the open end of its side
+        const double cutoff = amount >= centreDetent ? getCutoffForPosition(knob) : knob > 0.0f ? 20.0 : 20000.0;
+        // pre-warped, and kept clear of Nyquist where tan() runs away
+        const double g = std::tan(juce::MathConstants<double>::pi * juce::jmin(cutoff, 0.45 * sampleRate) / sampleRate);
+
+        // at the centre the outputs add back up to the input, the filtered part takes over across fadeWidth
+        const float dry = 1.0f - juce::jmin(1.0f, amount / fadeWidth);
+
+        Coefficients coefficients;
+        coefficients.g = (float) g;
+        coefficients.h = (float) (1.0 / (1.0 + g * (g + k)));
+        coefficients.low = knob < 0.0f ? 1.0f : dry;
+        coefficients.band = k * dry;
+        coefficients.high = knob > 0.0f ? 1.0f : dry;
+        return coefficients;
+}
+
+//==============================================================================
+void DJFilter::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+        const int numChannels = juce::jmin(maxChannels, buffer.getNumChannels(), (int) Vector::SIMDNumElements);
+
+        if (numSamples <= 0 || numChannels == 0) {
+                return;
+        }
+
+        position.setTargetValue(targetPosition.load());
+
+        // dry and settled, the filter costs nothing; it restarts from silence, which the fade-in hides
+        if (!active) {
+                if (!position.isSmoothing() && position.getCurrentValue() == 0.0f) {
+                        return;
+                }
+                s1 = Vector::expand(0.0f);
+                s2 = Vector::expand(0.0f);
+                active = true;
+        }
+
+        float* channels[maxChannels];
+        for (int channel = 0; channel < numChannels; ++channel) {
+                channels[channel] = buffer.getWritePointer(channel, startSample);
+        }
+
+        // one sample of every channel, the register's lanes past the last channel stay silent
+        alignas(Vector::SIMDRegisterSize) float frame[Vector::SIMDNumElements] = {};
+
+        for (int done = 0; done < numSamples;) {
+                const int length = juce::jmin(rampLength, numSamples - done);
+                const Coefficients target = design(position.skip(length));
+
+                // each coefficient moves in a straight line from the last ramp's end to this one's
+                const float step = 1.0f / (float) length;
+                const float gStep = (target.g - current.g) * step, hStep = (target.h - current.h) * step;
+                const float lowStep = (target.low - current.low) * step, bandStep = (target.band - current.band) * step,
+                            highStep = (target.high - current.high) * step;
+                Coefficients c = current;
+
+                for (int i = done; i < done + length; ++i) {
+                        c.g += gStep;
+                        c.h += hStep;
+                        c.low += lowStep;
+                        c.band += bandStep;
+                        c.high += highStep;
+
+                        for (int channel = 0; channel < numChannels; ++channel) {
+                                frame[channel] = channels[channel][i];
+                        }
+                        const Vector x = Vector::fromRawArray(frame);
+
+                        const Vector high = (x - s1 * (c.g + k) - s2) * c.h;
+                        const Vector bandIncrement = high * c.g;
+                        const Vector band = bandIncrement + s1;
+                        s1 = band + bandIncrement;
+                        const Vector lowIncrement = band * c.g;
+                        const Vector low = lowIncrement + s2;
+                        s2 = low + lowIncrement;
+
+                        (low * c.low + band * c.band + high * c.high).copyToRawArray(frame);
+                        for (int channel = 0; channel < numChannels; ++channel) {
+                                channels[channel][i] = frame[channel];
+                        }
+                }
+
+                current = target;
+                done += length;
+        }
+
+        if (!position.isSmoothing() && position.getCurrentValue() == 0.0f) {
+                active = false;
+        }
+}
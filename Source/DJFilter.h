@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    DJFilter.h
+    Created: 20/10/2026 01:07:52
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+
+//==============================================================================
+/*
+ * One-knob DJ filter: left of centre a low-pass closing from 20 kHz down to
+ * 40 Hz, right of centre a high-pass opening from 20 Hz up to 10 kHz, and
+ * the dry signal in the middle.
+ *
+ * It is a single state-variable filter (topology-preserving, as in
+ * Zavalishin's "The Art of VA Filter Design") whose low, band and high
+ * outputs are mixed. Since low + k * band + high is exactly the input, the
+ * centre is truly dry, and near it the filtered part is faded in rather than
+ * switched. The knob is smoothed, coefficients are designed every 32 samples
+ * and ramped sample by sample in between, so sweeping it every block does not
+ * zipper. Channels sit in the lanes of one SIMD register and are filtered
+ * together.
+ */
+class DJFilter {
+       public:
+        static constexpr int maxChannels = 2;
+
+        DJFilter();
+
+        void prepare(double sampleRate);
+        void reset();
+
+        // any thread, -1 fully low-pass, 0 off, 1 fully high-pass
+        void setPosition(float position);
+
+        // audio thread
+        void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+        // cutoff in Hz of the filter the knob selects, 0 in the dry centre
+        static double getCutoffForPosition(double position);
+        // for the knob's text box
+        static juce::String getDescription(double position);
+
+       private:
+        using Vector = juce::dsp::SIMDRegister<float>;
+
+        struct Coefficients {
+                float g, h;
+                // output mix of the low, band and high outputs
+                float low, band, high;
+        };
+
+        Coefficients design(float position) const;
+
+        static constexpr int rampLength = 32;
+        // knob positions this close to the centre are the centre
+        static constexpr float centreDetent = 0.01f;
+        // the filtered part fades in over this much of the knob either side of centre
+        static constexpr float fadeWidth = 0.1f;
+        static constexpr float resonance = 0.9f;
+        static constexpr float k = 1.0f / resonance;
+
+        double sampleRate = 44100.0;
+        std::atomic<float> targetPosition{0.0f};
+
+        // audio thread
+        juce::SmoothedValue<float> position;
+        Coefficients current;
+        bool active = false;
+        Vector s1, s2;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DJFilter)
+};
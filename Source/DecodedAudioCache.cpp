@@ -0,0 +1,308 @@
+/*
+  ==============================================================================
+
+    DecodedAudioCache.cpp
+    Created: 19/10/2026 09:12:04
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "DecodedAudioCache.h"
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "Log.h"
+#include "Tracer.h"
+
+//==============================================================================
+/*
+ * Decodes one file into its DecodedTrack block by block, publishing progress
+ * after every block so a deck can start playing the beginning straight away.
+ */
+class DecodedAudioCache::DecodeJob : public juce::ThreadPoolJob {
+       public:
+        DecodeJob(DecodedAudioCache& _owner, std::shared_ptr<DecodedTrack> _track, juce::File _file,
+                  juce::AudioFormatManager& _formatManager)
+            : juce::ThreadPoolJob("Decode " + _file.getFileName()),
+              owner(_owner),
+              track(std::move(_track)),
+              file(std::move(_file)),
+              formatManager(_formatManager) {}
+
+        JobStatus runJob() override {
+                OTODECK_TRACE_SCOPE("Decode track");
+                std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+                if (reader == nullptr || reader->lengthInSamples <= 0 ||
+                    reader->lengthInSamples > std::numeric_limits<int>::max()) {
+                        OTODECK_LOG(warning, "DecodedAudioCache", "Could not decode " << file.getFullPathName());
+                        fail();
+                        return jobHasFinished;
+                }
+
+                const int length = (int) reader->lengthInSamples;
+                track->sampleRate = reader->sampleRate;
+                track->samples.setSize((int) reader->numChannels, length);
+                track->lengthInSamples.store(length, std::memory_order_release);
+                owner.trackAllocated(track);
+
+                for (int start = 0; start < length; start += blockSize) {
+                        if (shouldExit() || !owner.isStillWanted(track)) {
+                                OTODECK_LOG(debug, "DecodedAudioCache", "Cancelled " << file.getFullPathName());
+                                fail();
+                                return jobHasFinished;
+                        }
+
+                        const int numSamples = juce::jmin(blockSize, length - start);
+                        reader->read(&track->samples, start, numSamples, start, true, true);
+                        track->samplesReady.store(start + numSamples, std::memory_order_release);
+                }
+
+                track->complete.store(true, std::memory_order_release);
+                OTODECK_LOG(debug, "DecodedAudioCache", "Decoded " << file.getFullPathName());
+                return jobHasFinished;
+        }
+
+       private:
+        void fail() {
+                track->failed.store(true, std::memory_order_release);
+                owner.removeEntry(track);
+        }
+
+        // ~0.75 s at 44.1 kHz, small enough for the first block to be ready almost instantly
+        static constexpr int blockSize = 32768;
+
+        DecodedAudioCache& owner;
+        std::shared_ptr<DecodedTrack> track;
+        juce::File file;
+        juce::AudioFormatManager& formatManager;
+};
+
+//==============================================================================
+DecodedAudioCache::DecodedAudioCache(size_t memoryLimitBytes) : memoryLimit(memoryLimitBytes) {}
+
+DecodedAudioCache::~DecodedAudioCache() { decodePool.removeAllJobs(true, 5000); }
+
+juce::String DecodedAudioCache::makeKey(const juce::File& file) {
+        return file.getFullPathName() + "|" + juce::String(file.getSize()) + "|" +
+               juce::String(file.getLastModificationTime().toMilliseconds());
+}
+
+std::shared_ptr<const DecodedTrack> DecodedAudioCache::getOrLoad(const juce::File& file,
+                                                                 juce::AudioFormatManager& formatManager) {
+        const juce::String key = makeKey(file);
+        const juce::ScopedLock sl(lock);
+
+        auto [it, inserted] = entries.try_emplace(key);
+        it->second.lastUsed = ++useCounter;
+
+        if (!inserted) {
+                if (!it->second.track->hasFailed()) {
+                        OTODECK_LOG(debug, "DecodedAudioCache", "Hit " << key);
+                        return it->second.track;
+                }
+
+                // a cancelled decode that has not been removed yet, start over
+                bytesInUse -= it->second.track->getSizeInBytes();
+        }
+
+        it->second.track = std::make_shared<DecodedTrack>();
+        it->second.track->key = key;
+        decodePool.addJob(new DecodeJob(*this, it->second.track, file, formatManager), true);
+
+        return it->second.track;
+}
+
+double DecodedAudioCache::probeLengthInSeconds(const juce::File& file, juce::AudioFormatManager& formatManager) {
+        {
+                const juce::ScopedLock sl(lock);
+                auto it = entries.find(makeKey(file));
+
+                if (it != entries.end() && it->second.track->isReady()) {
+                        return it->second.track->getLengthInSeconds();
+                }
+        }
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+        if (reader == nullptr || reader->sampleRate <= 0) {
+                return 0.0;
+        }
+
+        return reader->lengthInSamples / reader->sampleRate;
+}
+
+void DecodedAudioCache::setMemoryLimit(size_t memoryLimitBytes) {
+        const juce::ScopedLock sl(lock);
+        memoryLimit = memoryLimitBytes;
+        evictToFit();
+}
+
+size_t DecodedAudioCache::getMemoryLimit() const {
+        const juce::ScopedLock sl(lock);
+        return memoryLimit;
+}
+
+size_t DecodedAudioCache::getBytesInUse() const {
+        const juce::ScopedLock sl(lock);
+        return bytesInUse;
+}
+
+void DecodedAudioCache::trackAllocated(const std::shared_ptr<DecodedTrack>& track) {
+        const juce::ScopedLock sl(lock);
+        bytesInUse += track->getSizeInBytes();
+        evictToFit();
+}
+
+bool DecodedAudioCache::isStillWanted(const std::shared_ptr<DecodedTrack>& track) {
+        // the cache entry and the decode job hold one reference each; new references are
+        // only handed out under this lock, so anything above two is a deck or display using it
+        const juce::ScopedLock sl(lock);
+        return track.use_count() > 2;
+}
+
+void DecodedAudioCache::removeEntry(const std::shared_ptr<DecodedTrack>& track) {
+        const juce::ScopedLock sl(lock);
+        auto it = entries.find(track->key);
+
+        if (it != entries.end() && it->second.track == track) {
+                bytesInUse -= track->getSizeInBytes();
+                entries.erase(it);
+        }
+}
+
+void DecodedAudioCache::holdAsStandby(const std::shared_ptr<const DecodedTrack>& track, std::function<bool()> letGo) {
+        const juce::ScopedLock sl(lock);
+        auto it = entries.find(track->key);
+
+        if (it != entries.end() && it->second.track == track) {
+                it->second.letGo = std::move(letGo);
+        }
+}
+
+void DecodedAudioCache::holdAsLive(const std::shared_ptr<const DecodedTrack>& track) {
+        const juce::ScopedLock sl(lock);
+        auto it = entries.find(track->key);
+
+        if (it != entries.end() && it->second.track == track) {
+                it->second.letGo = nullptr;
+        }
+}
+
+MemoryGovernor::Category DecodedAudioCache::getMemoryCategory() const {
+        return MemoryGovernor::Category::decodedAudio;
+}
+
+size_t DecodedAudioCache::getMemoryInUse() const { return getBytesInUse(); }
+
+size_t DecodedAudioCache::releaseMemory(size_t bytesToFree, MemoryGovernor::Priority maxPriority) {
+        size_t freed = 0;
+        {
+                const juce::ScopedLock sl(lock);
+
+                while (freed < bytesToFree) {
+                        const size_t evicted = evictLeastRecentlyUsed();
+
+                        if (evicted == 0) {
+                                break;
+                        }
+                        freed += evicted;
+                }
+        }
+
+        // standby tracks only once nothing unreferenced is left
+        if (freed < bytesToFree && maxPriority >= MemoryGovernor::Priority::standby) {
+                freed += releaseStandbyTracks(bytesToFree - freed);
+        }
+        return freed;
+}
+
+void DecodedAudioCache::evictToFit() {
+        while (bytesInUse > memoryLimit) {
+                if (evictLeastRecentlyUsed() == 0) {
+                        // everything left is in use, allow the overshoot until a deck lets go
+                        return;
+                }
+        }
+}
+
+size_t DecodedAudioCache::evictLeastRecentlyUsed() {
+        auto victim = entries.end();
+
+        // the cache itself holds one reference, anything above that is a deck or a running decode
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (it->second.track.use_count() > 1) {
+                        continue;
+                }
+
+                if (victim == entries.end() || it->second.lastUsed < victim->second.lastUsed) {
+                        victim = it;
+                }
+        }
+
+        if (victim == entries.end()) {
+                return 0;
+        }
+
+        OTODECK_LOG(debug, "DecodedAudioCache", "Evicting " << victim->first);
+        const size_t size = victim->second.track->getSizeInBytes();
+        bytesInUse -= size;
+        entries.erase(victim);
+
+        // an evicted empty entry still counts as progress
+        return juce::jmax<size_t>(size, 1);
+}
+
+size_t DecodedAudioCache::releaseStandbyTracks(size_t bytesToFree) {
+        struct Candidate {
+                std::shared_ptr<DecodedTrack> track;
+                std::function<bool()> letGo;
+                juce::uint64 lastUsed;
+        };
+        std::vector<Candidate> candidates;
+
+        {
+                const juce::ScopedLock sl(lock);
+
+                for (auto& [key, entry] : entries) {
+                        if (entry.letGo != nullptr && entry.track.use_count() > 1) {
+                                candidates.push_back({entry.track, entry.letGo, entry.lastUsed});
+                        }
+                }
+        }
+
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.lastUsed < b.lastUsed; });
+
+        size_t freed = 0;
+
+        for (auto& candidate : candidates) {
+                if (freed >= bytesToFree) {
+                        break;
+                }
+
+                // outside the lock, letting go stops and unloads a deck
+                if (!candidate.letGo()) {
+                        continue;
+                }
+
+                const juce::ScopedLock sl(lock);
+                auto it = entries.find(candidate.track->key);
+
+                // the entry and this list are the only holders left; otherwise an analysis or decode still
+                // has it, and it is evicted as an unreferenced track once that lets go
+                if (it != entries.end() && it->second.track == candidate.track && candidate.track.use_count() == 2) {
+                        OTODECK_LOG(debug, "DecodedAudioCache", "Released standby " << it->first);
+                        const size_t size = candidate.track->getSizeInBytes();
+                        bytesInUse -= size;
+                        entries.erase(it);
+                        freed += juce::jmax<size_t>(size, 1);
+                }
+        }
+        return freed;
+}
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    DecodedAudioCache.h
+    Created: 19/10/2026 09:12:04
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+
+#include "MemoryGovernor.h"
+
+//==============================================================================
+/*
+ * Decoded PCM for one track. Instances are only ever handed out as
+ * std::shared_ptr<const DecodedTrack>, so both decks (and anything else that
+ * needs the samples) share the same memory without copying.
+ *
+ * The buffer is filled progressively by a background decode: lengthInSamples
+ * is published once the buffer has been allocated, samplesReady grows as
+ * blocks are decoded, and samples below samplesReady never change again.
+ */
+struct DecodedTrack {
+        juce::String key;
+        juce::AudioBuffer<float> samples;
+        double sampleRate = 0.0;
+
+        std::atomic<juce::int64> lengthInSamples{0};
+        std::atomic<juce::int64> samplesReady{0};
+        std::atomic<bool> complete{false};
+        std::atomic<bool> failed{false};
+
+        // true once the format is known and the buffer can be read (up to samplesReady)
+        bool isReady() const { return getLengthInSamples() > 0; }
+        bool isComplete() const { return complete.load(std::memory_order_acquire); }
+        bool hasFailed() const { return failed.load(std::memory_order_acquire); }
+
+        juce::int64 getLengthInSamples() const { return lengthInSamples.load(std::memory_order_acquire); }
+        juce::int64 getSamplesReady() const { return samplesReady.load(std::memory_order_acquire); }
+        double getLengthInSeconds() const {
+                const juce::int64 length = getLengthInSamples();
+                return length > 0 ? length / sampleRate : 0.0;
+        }
+        size_t getSizeInBytes() const {
+                return isReady() ? (size_t) samples.getNumChannels() * (size_t) samples.getNumSamples() * sizeof(float)
+                                 : 0;
+        }
+};
+
+//==============================================================================
+/*
+ * DecodedAudioCache keeps decoded tracks in memory, keyed by track identity
+ * (path, size and modification time), so loading the same file again is free.
+ * Entries nobody else references are dropped least-recently-used first once
+ * the memory limit is exceeded. Under memory pressure a track only held by
+ * the Auto DJ standby deck goes next, by asking its holder to let go; a track
+ * a deck is playing is never released.
+ *
+ * Decoding runs on the cache's own thread pool. A decode that nobody outside
+ * the cache holds on to any more (e.g. the deck loaded something else) is
+ * cancelled and its entry dropped.
+ */
+class DecodedAudioCache : public MemoryGovernor::Client {
+       public:
+        explicit DecodedAudioCache(size_t memoryLimitBytes);
+        ~DecodedAudioCache() override;
+
+        // returns immediately with the cached track, or with a new one that is decoded in the background
+        std::shared_ptr<const DecodedTrack> getOrLoad(const juce::File& file, juce::AudioFormatManager& formatManager);
+
+        // length of a file without decoding it, answered from the cache when possible
+        double probeLengthInSeconds(const juce::File& file, juce::AudioFormatManager& formatManager);
+
+        void setMemoryLimit(size_t memoryLimitBytes);
+        size_t getMemoryLimit() const;
+        size_t getBytesInUse() const;
+
+        static juce::String makeKey(const juce::File& file);
+
+        // the track is only pre-loaded, letGo asks its holder to drop it and returns false if it would not
+        void holdAsStandby(const std::shared_ptr<const DecodedTrack>& track, std::function<bool()> letGo);
+        // the track is playing, or about to, and is never released again
+        void holdAsLive(const std::shared_ptr<const DecodedTrack>& track);
+
+        // MemoryGovernor::Client, unreferenced tracks are evictable, standby ones only at Priority::standby
+        MemoryGovernor::Category getMemoryCategory() const override;
+        size_t getMemoryInUse() const override;
+        size_t releaseMemory(size_t bytesToFree, MemoryGovernor::Priority maxPriority) override;
+
+       private:
+        class DecodeJob;
+
+        struct Entry {
+                std::shared_ptr<DecodedTrack> track;
+                juce::uint64 lastUsed = 0;
+                // set while the only outside holder is a standby deck
+                std::function<bool()> letGo;
+        };
+
+        // called by DecodeJob
+        void trackAllocated(const std::shared_ptr<DecodedTrack>& track);
+        bool isStillWanted(const std::shared_ptr<DecodedTrack>& track);
+        void removeEntry(const std::shared_ptr<DecodedTrack>& track);
+
+        // must be called with the lock held
+        void evictToFit();
+        size_t evictLeastRecentlyUsed();
+        size_t releaseStandbyTracks(size_t bytesToFree);
+
+        juce::CriticalSection lock;
+        std::map<juce::String, Entry> entries;
+        juce::uint64 useCounter = 0;
+        size_t memoryLimit;
+        size_t bytesInUse = 0;
+
+        juce::ThreadPool decodePool{2};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DecodedAudioCache)
+};
@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    DecodedAudioSource.cpp
+    Created: 19/10/2026 09:40:51
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "DecodedAudioSource.h"
+
+#include <JuceHeader.h>
+
+//==============================================================================
+DecodedAudioSource::DecodedAudioSource(std::shared_ptr<const DecodedTrack> _track, std::atomic<double>* _seekRequest)
+    : track(std::move(_track)), seekRequest(_seekRequest) {}
+
+DecodedAudioSource::~DecodedAudioSource() {}
+
+void DecodedAudioSource::prepareToPlay(int, double) {}
+
+void DecodedAudioSource::releaseResources() {}
+
+void DecodedAudioSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) {
+        const juce::int64 total = getTotalLength();
+        const juce::int64 ready = track->getSamplesReady();
+        const bool canWrap = looping.load() && track->isComplete();
+
+        juce::int64 pos = readPosition.load();
+        if (seekRequest != nullptr) {
+                const double seconds = seekRequest->exchange(-1.0);
+                if (seconds >= 0.0) {
+                        pos = (juce::int64) (seconds * track->sampleRate);
+                }
+        }
+        applyLoopRequest(pos);
+        int done = 0;
+
+        while (done < bufferToFill.numSamples) {
+                if (canWrap && total > 0 && pos >= total) {
+                        pos %= total;
+                }
+
+                if (loopActive && pos == loopEnd) {
+                        fadeSource = loopEnd;
+                        fadeLength = (int) juce::jmin<juce::int64>(loopCrossfadeSamples, (loopEnd - loopStart) / 2);
+                        fadeRemaining = fadeLength;
+                        pos = loopStart;
+                }
+
+                // a loop ahead of the read position ends the segment at its end, one behind it is left alone
+                juce::int64 end = juce::jmin(total, ready);
+                if (loopActive && pos < loopEnd) {
+                        end = juce::jmin(end, loopEnd);
+                }
+
+                const int remaining = bufferToFill.numSamples - done;
+                const int numToCopy = (int) juce::jlimit<juce::int64>(0, remaining, end - pos);
+
+                if (numToCopy <= 0) {
+                        bufferToFill.buffer->clear(bufferToFill.startSample + done, remaining);
+
+                        // past the end keeps counting so the transport notices, but while the decoder
+                        // is still behind the playhead we hold position and wait for it
+                        if (pos >= total) {
+                                pos += remaining;
+                        }
+                        break;
+                }
+
+                const juce::AudioBuffer<float>& samples = track->samples;
+                const int sourceChannels = samples.getNumChannels();
+
+                for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel) {
+                        // mono tracks are duplicated onto every output channel
+                        bufferToFill.buffer->copyFrom(channel, bufferToFill.startSample + done, samples,
+                                                      channel % sourceChannels, (int) pos, numToCopy);
+                }
+
+                if (fadeRemaining > 0) {
+                        crossfadeAfterWrap(bufferToFill, done, numToCopy, ready);
+                }
+
+                done += numToCopy;
+                pos += numToCopy;
+        }
+
+        readPosition.store(pos);
+}
+
+void DecodedAudioSource::setNextReadPosition(juce::int64 newPosition) { readPosition.store(juce::jmax<juce::int64>(0, newPosition)); }
+
+juce::int64 DecodedAudioSource::getNextReadPosition() const {
+        const juce::int64 total = getTotalLength();
+        const juce::int64 pos = readPosition.load();
+        return (looping.load() && total > 0) ? pos % total : pos;
+}
+
+juce::int64 DecodedAudioSource::getTotalLength() const { return track->getLengthInSamples(); }
+
+bool DecodedAudioSource::isLooping() const { return looping.load(); }
+
+void DecodedAudioSource::setLooping(bool shouldLoop) { looping.store(shouldLoop); }
+
+const std::shared_ptr<const DecodedTrack>& DecodedAudioSource::getTrack() const { return track; }
+
+//==============================================================================
+void DecodedAudioSource::setLoop(juce::int64 start, juce::int64 end) { requestLoop(start, end, 0); }
+
+void DecodedAudioSource::setLoopFromHere(juce::int64 loopLength) { requestLoop(loopHere, 0, loopLength); }
+
+void DecodedAudioSource::exitLoop() { requestLoop(0, 0, 0); }
+
+bool DecodedAudioSource::isInLoop() const { return publishedLoopActive.load(); }
+
+juce::Range<juce::int64> DecodedAudioSource::getLoop() const {
+        return {publishedLoopStart.load(), publishedLoopEnd.load()};
+}
+
+double DecodedAudioSource::getLoopLatencyMs() const { return loopLatencyMs.load(); }
+
+void DecodedAudioSource::requestLoop(juce::int64 start, juce::int64 end, juce::int64 loopLength) {
+        const juce::uint32 sequence = loopRequestSequence.load(std::memory_order_relaxed);
+        loopRequestSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        requestedLoopStart.store(start, std::memory_order_relaxed);
+        requestedLoopEnd.store(end, std::memory_order_relaxed);
+        requestedLoopLength.store(loopLength, std::memory_order_relaxed);
+        loopRequestTicks.store(juce::Time::getHighResolutionTicks(), std::memory_order_relaxed);
+
+        loopRequestSequence.store(sequence + 2, std::memory_order_release);
+}
+
+void DecodedAudioSource::applyLoopRequest(juce::int64& pos) {
+        const juce::uint32 sequence = loopRequestSequence.load(std::memory_order_acquire);
+
+        // nothing new, or the message thread is writing right now; then it is picked up next block
+        if (sequence == appliedLoopRequest || (sequence & 1) != 0) {
+                return;
+        }
+
+        juce::int64 start = requestedLoopStart.load(std::memory_order_relaxed);
+        juce::int64 end = requestedLoopEnd.load(std::memory_order_relaxed);
+        const juce::int64 loopLength = requestedLoopLength.load(std::memory_order_relaxed);
+        const juce::int64 requestTicks = loopRequestTicks.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (loopRequestSequence.load(std::memory_order_relaxed) != sequence) {
+                return;
+        }
+        appliedLoopRequest = sequence;
+
+        start = start == loopHere ? pos : start;
+        end = loopLength > 0 ? start + loopLength : (end == loopHere ? pos : end);
+        end = juce::jmin(end, getTotalLength());
+
+        loopActive = end > start;
+        if (loopActive) {
+                loopStart = start;
+                loopEnd = end;
+
+                // a loop that ends behind the read position wraps right away
+                if (pos > loopEnd && pos - loopEnd < loopEnd - loopStart) {
+                        pos = loopEnd;
+                }
+        }
+
+        publishedLoopStart.store(loopActive ? loopStart : 0);
+        publishedLoopEnd.store(loopActive ? loopEnd : 0);
+        publishedLoopActive.store(loopActive);
+        loopLatencyMs.store(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - requestTicks) *
+                            1000.0);
+}
+
+void DecodedAudioSource::crossfadeAfterWrap(const juce::AudioSourceChannelInfo& bufferToFill, int offset,
+                                            int numSamples, juce::int64 ready) {
+        const int numToFade = juce::jmin(numSamples, fadeRemaining);
+        const int faded = fadeLength - fadeRemaining;
+        const juce::int64 tailStart = fadeSource + faded;
+        // what followed the loop end may not be decoded yet, then it fades out from silence
+        const int tailAvailable = (int) juce::jlimit<juce::int64>(0, numToFade, ready - tailStart);
+
+        const juce::AudioBuffer<float>& samples = track->samples;
+        const int sourceChannels = samples.getNumChannels();
+
+        for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel) {
+                float* data = bufferToFill.buffer->getWritePointer(channel, bufferToFill.startSample + offset);
+                const float* tail = tailAvailable > 0 ? samples.getReadPointer(channel % sourceChannels, (int) tailStart)
+                                                      : nullptr;
+
+                for (int i = 0; i < numToFade; ++i) {
+                        const float fadeIn = (float) (faded + i + 1) / (float) (fadeLength + 1);
+                        data[i] = data[i] * fadeIn + (i < tailAvailable ? tail[i] * (1.0f - fadeIn) : 0.0f);
+                }
+        }
+
+        fadeRemaining -= numToFade;
+}
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    DecodedAudioSource.h
+    Created: 19/10/2026 09:40:51
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <memory>
+
+#include "DecodedAudioCache.h"
+
+//==============================================================================
+/*
+ * DecodedAudioSource plays a shared DecodedTrack. Each deck owns its own source
+ * (and so its own read position) while the samples themselves are shared.
+ * While the track is still being decoded, playback only runs up to the
+ * decoded part and otherwise waits for the decoder to catch up.
+ *
+ * Loops play straight from the decoded samples, so looping never seeks or
+ * reads a file. The read position jumps from the loop end back to the loop
+ * start exactly at the sample, and the audio that would have followed the
+ * loop end is faded out over the first loopCrossfadeSamples after the jump.
+ *
+ * A seek requested on the audio thread itself, e.g. a MIDI cue, is taken up
+ * at the start of the next pull, so it never goes through the transport's
+ * locks.
+ */
+class DecodedAudioSource : public juce::PositionableAudioSource {
+       public:
+        // seekRequest, in seconds and negative when there is none, is owned by the caller and outlives the source
+        explicit DecodedAudioSource(std::shared_ptr<const DecodedTrack> track,
+                                    std::atomic<double>* seekRequest = nullptr);
+        ~DecodedAudioSource() override;
+
+        void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+        void releaseResources() override;
+        void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+        void setNextReadPosition(juce::int64 newPosition) override;
+        juce::int64 getNextReadPosition() const override;
+        juce::int64 getTotalLength() const override;
+        bool isLooping() const override;
+        void setLooping(bool shouldLoop) override;
+
+        const std::shared_ptr<const DecodedTrack>& getTrack() const;
+
+        // Loop requests, in samples of the track. They are taken up by the audio thread at the start of its
+        // next block, where loopHere stands for the read position at that moment: an "out" point set with it
+        // lands exactly where the audio is, whatever the callback timing.
+        static constexpr juce::int64 loopHere = -1;
+        void setLoop(juce::int64 loopStart, juce::int64 loopEnd);
+        void setLoopFromHere(juce::int64 loopLength);
+        void exitLoop();
+
+        bool isInLoop() const;
+        juce::Range<juce::int64> getLoop() const;
+        // from the last loop request to the audio thread applying it
+        double getLoopLatencyMs() const;
+
+       private:
+        void requestLoop(juce::int64 loopStart, juce::int64 loopEnd, juce::int64 loopLength);
+        void applyLoopRequest(juce::int64& pos);
+        void crossfadeAfterWrap(const juce::AudioSourceChannelInfo& bufferToFill, int offset, int numSamples,
+                                juce::int64 ready);
+
+        static constexpr int loopCrossfadeSamples = 256;
+
+        std::shared_ptr<const DecodedTrack> track;
+        std::atomic<double>* seekRequest;
+        std::atomic<juce::int64> readPosition{0};
+        std::atomic<bool> looping{false};
+
+        // loop request, message thread -> audio thread, written and read like PlaybackClock
+        std::atomic<juce::uint32> loopRequestSequence{0};
+        std::atomic<juce::int64> requestedLoopStart{0}, requestedLoopEnd{0}, requestedLoopLength{0};
+        std::atomic<juce::int64> loopRequestTicks{0};
+
+        // audio thread
+        juce::uint32 appliedLoopRequest = 0;
+        bool loopActive = false;
+        juce::int64 loopStart = 0, loopEnd = 0;
+        juce::int64 fadeSource = 0;
+        int fadeLength = 0, fadeRemaining = 0;
+
+        // published by the audio thread
+        std::atomic<bool> publishedLoopActive{false};
+        std::atomic<juce::int64> publishedLoopStart{0}, publishedLoopEnd{0};
+        std::atomic<double> loopLatencyMs{0.0};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DecodedAudioSource)
+};
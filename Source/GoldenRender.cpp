@@ -0,0 +1,342 @@
+/*
+  ==============================================================================
+
+    GoldenRender.cpp
+    Created: 19/10/2026 19:52:18
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "GoldenRender.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+#include "AudioPlayer.h"
+#include "DecodedAudioCache.h"
+#include "TestSupport.h"
+#include "TrackAnalyser.h"
+
+namespace {
+const double sampleRate = 44100.0;
+const int blockSize = 512;
+const double fixtureSeconds = 8.0;
+const double renderSeconds = 6.0;
+// next to the references, one "<case> <checksum>" line each
+const char* const manifestFileName = "manifest.txt";
+
+struct Case {
+        const char* name;
+        float bass, mid, treble;
+        double speed;
+        bool keyLock;
+        float reverbWet;
+        // mixed with a second, differently set deck through a MixerAudioSource
+        bool secondDeck;
+
+        // tolerances, plain float paths only differ by rounding; WSOLA may pick a neighbouring offset
+        float maxError;
+        double minSnrDb;
+};
+
+const Case cases[] = {
+    {"dry", 1.0f, 1.0f, 1.0f, 1.0, false, 0.0f, false, 1.0e-4f, 80.0},
+    {"eq", 2.0f, 0.5f, 1.5f, 1.0, false, 0.0f, false, 1.0e-4f, 80.0},
+    {"speed-slow", 1.0f, 1.0f, 1.0f, 0.8, false, 0.0f, false, 1.0e-4f, 80.0},
+    {"speed-fast", 1.0f, 1.0f, 1.0f, 1.25, false, 0.0f, false, 1.0e-4f, 80.0},
+    {"key-lock", 1.0f, 1.0f, 1.0f, 1.1, true, 0.0f, false, 0.05f, 40.0},
+    {"reverb", 1.0f, 1.0f, 1.0f, 1.0, false, 0.4f, false, 1.0e-4f, 80.0},
+    {"mixer", 1.0f, 1.0f, 1.0f, 1.0, false, 0.0f, true, 1.0e-4f, 80.0},
+    {"everything", 1.5f, 0.7f, 1.3f, 1.05, false, 0.3f, true, 1.0e-4f, 80.0},
+};
+
+// kick on every beat at 120 BPM, a log sweep across the spectrum and noise hats between the beats
+std::shared_ptr<const DecodedTrack> makeFixture() {
+        const TestSupport::Pulse kick{120.0, 60.0, 0.15, 0.6};
+        TestSupport::Hats hats{120.0, 2, 0.03, 0.15, 0x60d};
+        const double twoPi = juce::MathConstants<double>::twoPi;
+
+        auto frame = [&](double t, double& left, double& right) {
+                const double sweepPhase = twoPi * 40.0 * fixtureSeconds / std::log(400.0) *
+                                          (std::pow(400.0, t / fixtureSeconds) - 1.0);
+                const double beat = kick.getSample(t);
+                const double hat = hats.getNextSample(t);
+
+                left = beat + 0.2 * std::sin(sweepPhase) + hat;
+                right = beat + 0.2 * std::cos(sweepPhase) - hat;
+        };
+        return TestSupport::makeDecodedTrack("golden-render-fixture",
+                                             TestSupport::synthesise(2, fixtureSeconds, sampleRate, frame), sampleRate);
+}
+
+void configure(AudioPlayer& player, const std::shared_ptr<const DecodedTrack>& fixture, float bass, float mid,
+               float treble, double speed, bool keyLock, float reverbWet, double startSeconds) {
+        // the reverb level is set before prepareToPlay so it does not ramp in
+        player.setNonRealtime(true);
+        player.setReverbWet(reverbWet);
+        player.setKeyLockEnabled(keyLock);
+        player.prepareToPlay(blockSize, sampleRate);
+
+        player.loadTrack(fixture);
+        player.setBassGain(bass);
+        player.setMidGain(mid);
+        player.setTrebleGain(treble);
+        player.setSpeed(speed);
+        player.setPosition(startSeconds);
+        player.start();
+}
+
+juce::AudioBuffer<float> render(const Case& renderCase, const std::shared_ptr<const DecodedTrack>& fixture) {
+        juce::AudioFormatManager formatManager;
+        DecodedAudioCache decodedAudioCache{16 * 1024 * 1024};
+        TrackAnalyser trackAnalyser;
+        AudioPlayer deckA{formatManager, decodedAudioCache, trackAnalyser};
+        AudioPlayer deckB{formatManager, decodedAudioCache, trackAnalyser};
+
+        configure(deckA, fixture, renderCase.bass, renderCase.mid, renderCase.treble, renderCase.speed,
+                  renderCase.keyLock, renderCase.reverbWet, 0.0);
+
+        juce::MixerAudioSource mixer;
+        mixer.addInputSource(&deckA, false);
+
+        if (renderCase.secondDeck) {
+                configure(deckB, fixture, 1.0f, 1.2f, 0.5f, 0.9, false, 0.0f, 1.0);
+                mixer.addInputSource(&deckB, false);
+        }
+
+        // the decks filter the whole buffer they are given, so every block is rendered on its own
+        const int length = (int) (renderSeconds * sampleRate);
+        juce::AudioBuffer<float> output(2, length);
+        juce::AudioBuffer<float> block(2, blockSize);
+
+        for (int position = 0; position < length; position += blockSize) {
+                const int numSamples = juce::jmin(blockSize, length - position);
+                block.setSize(2, numSamples, false, false, true);
+                mixer.getNextAudioBlock(juce::AudioSourceChannelInfo(&block, 0, numSamples));
+
+                for (int channel = 0; channel < 2; ++channel) {
+                        output.copyFrom(channel, position, block, channel, 0, numSamples);
+                }
+        }
+
+        mixer.removeAllInputs();
+        deckA.releaseResources();
+        deckB.releaseResources();
+        return output;
+}
+
+juce::File getReferenceFile(const juce::File& directory, const Case& renderCase) {
+        return directory.getChildFile(juce::String(renderCase.name) + ".wav");
+}
+
+bool writeWav(const juce::File& file, const juce::AudioBuffer<float>& buffer) {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream = file.createOutputStream();
+
+        if (stream == nullptr) {
+                return false;
+        }
+
+        // 32 bits is written as float, so the reference keeps full precision
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(
+            wav.createWriterFor(stream.get(), sampleRate, (unsigned int) buffer.getNumChannels(), 32, {}, 0));
+
+        if (writer == nullptr) {
+                return false;
+        }
+        stream.release();
+        return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+}
+
+// 64-bit FNV-1a of the file, enough to tell a committed reference from one rendered since
+juce::String getChecksum(const juce::File& file) {
+        juce::MemoryBlock data;
+        if (!file.loadFileAsData(data)) {
+                return {};
+        }
+
+        juce::uint64 hash = 0xcbf29ce484222325ull;
+        const auto* bytes = static_cast<const juce::uint8*>(data.getData());
+
+        for (size_t i = 0; i < data.getSize(); ++i) {
+                hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return juce::String::toHexString((juce::int64) hash).paddedLeft('0', 16);
+}
+
+// case name to checksum, empty if there is no manifest
+juce::StringPairArray readManifest(const juce::File& directory) {
+        juce::StringPairArray manifest;
+        juce::StringArray lines;
+        lines.addLines(directory.getChildFile(manifestFileName).loadFileAsString());
+
+        for (const juce::String& line : lines) {
+                const juce::String trimmed = line.trim();
+                if (trimmed.isNotEmpty() && !trimmed.startsWithChar('#')) {
+                        manifest.set(trimmed.upToFirstOccurrenceOf(" ", false, false),
+                                     trimmed.fromFirstOccurrenceOf(" ", false, false).trim());
+                }
+        }
+        return manifest;
+}
+
+bool readWav(const juce::File& file, juce::AudioBuffer<float>& buffer) {
+        std::unique_ptr<juce::FileInputStream> stream = file.createInputStream();
+
+        if (stream == nullptr) {
+                return false;
+        }
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatReader> reader(wav.createReaderFor(stream.release(), true));
+
+        if (reader == nullptr) {
+                return false;
+        }
+        buffer.setSize((int) reader->numChannels, (int) reader->lengthInSamples);
+        return reader->read(&buffer, 0, buffer.getNumSamples(), 0, true, true);
+}
+}        // namespace
+
+//==============================================================================
+namespace GoldenRender {
+bool writeReferences(const juce::File& directory) {
+        directory.createDirectory();
+        const std::shared_ptr<const DecodedTrack> fixture = makeFixture();
+        bool allWritten = true;
+
+        for (const Case& renderCase : cases) {
+                const juce::File file = getReferenceFile(directory, renderCase);
+                const bool written = writeWav(file, render(renderCase, fixture));
+
+                std::cout << (written ? "wrote " : "FAILED to write ") << file.getFullPathName() << std::endl;
+                allWritten = allWritten && written;
+        }
+        return writeManifest(directory) && allWritten;
+}
+
+bool writeManifest(const juce::File& directory) {
+        juce::String manifest;
+        manifest << "# Golden render references, one \"<case> <checksum>\" line each; see GoldenRender.h\n";
+        bool allFound = true;
+
+        for (const Case& renderCase : cases) {
+                const juce::String checksum = getChecksum(getReferenceFile(directory, renderCase));
+                if (checksum.isEmpty()) {
+                        std::cout << "no reference for " << renderCase.name << std::endl;
+                        allFound = false;
+                        continue;
+                }
+                manifest << renderCase.name << " " << checksum << "\n";
+        }
+
+        const juce::File manifestFile = directory.getChildFile(manifestFileName);
+        const bool written = allFound && manifestFile.replaceWithText(manifest);
+        std::cout << (written ? "wrote " : "FAILED to write ") << manifestFile.getFullPathName() << std::endl;
+        return written;
+}
+
+int checkReferences(const juce::File& directory) {
+        const juce::StringPairArray manifest = readManifest(directory);
+        if (manifest.size() == 0) {
+                std::cout << "no " << manifestFileName << " in " << directory.getFullPathName()
+                          << ", generate the references as GoldenRender.h describes" << std::endl;
+                return (int) (sizeof(cases) / sizeof(cases[0]));
+        }
+
+        const std::shared_ptr<const DecodedTrack> fixture = makeFixture();
+        int failures = 0;
+
+        for (const Case& renderCase : cases) {
+                const juce::File file = getReferenceFile(directory, renderCase);
+                const juce::String expectedChecksum = manifest[renderCase.name];
+                juce::AudioBuffer<float> reference;
+
+                // only the committed baseline counts, not whatever was rendered into the directory since
+                if (expectedChecksum.isEmpty()) {
+                        std::cout << renderCase.name << ": FAIL, not in the manifest" << std::endl;
+                        ++failures;
+                        continue;
+                }
+                if (getChecksum(file) != expectedChecksum) {
+                        std::cout << renderCase.name << ": FAIL, " << file.getFileName()
+                                  << " is missing or differs from the manifest" << std::endl;
+                        ++failures;
+                        continue;
+                }
+                if (!readWav(file, reference)) {
+                        std::cout << renderCase.name << ": FAIL, " << file.getFileName() << " cannot be read" << std::endl;
+                        ++failures;
+                        continue;
+                }
+
+                const juce::AudioBuffer<float> rendered = render(renderCase, fixture);
+
+                if (reference.getNumChannels() != rendered.getNumChannels() ||
+                    reference.getNumSamples() != rendered.getNumSamples()) {
+                        std::cout << renderCase.name << ": FAIL, length or channel count changed" << std::endl;
+                        ++failures;
+                        continue;
+                }
+
+                float maxError = 0.0f;
+                double signalEnergy = 0.0, errorEnergy = 0.0;
+
+                for (int channel = 0; channel < rendered.getNumChannels(); ++channel) {
+                        const float* expected = reference.getReadPointer(channel);
+                        const float* actual = rendered.getReadPointer(channel);
+
+                        for (int i = 0; i < rendered.getNumSamples(); ++i) {
+                                const float error = actual[i] - expected[i];
+                                maxError = juce::jmax(maxError, std::abs(error));
+                                signalEnergy += (double) expected[i] * expected[i];
+                                errorEnergy += (double) error * error;
+                        }
+                }
+
+                const double snrDb = errorEnergy > 0.0 ? 10.0 * std::log10(signalEnergy / errorEnergy)
+                                                       : std::numeric_limits<double>::infinity();
+                const bool passed = maxError <= renderCase.maxError && snrDb >= renderCase.minSnrDb;
+
+                std::cout << renderCase.name << ": " << (passed ? "ok" : "FAIL") << ", max error " << maxError
+                          << " (limit " << renderCase.maxError << "), SNR " << snrDb << " dB (limit "
+                          << renderCase.minSnrDb << " dB)" << std::endl;
+
+                if (!passed) {
+                        ++failures;
+                }
+        }
+        return failures;
+}
+
+bool runFromCommandLine(const juce::String& commandLine, int& exitCode) {
+        juce::String path;
+        const bool write = TestSupport::findFlag(commandLine, "--golden-render", path);
+        const bool manifest = !write && TestSupport::findFlag(commandLine, "--golden-manifest", path);
+
+        if (!write && !manifest && !TestSupport::findFlag(commandLine, "--golden-check", path)) {
+                return false;
+        }
+
+        const juce::File directory = juce::File::getCurrentWorkingDirectory().getChildFile(
+            path.isNotEmpty() ? path : juce::String("GoldenRenders"));
+
+        if (write) {
+                exitCode = writeReferences(directory) ? 0 : 1;
+        } else if (manifest) {
+                exitCode = writeManifest(directory) ? 0 : 1;
+        } else {
+                const int failures = checkReferences(directory);
+                std::cout << (failures == 0 ? "all golden renders match" : juce::String(failures) + " golden render(s) differ")
+                          << std::endl;
+                exitCode = failures == 0 ? 0 : 1;
+        }
+        return true;
+}
+}        // namespace GoldenRender
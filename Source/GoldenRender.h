@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    GoldenRender.h
+    Created: 19/10/2026 19:52:18
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+ * Golden renders of the deck DSP, for checking that a rewrite of a DSP path
+ * still produces the same audio.
+ *
+ * A synthetic fixture track is rendered offline through AudioPlayer in a
+ * fixed set of configurations (EQ gains, speed ratios, key lock, reverb, two
+ * decks through a mixer). "--golden-render [dir]" writes the results to
+ * <dir>/<case>.wav as 32-bit float, with a checksum of each file in
+ * <dir>/manifest.txt; "--golden-check [dir]" renders again and compares
+ * against those files, by maximum sample error and by SNR. The directory
+ * defaults to GoldenRenders in the working directory.
+ *
+ * The references are committed in GoldenRenders/ at the top of the
+ * repository. A check only passes against them: a case missing from the
+ * manifest, or a file that no longer matches its checksum, fails, so a stray
+ * local render cannot stand in for the baseline.
+ *
+ * To generate them, check out the commit that added golden renders, build it
+ * and run "--golden-render GoldenRenders" from the repository root. Back on
+ * the current tree, "--golden-manifest GoldenRenders" checksums the files
+ * that are there without rendering; commit the directory. Regenerate them only for an intended change in the sound,
+ * in a commit of its own that says so, and run "--golden-check" on every
+ * commit that touches the deck DSP.
+ */
+namespace GoldenRender {
+// writes every reference render into the directory, false if any could not be written
+bool writeReferences(const juce::File& directory);
+
+// checksums the reference files already in the directory into its manifest, false if any is missing
+bool writeManifest(const juce::File& directory);
+
+// renders every case again and compares it with its reference, returns the number of failing cases
+int checkReferences(const juce::File& directory);
+
+// handles --golden-render, --golden-manifest and --golden-check, false if the command line asks for none
+bool runFromCommandLine(const juce::String& commandLine, int& exitCode);
+}        // namespace GoldenRender
@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+    KeyLockBenchmark.cpp
+    Created: 20/10/2026 03:04:52
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "KeyLockBenchmark.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+#include "AudioPlayer.h"
+#include "DecodedAudioCache.h"
+#include "DecodedAudioSource.h"
+#include "TestSupport.h"
+#include "TimeStretchAudioSource.h"
+#include "TrackAnalyser.h"
+
+namespace {
+const double sampleRate = 44100.0;
+const int blockSize = 512;
+const double fixtureSeconds = 30.0;
+
+const TimeStretchAudioSource::Quality qualities[] = {TimeStretchAudioSource::Quality::draft,
+                                                     TimeStretchAudioSource::Quality::normal,
+                                                     TimeStretchAudioSource::Quality::high};
+// the search and the overlap-add cost the same at any tempo, both directions are measured anyway
+const double tempos[] = {0.8, 1.25};
+
+// a kick, a chord and hats, so the similarity search has something to line up
+std::shared_ptr<const DecodedTrack> makeFixture() {
+        const TestSupport::Pulse kick{120.0, 55.0, 0.1, 0.5};
+        TestSupport::Hats hats{120.0, 1, 0.02, 0.1, 0x7e0};
+        const double twoPi = juce::MathConstants<double>::twoPi;
+
+        auto frame = [&](double t, double& left, double& right) {
+                const double beat = kick.getSample(t);
+                const double chord = 0.08 * (std::sin(twoPi * 220.0 * t) + std::sin(twoPi * 277.2 * t) +
+                                             std::sin(twoPi * 329.6 * t));
+                const double hat = hats.getNextSample(t);
+
+                left = beat + chord + hat;
+                right = beat + chord - hat;
+        };
+        return TestSupport::makeDecodedTrack("keylock-benchmark-fixture",
+                                             TestSupport::synthesise(2, fixtureSeconds, sampleRate, frame), sampleRate);
+}
+
+struct Result {
+        // render time over audio time
+        double load = 0.0;
+        bool finite = true;
+};
+
+Result renderFor(juce::AudioSource& source, double seconds) {
+        juce::AudioBuffer<float> block(2, blockSize);
+        const int numBlocks = (int) (seconds * sampleRate / blockSize);
+        Result result;
+
+        if (numBlocks <= 0) {
+                return result;
+        }
+
+        const double start = juce::Time::getMillisecondCounterHiRes();
+        for (int index = 0; index < numBlocks; ++index) {
+                block.clear();
+                source.getNextAudioBlock(juce::AudioSourceChannelInfo(&block, 0, blockSize));
+
+                for (int channel = 0; channel < 2 && result.finite; ++channel) {
+                        const auto range = juce::FloatVectorOperations::findMinAndMax(block.getReadPointer(channel), blockSize);
+                        result.finite = std::isfinite(range.getStart()) && std::isfinite(range.getEnd());
+                }
+        }
+        const double elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+        result.load = elapsedSeconds / (numBlocks * blockSize / sampleRate);
+        return result;
+}
+
+// the stretch alone, on a looping source so any length can be rendered
+Result renderStretch(const std::shared_ptr<const DecodedTrack>& fixture, TimeStretchAudioSource::Quality quality,
+                     double tempo, double seconds) {
+        DecodedAudioSource input(fixture);
+        input.setLooping(true);
+
+        TimeStretchAudioSource stretch(&input, 2);
+        stretch.setEnabled(true);
+        stretch.setQuality(quality);
+        stretch.setTempo(tempo);
+        stretch.prepareToPlay(blockSize, sampleRate);
+
+        const Result result = renderFor(stretch, seconds);
+        stretch.releaseResources();
+        return result;
+}
+
+// a whole deck, EQ, filter and meter included; the track restarts whenever it runs out
+Result renderDeck(const std::shared_ptr<const DecodedTrack>& fixture, bool keyLock, TimeStretchAudioSource::Quality quality,
+                  double tempo, double seconds) {
+        juce::AudioFormatManager formatManager;
+        DecodedAudioCache decodedAudioCache{16 * 1024 * 1024};
+        TrackAnalyser trackAnalyser;
+        AudioPlayer deck{formatManager, decodedAudioCache, trackAnalyser};
+
+        deck.setNonRealtime(true);
+        deck.setKeyLockEnabled(keyLock);
+        deck.setKeyLockQuality(quality);
+        deck.prepareToPlay(blockSize, sampleRate);
+        deck.loadTrack(fixture);
+        deck.setSpeed(tempo);
+        deck.start();
+
+        // played in track-length pieces, so every block is real audio rather than the silence after the end
+        const double piece = fixtureSeconds / tempo - 1.0;
+        Result result;
+        double done = 0.0, busy = 0.0;
+
+        while (done < seconds) {
+                const double length = juce::jmin(piece, seconds - done);
+                deck.setPosition(0.0);
+                const Result part = renderFor(deck, length);
+
+                busy += part.load * length;
+                done += length;
+                result.finite = result.finite && part.finite;
+        }
+
+        deck.releaseResources();
+        result.load = busy / done;
+        return result;
+}
+
+juce::String describe(const Result& result) {
+        const double decksPerCore = result.load > 0.0 ? 1.0 / result.load : 0.0;
+        return juce::String(result.load * 100.0, 2).paddedLeft(' ', 7) + "% of a core, " +
+               juce::String(decksPerCore, 1).paddedLeft(' ', 7) + " per core" + (result.finite ? "" : ", NON-FINITE");
+}
+}        // namespace
+
+//==============================================================================
+namespace KeyLockBenchmark {
+int run(double seconds) {
+        std::cout << "Key lock benchmark: " << seconds << " s of audio per render, " << blockSize << " sample blocks at "
+                  << sampleRate << " Hz" << std::endl;
+
+        const std::shared_ptr<const DecodedTrack> fixture = makeFixture();
+        int failures = 0;
+
+        for (double tempo : tempos) {
+                const Result baseline = renderDeck(fixture, false, TimeStretchAudioSource::Quality::normal, tempo, seconds);
+                failures += baseline.finite ? 0 : 1;
+                std::cout << "tempo " << tempo << ", deck without key lock:  " << describe(baseline) << std::endl;
+
+                for (auto quality : qualities) {
+                        const Result stretch = renderStretch(fixture, quality, tempo, seconds);
+                        const Result deck = renderDeck(fixture, true, quality, tempo, seconds);
+                        failures += (stretch.finite ? 0 : 1) + (deck.finite ? 0 : 1);
+
+                        const juce::String name = TimeStretchAudioSource::getQualityName(quality).paddedRight(' ', 6);
+                        std::cout << "tempo " << tempo << ", " << name << " stretch alone: " << describe(stretch)
+                                  << std::endl;
+                        std::cout << "tempo " << tempo << ", " << name << " whole deck:    " << describe(deck)
+                                  << std::endl;
+                }
+        }
+        return failures;
+}
+
+bool runFromCommandLine(const juce::String& commandLine, int& exitCode) {
+        double seconds = 0.0;
+        if (!TestSupport::findFlag(commandLine, "--keylock-benchmark", 60.0, seconds)) {
+                return false;
+        }
+
+        exitCode = run(seconds) == 0 ? 0 : 1;
+        return true;
+}
+}        // namespace KeyLockBenchmark
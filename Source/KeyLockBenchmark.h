@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    KeyLockBenchmark.h
+    Created: 20/10/2026 03:04:52
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+ * Measures what key lock costs, to know how many key-locked decks fit on one
+ * core. "--keylock-benchmark [seconds]" (default 60) renders a synthetic
+ * track offline at each quality tier, slowed down and sped up, twice: the
+ * TimeStretchAudioSource on its own, and a whole AudioPlayer with key lock
+ * on. A deck without key lock is rendered as the baseline.
+ *
+ * Cost is the render time over the audio time, on one thread. The decks per
+ * core are its inverse, for the whole deck and for the time-stretch alone.
+ * The exit code is 1 if any render produced non-finite samples.
+ */
+namespace KeyLockBenchmark {
+// returns the number of renders with non-finite output
+int run(double seconds);
+
+// handles --keylock-benchmark, false if the command line does not ask for it
+bool runFromCommandLine(const juce::String& commandLine, int& exitCode);
+}        // namespace KeyLockBenchmark
@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    LevelMeter.cpp
+    Created: 19/10/2026 22:08:15
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "LevelMeter.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+// peak magnitude and sum of squares in one pass, SIMD over the aligned middle of the block
+void measureBlock(const float* data, int numSamples, float& peak, float& sumOfSquares) {
+        using Vector = juce::dsp::SIMDRegister<float>;
+
+        int i = 0;
+        for (; i < numSamples && !Vector::isSIMDAligned(data + i); ++i) {
+                peak = juce::jmax(peak, std::abs(data[i]));
+                sumOfSquares += data[i] * data[i];
+        }
+
+        Vector vectorPeak = Vector::expand(0.0f);
+        Vector vectorSum = Vector::expand(0.0f);
+        const Vector zero = Vector::expand(0.0f);
+
+        for (; i + (int) Vector::SIMDNumElements <= numSamples; i += (int) Vector::SIMDNumElements) {
+                const Vector x = Vector::fromRawArray(data + i);
+                vectorPeak = Vector::max(vectorPeak, Vector::max(x, zero - x));
+                vectorSum += x * x;
+        }
+
+        for (size_t lane = 0; lane < Vector::SIMDNumElements; ++lane) {
+                peak = juce::jmax(peak, vectorPeak.get(lane));
+        }
+        sumOfSquares += vectorSum.sum();
+
+        for (; i < numSamples; ++i) {
+                peak = juce::jmax(peak, std::abs(data[i]));
+                sumOfSquares += data[i] * data[i];
+        }
+}
+}        // namespace
+
+//==============================================================================
+LevelMeter::LevelMeter() {
+        for (int channel = 0; channel < maxChannels; ++channel) {
+                peak[channel].store(0.0f);
+                rms[channel].store(0.0f);
+        }
+}
+
+void LevelMeter::prepare(double _sampleRate) {
+        sampleRate = _sampleRate;
+        loudnessBlockLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+
+        Biquad shelfDesign, highPassDesign;
+        designKWeighting(sampleRate, shelfDesign, highPassDesign);
+
+        for (int channel = 0; channel < maxChannels; ++channel) {
+                shelf[channel] = shelfDesign;
+                highPass[channel] = highPassDesign;
+                meanSquare[channel] = 0.0;
+        }
+
+        std::fill(std::begin(loudnessBlocks), std::end(loudnessBlocks), 0.0);
+        loudnessBlockIndex = 0;
+        loudnessBlocksFilled = 0;
+        loudnessAccumulator = 0.0;
+        loudnessBlockSamples = 0;
+        shortTermLufs.store(silenceLufs);
+}
+
+void LevelMeter::designKWeighting(double rate, Biquad& shelfDesign, Biquad& highPassDesign) {
+        // designed for the actual rate: a high shelf of about +4 dB, then a 38 Hz high-pass
+        const double pi = juce::MathConstants<double>::pi;
+        double k = std::tan(pi * 1681.974450955533 / rate);
+        const double q = 0.7071752369554196;
+        const double vh = std::pow(10.0, 3.999843853973347 / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        double a0 = 1.0 + k / q + k * k;
+
+        shelfDesign = {};
+        shelfDesign.b0 = (vh + vb * k / q + k * k) / a0;
+        shelfDesign.b1 = 2.0 * (k * k - vh) / a0;
+        shelfDesign.b2 = (vh - vb * k / q + k * k) / a0;
+        shelfDesign.a1 = 2.0 * (k * k - 1.0) / a0;
+        shelfDesign.a2 = (1.0 - k / q + k * k) / a0;
+
+        k = std::tan(pi * 38.13547087602444 / rate);
+        const double highPassQ = 0.5003270373238773;
+        a0 = 1.0 + k / highPassQ + k * k;
+
+        highPassDesign = {};
+        highPassDesign.b0 = 1.0;
+        highPassDesign.b1 = -2.0;
+        highPassDesign.b2 = 1.0;
+        highPassDesign.a1 = 2.0 * (k * k - 1.0) / a0;
+        highPassDesign.a2 = (1.0 - k / highPassQ + k * k) / a0;
+}
+
+void LevelMeter::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+        const int numChannels = juce::jmin(maxChannels, buffer.getNumChannels());
+
+        if (numSamples <= 0 || numChannels == 0) {
+                return;
+        }
+
+        // RMS integrates over about 300 ms whatever the block size
+        const double smoothing = 1.0 - std::exp(-numSamples / (0.3 * sampleRate));
+        bool clipped = false;
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+                const float* data = buffer.getReadPointer(channel, startSample);
+                float blockPeak = 0.0f, sumOfSquares = 0.0f;
+                measureBlock(data, numSamples, blockPeak, sumOfSquares);
+
+                float previous = peak[channel].load();
+                while (blockPeak > previous && !peak[channel].compare_exchange_weak(previous, blockPeak)) {
+                }
+
+                meanSquare[channel] += (sumOfSquares / numSamples - meanSquare[channel]) * smoothing;
+                rms[channel].store((float) std::sqrt(meanSquare[channel]));
+                clipped = clipped || blockPeak >= 1.0f;
+        }
+
+        if (clipped) {
+                lastClipMs.store(juce::Time::getMillisecondCounter());
+                hasClipped.store(true);
+        }
+
+        // K-weighted energy, summed over the channels with a weight of one each, in 100 ms blocks
+        for (int i = 0; i < numSamples; ++i) {
+                for (int channel = 0; channel < numChannels; ++channel) {
+                        const double weighted =
+                            highPass[channel].process(shelf[channel].process(buffer.getSample(channel, startSample + i)));
+                        loudnessAccumulator += weighted * weighted;
+                }
+
+                if (++loudnessBlockSamples == loudnessBlockLength) {
+                        loudnessBlocks[loudnessBlockIndex] = loudnessAccumulator;
+                        loudnessBlockIndex = (loudnessBlockIndex + 1) % numLoudnessBlocks;
+                        loudnessBlocksFilled = juce::jmin(numLoudnessBlocks, loudnessBlocksFilled + 1);
+                        loudnessAccumulator = 0.0;
+                        loudnessBlockSamples = 0;
+
+                        double energy = 0.0;
+                        for (int block = 0; block < loudnessBlocksFilled; ++block) {
+                                energy += loudnessBlocks[block];
+                        }
+                        energy /= (double) loudnessBlocksFilled * loudnessBlockLength;
+
+                        shortTermLufs.store(energy > 1.0e-10 ? (float) (-0.691 + 10.0 * std::log10(energy)) : silenceLufs);
+                }
+        }
+}
+
+float LevelMeter::measureIntegratedLufs(const juce::AudioBuffer<float>& buffer, int numSamples, double rate) {
+        const int numChannels = buffer.getNumChannels();
+        const int stepLength = juce::roundToInt(rate * 0.1);
+        numSamples = juce::jmin(numSamples, buffer.getNumSamples());
+
+        if (numChannels == 0 || stepLength <= 0) {
+                return silenceLufs;
+        }
+
+        // K-weighted energy per 100 ms step; a 400 ms gating block is four steps, overlapping by three
+        std::vector<double> steps((size_t) (numSamples / stepLength), 0.0);
+        Biquad shelfDesign, highPassDesign;
+        designKWeighting(rate, shelfDesign, highPassDesign);
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+                Biquad channelShelf = shelfDesign, channelHighPass = highPassDesign;
+                const float* data = buffer.getReadPointer(channel);
+
+                for (size_t step = 0; step < steps.size(); ++step) {
+                        double energy = 0.0;
+                        for (int i = (int) step * stepLength, end = i + stepLength; i < end; ++i) {
+                                const double weighted = channelHighPass.process(channelShelf.process(data[i]));
+                                energy += weighted * weighted;
+                        }
+                        steps[step] += energy;
+                }
+        }
+
+        constexpr int stepsPerBlock = 4;
+        const double blockLength = (double) stepsPerBlock * stepLength;
+        auto toLufs = [](double meanSquare) { return -0.691 + 10.0 * std::log10(meanSquare); };
+
+        // mean square of the blocks above the gate, 0 when there are none
+        auto gatedMean = [&](double gateLufs) {
+                double sum = 0.0;
+                int count = 0;
+                for (size_t block = 0; block + stepsPerBlock <= steps.size(); ++block) {
+                        const double meanSquare =
+                            (steps[block] + steps[block + 1] + steps[block + 2] + steps[block + 3]) / blockLength;
+                        if (meanSquare > 0.0 && toLufs(meanSquare) > gateLufs) {
+                                sum += meanSquare;
+                                ++count;
+                        }
+                }
+                return count > 0 ? sum / count : 0.0;
+        };
+
+        const double absolutelyGated = gatedMean(-70.0);
+        if (absolutelyGated <= 0.0) {
+                return silenceLufs;
+        }
+
+        const double relativelyGated = gatedMean(toLufs(absolutelyGated) - 10.0);
+        return (float) toLufs(relativelyGated > 0.0 ? relativelyGated : absolutelyGated);
+}
+
+//==============================================================================
+float LevelMeter::takePeak(int channel) { return peak[channel].exchange(0.0f); }
+
+float LevelMeter::getRms(int channel) const { return rms[channel].load(); }
+
+float LevelMeter::getShortTermLufs() const { return shortTermLufs.load(); }
+
+bool LevelMeter::isClipHeld() const {
+        return hasClipped.load() && juce::Time::getMillisecondCounter() - lastClipMs.load() < clipHoldMs;
+}
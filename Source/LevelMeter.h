@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    LevelMeter.h
+    Created: 19/10/2026 22:08:15
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+
+//==============================================================================
+/*
+ * LevelMeter measures a signal in place on the audio thread: sample peak,
+ * RMS (300 ms integration), short-term loudness (EBU R128, K-weighted, 3 s
+ * window) and clips. Peak and sum of squares are computed in one SIMD pass
+ * over the block; the K-weighting runs per sample but only accumulates, it
+ * never writes a filtered copy.
+ *
+ * Results are published through atomics. The peak is the highest since the
+ * display last took it, so no peak between two repaints is lost.
+ *
+ * measureIntegratedLufs() applies the same K-weighting to a whole track
+ * offline, for the library's loudness column.
+ */
+class LevelMeter {
+       public:
+        static constexpr int maxChannels = 2;
+
+        LevelMeter();
+
+        void prepare(double sampleRate);
+
+        // audio thread, reads the buffer without changing it
+        void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+        // message thread
+        float takePeak(int channel);
+        float getRms(int channel) const;
+        // LUFS, silenceLufs when there is nothing to measure
+        float getShortTermLufs() const;
+        // a sample reached full scale within the last clipHoldMs
+        bool isClipHeld() const;
+
+        static constexpr float silenceLufs = -100.0f;
+        static constexpr juce::uint32 clipHoldMs = 2000;
+
+        // integrated loudness of the first numSamples of the buffer, BS.1770 gated (400 ms blocks, -70 LUFS
+        // absolute and -10 LU relative gates), every channel with a weight of one; any thread
+        static float measureIntegratedLufs(const juce::AudioBuffer<float>& buffer, int numSamples, double rate);
+
+       private:
+        struct Biquad {
+                double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+                double z1 = 0.0, z2 = 0.0;
+
+                double process(double x) {
+                        const double y = b0 * x + z1;
+                        z1 = b1 * x - a1 * y + z2;
+                        z2 = b2 * x - a2 * y;
+                        return y;
+                }
+        };
+
+        // BS.1770 K-weighting for the given rate
+        static void designKWeighting(double rate, Biquad& shelf, Biquad& highPass);
+
+        // short-term loudness is kept as 30 sums of 100 ms
+        static constexpr int numLoudnessBlocks = 30;
+
+        // audio thread
+        double sampleRate = 44100.0;
+        Biquad shelf[maxChannels], highPass[maxChannels];
+        double meanSquare[maxChannels] = {};
+        double loudnessBlocks[numLoudnessBlocks] = {};
+        int loudnessBlockIndex = 0;
+        int loudnessBlocksFilled = 0;
+        double loudnessAccumulator = 0.0;
+        int loudnessBlockSamples = 0;
+        int loudnessBlockLength = 4410;
+
+        // published
+        std::atomic<float> peak[maxChannels];
+        std::atomic<float> rms[maxChannels];
+        std::atomic<float> shortTermLufs{silenceLufs};
+        std::atomic<juce::uint32> lastClipMs{0};
+        std::atomic<bool> hasClipped{false};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LevelMeter)
+};
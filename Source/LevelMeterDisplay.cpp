@@ -0,0 +1,85 @@
+#include "LevelMeterDisplay.h"
+
+namespace {
+// peak hold falls this far per repaint, about 45 dB a second
+const float peakFallDb = 1.5f;
+}        // namespace
+
+LevelMeterDisplay::LevelMeterDisplay(LevelMeter& _meter, const juce::String& _name) : meter(_meter), name(_name) {
+        for (int channel = 0; channel < LevelMeter::maxChannels; ++channel) {
+                rmsDb[channel] = floorDb;
+                peakHoldDb[channel] = floorDb;
+        }
+        setOpaque(true);
+        startTimerHz(30);
+}
+
+LevelMeterDisplay::~LevelMeterDisplay() { stopTimer(); }
+
+void LevelMeterDisplay::timerCallback() {
+        // only the numbers are read here, the audio thread never waits for the display
+        for (int channel = 0; channel < LevelMeter::maxChannels; ++channel) {
+                const float peakDb = juce::Decibels::gainToDecibels(meter.takePeak(channel), floorDb);
+                peakHoldDb[channel] = juce::jmax(peakDb, peakHoldDb[channel] - peakFallDb);
+                rmsDb[channel] = juce::Decibels::gainToDecibels(meter.getRms(channel), floorDb);
+        }
+        lufs = meter.getShortTermLufs();
+        clipHeld = meter.isClipHeld();
+        repaint();
+}
+
+void LevelMeterDisplay::paint(juce::Graphics& g) {
+        g.fillAll(juce::Colours::black);
+
+        const bool horizontal = getWidth() >= getHeight();
+        auto area = getLocalBounds().reduced(2);
+
+        // clip light at the loud end, loudness text at the quiet end
+        const int clipSize = horizontal ? juce::jmin(12, area.getHeight()) : juce::jmin(12, area.getWidth());
+        const auto clipArea = horizontal ? area.removeFromRight(clipSize) : area.removeFromTop(clipSize);
+        g.setColour(clipHeld ? juce::Colours::red : juce::Colours::darkred.withAlpha(0.4f));
+        g.fillRect(clipArea);
+
+        const juce::String lufsText = lufs > LevelMeter::silenceLufs ? juce::String(lufs, 1) + " LUFS" : "-- LUFS";
+        g.setColour(juce::Colours::white);
+        g.setFont(11.0f);
+        if (horizontal) {
+                g.drawText(name + "  " + lufsText, area.removeFromLeft(juce::jmin(110, area.getWidth() / 3)),
+                           juce::Justification::centredLeft);
+        } else {
+                g.drawText(lufsText.upToFirstOccurrenceOf(" ", false, false), area.removeFromBottom(14),
+                           juce::Justification::centred);
+        }
+
+        auto toProportion = [](float db) { return juce::jlimit(0.0f, 1.0f, (db - floorDb) / -floorDb); };
+
+        for (int channel = 0; channel < LevelMeter::maxChannels; ++channel) {
+                const int numLeft = LevelMeter::maxChannels - channel;
+                auto bar = horizontal ? area.removeFromTop(area.getHeight() / numLeft).reduced(1)
+                                      : area.removeFromLeft(area.getWidth() / numLeft).reduced(1);
+
+                g.setColour(juce::Colours::darkgrey.darker());
+                g.fillRect(bar);
+
+                const float rms = toProportion(rmsDb[channel]);
+                g.setColour(rmsDb[channel] > -3.0f    ? juce::Colours::red
+                            : rmsDb[channel] > -12.0f ? juce::Colours::yellow
+                                                      : juce::Colours::limegreen);
+                if (horizontal) {
+                        g.fillRect(bar.withWidth(juce::roundToInt(bar.getWidth() * rms)));
+                } else {
+                        const int height = juce::roundToInt(bar.getHeight() * rms);
+                        g.fillRect(bar.withTop(bar.getBottom() - height));
+                }
+
+                const float peak = toProportion(peakHoldDb[channel]);
+                g.setColour(juce::Colours::white);
+                if (horizontal) {
+                        const float x = bar.getX() + bar.getWidth() * peak;
+                        g.drawVerticalLine(juce::roundToInt(x), (float) bar.getY(), (float) bar.getBottom());
+                } else {
+                        const float y = bar.getBottom() - bar.getHeight() * peak;
+                        g.drawHorizontalLine(juce::roundToInt(y), (float) bar.getX(), (float) bar.getRight());
+                }
+        }
+}
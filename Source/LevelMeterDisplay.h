@@ -0,0 +1,30 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "LevelMeter.h"
+
+// Level meter for a deck or the master: a bar per channel with RMS fill and a falling peak-hold line, a clip light
+// held for two seconds and the short-term loudness. Laid out along the longer side of its bounds.
+class LevelMeterDisplay : public juce::Component, private juce::Timer {
+       public:
+        LevelMeterDisplay(LevelMeter& meter, const juce::String& name);
+        ~LevelMeterDisplay() override;
+
+        void paint(juce::Graphics&) override;
+
+       private:
+        void timerCallback() override;
+
+        static constexpr float floorDb = -60.0f;
+
+        LevelMeter& meter;
+        juce::String name;
+
+        float rmsDb[LevelMeter::maxChannels];
+        float peakHoldDb[LevelMeter::maxChannels];
+        float lufs = LevelMeter::silenceLufs;
+        bool clipHeld = false;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LevelMeterDisplay)
+};
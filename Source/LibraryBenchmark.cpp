@@ -0,0 +1,224 @@
+/*
+  ==============================================================================
+
+    LibraryBenchmark.cpp
+    Created: 20/10/2026 02:49:23
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "LibraryBenchmark.h"
+
+#include <JuceHeader.h>
+
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "LibraryLoader.h"
+#include "LibraryModel.h"
+#include "TestSupport.h"
+
+namespace {
+const double frameMs = 1000.0 / 60.0;
+const int repetitions = 5;
+const int tracksToDelete = 100;
+
+const char* const words[] = {"Midnight", "Echo",   "Velvet", "Drive",  "Neon",   "Garden", "Signal", "Harbour",
+                             "Static",   "Bloom",  "Orbit",  "Copper", "Window", "Fever",  "Ritual", "Summer",
+                             "Glass",    "Motion", "Silver", "Tide",   "Lantern", "Pulse", "Shadow", "River"};
+constexpr int numWords = (int) (sizeof(words) / sizeof(words[0]));
+
+// artist folders of album folders, and titles like "Neon Harbour (Remix 17)"; every path is unique
+juce::String makeLibrary(const juce::File& root, int numTracks) {
+        juce::Random random(0x11b);
+        juce::String csv;
+        csv.preallocateBytes((size_t) numTracks * 96);
+
+        for (int index = 0; index < numTracks; ++index) {
+                const juce::String artist = juce::String(words[random.nextInt(numWords)]) + " " + juce::String(index % 500);
+                const juce::String album = "Album " + juce::String(index % 2000);
+                const juce::String title = juce::String(words[random.nextInt(numWords)]) + " " +
+                                           words[random.nextInt(numWords)] + " (Mix " + juce::String(index) + ")";
+                const int seconds = 60 + random.nextInt(540);
+
+                csv << root.getChildFile(artist).getChildFile(album).getChildFile(title + ".mp3").getFullPathName()
+                    << "," << seconds / 60 << ":" << juce::String(seconds % 60).paddedLeft('0', 2) << ",";
+
+                // one track in ten has not been analysed yet
+                if (random.nextInt(10) != 0) {
+                        csv << juce::String(80.0f + random.nextFloat() * 90.0f, 2) << ","
+                            << juce::String(-20.0f + random.nextFloat() * 15.0f, 2) << " LUFS";
+                } else {
+                        csv << ",";
+                }
+                csv << "\n";
+        }
+        return csv;
+}
+
+// what PlaylistComponent does with the loaded rows
+class ModelFiller : public LibraryLoader::Listener {
+       public:
+        explicit ModelFiller(LibraryModel& _model) : model(_model) {}
+
+        void libraryEntriesLoaded(const std::vector<LibraryLoader::Entry>& entries) override {
+                model.reserve(model.getNumTracks() + (int) entries.size());
+
+                for (const LibraryLoader::Entry& entry : entries) {
+                        const TrackId id = model.addTrack(entry.file, entry.lengthSeconds);
+                        model.setBpm(id, entry.bpm);
+                        model.setLoudness(id, entry.loudnessLufs);
+                }
+                model.rebuildView();
+        }
+
+        void libraryLoadFinished() override {}
+
+       private:
+        LibraryModel& model;
+};
+
+double timeMs(const std::function<void()>& operation) {
+        const double start = juce::Time::getMillisecondCounterHiRes();
+        operation();
+        return juce::Time::getMillisecondCounterHiRes() - start;
+}
+
+// every run is timed on its own after an untimed prepare, so none of them starts from the result of the last;
+// false when the slowest run is over a frame, and the rows are counted after the last run
+bool report(const juce::String& name, int runs, const std::function<void()>& prepare,
+            const std::function<void()>& operation, const LibraryModel& model) {
+        double worst = 0.0, total = 0.0;
+
+        for (int index = 0; index < runs; ++index) {
+                prepare();
+                const double ms = timeMs(operation);
+                worst = juce::jmax(worst, ms);
+                total += ms;
+        }
+
+        const bool withinFrame = worst <= frameMs;
+        std::cout << name.paddedRight(' ', 28) << juce::String(worst, 2).paddedLeft(' ', 9) << " ms worst, "
+                  << juce::String(total / runs, 2) << " ms mean" << (withinFrame ? "" : ", FAIL over a frame") << ", "
+                  << model.getNumRows() << " rows" << std::endl;
+        return withinFrame;
+}
+}        // namespace
+
+//==============================================================================
+namespace LibraryBenchmark {
+int run(int numTracks) {
+        const juce::File launchDirectory = juce::File::getCurrentWorkingDirectory();
+        const juce::File directory = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                                         .getNonexistentChildFile("otodeck-library-benchmark", "", false);
+        directory.createDirectory();
+        directory.setAsCurrentWorkingDirectory();
+
+        std::cout << "Library benchmark: " << numTracks << " tracks in " << directory.getFullPathName() << std::endl;
+
+        double generateMs = 0.0;
+        {
+                juce::String csv;
+                generateMs = timeMs([&] {
+                        csv = makeLibrary(directory.getChildFile("music"), numTracks);
+                        directory.getChildFile("audioLibrary.csv").replaceWithText(csv);
+                });
+        }
+        std::cout << "generated in " << juce::String(generateMs, 0) << " ms" << std::endl;
+
+        // the loader parses on its own thread; finishNow waits for it and hands over the rows still pending
+        LibraryModel model;
+        ModelFiller filler(model);
+        const double loadMs = timeMs([&] {
+                LibraryLoader loader;
+                loader.start(&filler);
+                loader.finishNow();
+        });
+
+        const bool allLoaded = model.getNumTracks() == numTracks;
+        std::cout << juce::String("load").paddedRight(' ', 28) << juce::String(loadMs, 2).paddedLeft(' ', 9) << " ms, "
+                  << model.getNumTracks() << " of " << numTracks << " tracks" << (allLoaded ? "" : " FAIL")
+                  << std::endl;
+
+        const std::pair<const char*, LibraryModel::SortColumn> sorts[] = {
+            {"title", LibraryModel::SortColumn::title},
+            {"length", LibraryModel::SortColumn::length},
+            {"bpm", LibraryModel::SortColumn::bpm},
+            {"loudness", LibraryModel::SortColumn::loudness},
+        };
+        constexpr int numSorts = (int) (sizeof(sorts) / sizeof(sorts[0]));
+        int failures = allLoaded ? 0 : 1;
+
+        // sorted by the next column first, so every run sorts a view that is not already in order
+        for (int index = 0; index < numSorts; ++index) {
+                const LibraryModel::SortColumn column = sorts[index].second;
+                const LibraryModel::SortColumn other = sorts[(index + 1) % numSorts].second;
+
+                for (bool forwards : {true, false}) {
+                        const juce::String name = juce::String("sort by ") + sorts[index].first + (forwards ? " up" : " down");
+                        const bool passed = report(name, repetitions, [&] { model.setSort(other, true); },
+                                                   [&] { model.setSort(column, forwards); }, model);
+                        failures += passed ? 0 : 1;
+                }
+        }
+        model.setSort(LibraryModel::SortColumn::title, true);
+
+        LibraryFilter title;
+        title.titleContains = "neon";
+        LibraryFilter bpm;
+        bpm.minBpm = 120.0f;
+        bpm.maxBpm = 130.0f;
+        LibraryFilter length;
+        length.minLengthSeconds = 180.0f;
+        length.maxLengthSeconds = 300.0f;
+        LibraryFilter combined = title;
+        combined.minBpm = bpm.minBpm;
+        combined.maxBpm = bpm.maxBpm;
+        combined.minLengthSeconds = length.minLengthSeconds;
+        combined.maxLengthSeconds = length.maxLengthSeconds;
+
+        const std::pair<const char*, LibraryFilter> filters[] = {
+            {"filter title", title}, {"filter bpm", bpm}, {"filter length", length}, {"filter all", combined},
+            {"filter cleared", {}},
+        };
+
+        // a filter rebuilds the view from the columns every time, so there is nothing to reset in between
+        for (const auto& filter : filters) {
+                const bool passed = report(filter.first, repetitions, [] {},
+                                           [&] { model.setFilter(filter.second); }, model);
+                failures += passed ? 0 : 1;
+        }
+
+        // one delete as the playlist does it, the view rebuilt after each; through the middle of the columns,
+        // the expensive end for an in-place erase
+        const bool deletesPassed = report("delete one and rebuild", tracksToDelete, [] {},
+                                          [&] {
+                                                  if (model.getNumTracks() > 0) {
+                                                          model.removeTrack(model.getTrackId(model.getNumTracks() / 2));
+                                                  }
+                                                  model.rebuildView();
+                                          },
+                                          model);
+        failures += deletesPassed ? 0 : 1;
+
+        launchDirectory.setAsCurrentWorkingDirectory();
+        directory.deleteRecursively();
+
+        std::cout << (failures == 0 ? juce::String("every view operation fits in a frame")
+                                    : juce::String(failures) + " check(s) failed")
+                  << std::endl;
+        return failures;
+}
+
+bool runFromCommandLine(const juce::String& commandLine, int& exitCode) {
+        double numTracks = 0.0;
+        if (!TestSupport::findFlag(commandLine, "--library-benchmark", 100000.0, numTracks)) {
+                return false;
+        }
+
+        exitCode = run((int) numTracks) == 0 ? 0 : 1;
+        return true;
+}
+}        // namespace LibraryBenchmark
@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    LibraryBenchmark.h
+    Created: 20/10/2026 02:49:23
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+ * Times the library at scale. "--library-benchmark [tracks]" (default 100000)
+ * writes a synthetic audioLibrary.csv of that many rows to a scratch
+ * directory, loads it through LibraryLoader into a LibraryModel the way the
+ * playlist does, then times every sort, a set of filters and single deletes
+ * with the view rebuilt after each, as the playlist does them. Every run is
+ * timed on its own, and a sort always starts from a view sorted by another
+ * column, so no run is flattered by the one before it.
+ *
+ * Each view operation has one 60 fps frame: the run fails when the slowest
+ * run of any of them takes longer, or when not every row was loaded. The
+ * exit code is 1 on any failure.
+ */
+namespace LibraryBenchmark {
+// returns the number of failed checks
+int run(int numTracks);
+
+// handles --library-benchmark, false if the command line does not ask for it
+bool runFromCommandLine(const juce::String& commandLine, int& exitCode);
+}        // namespace LibraryBenchmark
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    LibraryLoader.cpp
+    Created: 19/10/2026 22:41:37
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "LibraryLoader.h"
+
+#include <JuceHeader.h>
+
+#include <fstream>
+#include <limits>
+
+#include "Tracer.h"
+
+namespace {
+const char* const libraryFileName = "audioLibrary.csv";
+
+// lengths are stored as m:ss
+double minutesToSeconds(const juce::String& minutes) {
+        return minutes.upToFirstOccurrenceOf(":", false, false).getIntValue() * 60.0 +
+               minutes.fromFirstOccurrenceOf(":", false, false).getIntValue();
+}
+}        // namespace
+
+//==============================================================================
+LibraryLoader::LibraryLoader() : juce::Thread("Library loader") {}
+
+LibraryLoader::~LibraryLoader() {
+        stopThread(5000);
+        cancelPendingUpdate();
+}
+
+void LibraryLoader::start(Listener* _listener) {
+        listener = _listener;
+        startThread();
+}
+
+bool LibraryLoader::isFinished() const { return finished; }
+
+void LibraryLoader::finishNow() {
+        waitForThreadToExit(-1);
+        cancelPendingUpdate();
+
+        std::vector<Entry> entries;
+        {
+                const juce::ScopedLock sl(entryLock);
+                entries.swap(pendingEntries);
+        }
+        if (listener != nullptr && !entries.empty()) {
+                listener->libraryEntriesLoaded(entries);
+        }
+}
+
+//==============================================================================
+void LibraryLoader::run() {
+        OTODECK_TRACE_SCOPE("Library load");
+        std::ifstream myLibrary(libraryFileName);
+        std::string filePath;
+        std::string fields;
+        std::vector<Entry> batch;
+
+        auto post = [this, &batch] {
+                const juce::ScopedLock sl(entryLock);
+                pendingEntries.insert(pendingEntries.end(), batch.begin(), batch.end());
+                batch.clear();
+                triggerAsyncUpdate();
+        };
+
+        // path,length,bpm,loudness per line; older files only have path,length, or an RMS level without a unit
+        // where the loudness goes, which is dropped
+        while (!threadShouldExit() && myLibrary.is_open() && getline(myLibrary, filePath, ',')) {
+                getline(myLibrary, fields);
+
+                juce::StringArray values = juce::StringArray::fromTokens(juce::String(fields).trim(), ",", "");
+                while (values.size() < 3) {
+                        values.add({});
+                }
+
+                Entry entry;
+                entry.file = juce::File{filePath};
+                entry.lengthSeconds = (float) minutesToSeconds(values[0]);
+                entry.bpm = values[1].isNotEmpty() ? values[1].getFloatValue() : std::numeric_limits<float>::quiet_NaN();
+                entry.loudnessLufs = values[2].endsWithIgnoreCase("LUFS") ? values[2].getFloatValue()
+                                                                          : std::numeric_limits<float>::quiet_NaN();
+                batch.push_back(std::move(entry));
+
+                if ((int) batch.size() == batchSize) {
+                        post();
+                }
+        }
+
+        {
+                const juce::ScopedLock sl(entryLock);
+                fileRead = !threadShouldExit();
+        }
+        post();
+}
+
+void LibraryLoader::handleAsyncUpdate() {
+        std::vector<Entry> entries;
+        bool done = false;
+        {
+                const juce::ScopedLock sl(entryLock);
+                entries.swap(pendingEntries);
+                done = fileRead;
+        }
+
+        if (listener == nullptr) {
+                return;
+        }
+        if (!entries.empty()) {
+                listener->libraryEntriesLoaded(entries);
+        }
+        if (done && !finished) {
+                finished = true;
+                listener->libraryLoadFinished();
+        }
+}
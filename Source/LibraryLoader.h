@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    LibraryLoader.h
+    Created: 19/10/2026 22:41:37
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <vector>
+
+//==============================================================================
+/*
+ * LibraryLoader reads the saved library (audioLibrary.csv) on its own thread,
+ * so the window opens before a large library has been parsed. Rows are handed
+ * to the listener in batches on the message thread as they are read, followed
+ * by a single call once the whole file is in.
+ */
+class LibraryLoader : private juce::Thread, private juce::AsyncUpdater {
+       public:
+        struct Entry {
+                juce::File file;
+                float lengthSeconds = 0.0f;
+                // NaN when the track has not been analysed
+                float bpm = 0.0f;
+                float loudnessLufs = 0.0f;
+        };
+
+        class Listener {
+               public:
+                virtual ~Listener() = default;
+                // message thread
+                virtual void libraryEntriesLoaded(const std::vector<Entry>& entries) = 0;
+                virtual void libraryLoadFinished() = 0;
+        };
+
+        LibraryLoader();
+        ~LibraryLoader() override;
+
+        void start(Listener* listener);
+        bool isFinished() const;
+
+        // blocks until the file is read and delivers the rows still pending, without the finished call, so
+        // the library can be saved on the way out
+        void finishNow();
+
+       private:
+        void run() override;
+        void handleAsyncUpdate() override;
+
+        // rows per batch, a rebuild of the view per batch keeps the table responsive while it fills
+        static constexpr int batchSize = 1000;
+
+        Listener* listener = nullptr;
+
+        juce::CriticalSection entryLock;
+        std::vector<Entry> pendingEntries;
+        bool fileRead = false;
+        // message thread
+        bool finished = false;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LibraryLoader)
+};
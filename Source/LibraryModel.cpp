@@ -0,0 +1,408 @@
+/*
+  ==============================================================================
+
+    LibraryModel.cpp
+    Created: 19/10/2026 15:02:11
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "LibraryModel.h"
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+//==============================================================================
+namespace {
+// below this the work stays on the calling thread, handing it out would cost more than it saves
+const size_t minParallelItems = 8192;
+
+// runs task(0) to task(numTasks - 1), the first on the calling thread and the rest on the pool, and waits for all
+template <typename Task>
+void runTasks(juce::ThreadPool& pool, int numTasks, const Task& task) {
+        std::atomic<int> remaining{numTasks - 1};
+        juce::WaitableEvent finished;
+
+        for (int index = 1; index < numTasks; ++index) {
+                pool.addJob([&task, &remaining, &finished, index] {
+                        task(index);
+                        if (remaining.fetch_sub(1) == 1) {
+                                finished.signal();
+                        }
+                });
+        }
+
+        task(0);
+        if (numTasks > 1) {
+                finished.wait();
+        }
+}
+
+// one range for each worker and one for the calling thread
+int getNumRanges(const juce::ThreadPool& pool, size_t numItems, size_t minItems) {
+        return numItems < minItems ? 1 : pool.getNumThreads() + 1;
+}
+
+size_t getRangeStart(size_t numItems, int range, int numRanges) { return numItems * (size_t) range / (size_t) numRanges; }
+
+// function(begin, end) over contiguous ranges that together cover [0, numItems)
+template <typename Function>
+void parallelFor(juce::ThreadPool& pool, size_t numItems, size_t minItems, const Function& function) {
+        const int numRanges = getNumRanges(pool, numItems, minItems);
+
+        runTasks(pool, numRanges, [&](int range) {
+                function(getRangeStart(numItems, range, numRanges), getRangeStart(numItems, range + 1, numRanges));
+        });
+}
+
+// every range is sorted on its own, then neighbours are merged pairwise, the merges of a round in parallel;
+// the comparators are total orders, so the result is the same as one std::sort
+template <typename Compare>
+void parallelSort(juce::ThreadPool& pool, std::vector<juce::uint32>& values, const Compare& compare) {
+        const size_t numItems = values.size();
+        const int numRanges = getNumRanges(pool, numItems, minParallelItems);
+        auto at = [&](int range) { return values.begin() + (std::ptrdiff_t) getRangeStart(numItems, range, numRanges); };
+
+        runTasks(pool, numRanges, [&](int range) { std::sort(at(range), at(range + 1), compare); });
+
+        for (int width = 1; width < numRanges; width *= 2) {
+                const int numMerges = (numRanges + 2 * width - 1) / (2 * width);
+
+                runTasks(pool, numMerges, [&](int merge) {
+                        const int first = merge * 2 * width;
+                        std::inplace_merge(at(first), at(juce::jmin(first + width, numRanges)),
+                                           at(juce::jmin(first + 2 * width, numRanges)), compare);
+                });
+        }
+}
+}        // namespace
+
+//==============================================================================
+juce::uint32 LibraryModel::StringPool::intern(const juce::String& s) {
+        auto [it, inserted] = indices.try_emplace(s, (juce::uint32) strings.size());
+
+        if (inserted) {
+                strings.push_back(s);
+        }
+        return it->second;
+}
+
+int LibraryModel::StringPool::find(const juce::String& s) const {
+        auto it = indices.find(s);
+        return it != indices.end() ? (int) it->second : -1;
+}
+
+void LibraryModel::StringPool::clear() {
+        strings.clear();
+        indices.clear();
+}
+
+//==============================================================================
+LibraryModel::LibraryModel() {}
+
+LibraryModel::~LibraryModel() {}
+
+TrackId LibraryModel::addTrack(const juce::File& file, float lengthSeconds) {
+        const TrackId id = nextId++;
+        const juce::uint32 title = strings.intern(file.getFileNameWithoutExtension());
+
+        indexById[id] = (int) ids.size();
+        idByPath[file.getFullPathName()] = id;
+        ++titleCounts[title];
+
+        ids.push_back(id);
+        directories.push_back(strings.intern(file.getParentDirectory().getFullPathName()));
+        fileNames.push_back(strings.intern(file.getFileName()));
+        titles.push_back(title);
+        lengths.push_back(lengthSeconds);
+        bpms.push_back(std::numeric_limits<float>::quiet_NaN());
+        loudnesses.push_back(std::numeric_limits<float>::quiet_NaN());
+
+        return id;
+}
+
+bool LibraryModel::removeTrack(TrackId id) {
+        const int index = indexOf(id);
+
+        if (index < 0) {
+                return false;
+        }
+
+        removeTitleCount(titles[(size_t) index]);
+        indexById.erase(id);
+        idByPath.erase(getFile(index).getFullPathName());
+
+        // erased in place, so storage order stays insertion order, which is what the unsorted view shows
+        const auto erase = [index](auto& column) { column.erase(column.begin() + index); };
+        erase(ids);
+        erase(directories);
+        erase(fileNames);
+        erase(titles);
+        erase(lengths);
+        erase(bpms);
+        erase(loudnesses);
+
+        for (size_t later = (size_t) index; later < ids.size(); ++later) {
+                indexById[ids[later]] = (int) later;
+        }
+
+        return true;
+}
+
+void LibraryModel::removeTitleCount(juce::uint32 title) {
+        auto it = titleCounts.find(title);
+
+        if (it != titleCounts.end() && --it->second == 0) {
+                titleCounts.erase(it);
+        }
+}
+
+void LibraryModel::clear() {
+        ids.clear();
+        directories.clear();
+        fileNames.clear();
+        titles.clear();
+        lengths.clear();
+        bpms.clear();
+        loudnesses.clear();
+
+        strings.clear();
+        stringRanks.clear();
+        indexById.clear();
+        idByPath.clear();
+        titleCounts.clear();
+        filterBits.clear();
+        view.clear();
+}
+
+void LibraryModel::reserve(int numTracks) {
+        const size_t size = (size_t) numTracks;
+
+        ids.reserve(size);
+        directories.reserve(size);
+        fileNames.reserve(size);
+        titles.reserve(size);
+        lengths.reserve(size);
+        bpms.reserve(size);
+        loudnesses.reserve(size);
+        indexById.reserve(size);
+        idByPath.reserve(size);
+}
+
+int LibraryModel::getNumTracks() const { return (int) ids.size(); }
+
+TrackId LibraryModel::getTrackId(int trackIndex) const { return ids[(size_t) trackIndex]; }
+
+const juce::String& LibraryModel::getTitle(int trackIndex) const { return strings.get(titles[(size_t) trackIndex]); }
+
+juce::File LibraryModel::getFile(int trackIndex) const {
+        return juce::File{strings.get(directories[(size_t) trackIndex])}.getChildFile(
+            strings.get(fileNames[(size_t) trackIndex]));
+}
+
+float LibraryModel::getLengthSeconds(int trackIndex) const { return lengths[(size_t) trackIndex]; }
+
+float LibraryModel::getBpm(int trackIndex) const { return bpms[(size_t) trackIndex]; }
+
+float LibraryModel::getLoudness(int trackIndex) const { return loudnesses[(size_t) trackIndex]; }
+
+int LibraryModel::indexOf(TrackId id) const {
+        auto it = indexById.find(id);
+        return it != indexById.end() ? it->second : -1;
+}
+
+TrackId LibraryModel::findTrack(const juce::File& file) const {
+        auto it = idByPath.find(file.getFullPathName());
+        return it != idByPath.end() ? it->second : 0;
+}
+
+void LibraryModel::setLengthSeconds(TrackId id, float lengthSeconds) {
+        const int index = indexOf(id);
+        if (index >= 0) {
+                lengths[(size_t) index] = lengthSeconds;
+        }
+}
+
+void LibraryModel::setBpm(TrackId id, float bpm) {
+        const int index = indexOf(id);
+        if (index >= 0) {
+                bpms[(size_t) index] = bpm;
+        }
+}
+
+void LibraryModel::setLoudness(TrackId id, float loudness) {
+        const int index = indexOf(id);
+        if (index >= 0) {
+                loudnesses[(size_t) index] = loudness;
+        }
+}
+
+int LibraryModel::getNumRows() const { return (int) view.size(); }
+
+int LibraryModel::getTrackIndexForRow(int row) const { return (int) view[(size_t) row]; }
+
+int LibraryModel::getRowForTrack(TrackId id) const {
+        const int index = indexOf(id);
+
+        if (index < 0) {
+                return -1;
+        }
+
+        auto it = std::find(view.begin(), view.end(), (juce::uint32) index);
+        return it != view.end() ? (int) std::distance(view.begin(), it) : -1;
+}
+
+void LibraryModel::setSort(SortColumn column, bool forwards) {
+        sortColumn = column;
+        sortForwards = forwards;
+        applySort();
+}
+
+void LibraryModel::setFilter(const LibraryFilter& newFilter) {
+        filter = newFilter;
+        rebuildView();
+}
+
+void LibraryModel::rebuildView() {
+        applyFilter();
+        applySort();
+}
+
+void LibraryModel::applyFilter() {
+        const size_t numTracks = ids.size();
+        filterBits.assign((numTracks + 63) / 64, 0);
+
+        // title matching only has to look at each distinct string once
+        std::vector<std::uint8_t> stringMatches;
+        if (filter.titleContains.isNotEmpty()) {
+                stringMatches.resize((size_t) strings.size());
+                parallelFor(workers, stringMatches.size(), minParallelItems, [&](size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; ++i) {
+                                stringMatches[i] =
+                                    strings.get((juce::uint32) i).containsIgnoreCase(filter.titleContains) ? 1 : 0;
+                        }
+                });
+        }
+
+        auto passes = [&](size_t i) {
+                if (!stringMatches.empty() && stringMatches[titles[i]] == 0) {
+                        return false;
+                }
+                // an unanalysed BPM (NaN) fails any BPM bound
+                if (filter.minBpm > 0 && !(bpms[i] >= filter.minBpm)) {
+                        return false;
+                }
+                if (filter.maxBpm > 0 && !(bpms[i] <= filter.maxBpm)) {
+                        return false;
+                }
+                if (filter.minLengthSeconds > 0 && lengths[i] < filter.minLengthSeconds) {
+                        return false;
+                }
+                if (filter.maxLengthSeconds > 0 && lengths[i] > filter.maxLengthSeconds) {
+                        return false;
+                }
+                return true;
+        };
+
+        // every 64-track word is independent, so the words are filled in parallel without sharing
+        parallelFor(workers, filterBits.size(), minParallelItems / 64, [&](size_t begin, size_t end) {
+                for (size_t word = begin; word < end; ++word) {
+                        std::uint64_t bits = 0;
+                        const size_t last = std::min(numTracks, (word + 1) * 64);
+
+                        for (size_t i = word * 64; i < last; ++i) {
+                                if (passes(i)) {
+                                        bits |= std::uint64_t{1} << (i - word * 64);
+                                }
+                        }
+                        filterBits[word] = bits;
+                }
+        });
+
+        view.clear();
+        view.reserve(numTracks);
+
+        for (size_t word = 0; word < filterBits.size(); ++word) {
+                const std::uint64_t bits = filterBits[word];
+
+                for (size_t bit = 0; bits != 0 && bit < 64; ++bit) {
+                        if ((bits >> bit) & 1) {
+                                view.push_back((juce::uint32) (word * 64 + bit));
+                        }
+                }
+        }
+}
+
+const std::vector<juce::uint32>& LibraryModel::getStringRanks() {
+        if ((int) stringRanks.size() != strings.size()) {
+                std::vector<juce::uint32> order((size_t) strings.size());
+                std::iota(order.begin(), order.end(), 0);
+
+                parallelSort(workers, order, [this](juce::uint32 a, juce::uint32 b) {
+                        return strings.get(a).compareNatural(strings.get(b)) < 0;
+                });
+
+                stringRanks.resize(order.size());
+                for (size_t rank = 0; rank < order.size(); ++rank) {
+                        stringRanks[order[rank]] = (juce::uint32) rank;
+                }
+        }
+        return stringRanks;
+}
+
+void LibraryModel::applySort() {
+        const bool forwards = sortForwards;
+
+        auto sortByFloat = [&](const std::vector<float>& column) {
+                parallelSort(workers, view, [&column, forwards](juce::uint32 a, juce::uint32 b) {
+                        const float x = column[a], y = column[b];
+
+                        // unknown values always go to the end
+                        if (std::isnan(x) || std::isnan(y)) {
+                                return std::isnan(x) == std::isnan(y) ? a < b : std::isnan(y);
+                        }
+                        if (x != y) {
+                                return forwards ? x < y : x > y;
+                        }
+                        return a < b;
+                });
+        };
+
+        switch (sortColumn) {
+                case SortColumn::title: {
+                        // compare precomputed ranks instead of strings
+                        const std::vector<juce::uint32>& ranks = getStringRanks();
+                        parallelSort(workers, view, [&](juce::uint32 a, juce::uint32 b) {
+                                const juce::uint32 x = ranks[titles[a]], y = ranks[titles[b]];
+                                if (x != y) {
+                                        return forwards ? x < y : x > y;
+                                }
+                                return a < b;
+                        });
+                        break;
+                }
+                case SortColumn::length:
+                        sortByFloat(lengths);
+                        break;
+                case SortColumn::bpm:
+                        sortByFloat(bpms);
+                        break;
+                case SortColumn::loudness:
+                        sortByFloat(loudnesses);
+                        break;
+                case SortColumn::none:
+                default:
+                        break;
+        }
+}
+
+bool LibraryModel::containsTitle(const juce::String& title) const {
+        const int titleIndex = strings.find(title);
+        return titleIndex >= 0 && titleCounts.count((juce::uint32) titleIndex) > 0;
+}
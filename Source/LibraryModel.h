@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    LibraryModel.h
+    Created: 19/10/2026 15:02:11
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Stable identity of a library entry, unlike a row number it survives deletes and sorts
+using TrackId = juce::uint32;
+
+//==============================================================================
+// Criteria for the library view, a zero bound means unbounded
+struct LibraryFilter {
+        juce::String titleContains;
+        float minBpm = 0.0f, maxBpm = 0.0f;
+        float minLengthSeconds = 0.0f, maxLengthSeconds = 0.0f;
+
+        bool isEmpty() const {
+                return titleContains.isEmpty() && minBpm <= 0 && maxBpm <= 0 && minLengthSeconds <= 0 &&
+                       maxLengthSeconds <= 0;
+        }
+};
+
+//==============================================================================
+/*
+ * LibraryModel stores the library column by column: interned strings for
+ * directories and titles, plain float columns for length, BPM and loudness,
+ * and a bitset for the current filter. Sorting and filtering split the
+ * columns into one range per core on the model's own thread pool, and only
+ * produce a permutation of track indices, which is what the table shows.
+ * Small libraries are done on the calling thread.
+ *
+ * Track indices address the columns and change when tracks are removed; rows
+ * address the filtered and sorted view; TrackIds are stable.
+ */
+class LibraryModel {
+       public:
+        enum class SortColumn { none, title, length, bpm, loudness };
+
+        LibraryModel();
+        ~LibraryModel();
+
+        // the view is not touched, call rebuildView() once a batch of changes is done
+        TrackId addTrack(const juce::File& file, float lengthSeconds);
+        bool removeTrack(TrackId id);
+        void clear();
+        void reserve(int numTracks);
+
+        // all tracks, in storage order
+        int getNumTracks() const;
+        TrackId getTrackId(int trackIndex) const;
+        const juce::String& getTitle(int trackIndex) const;
+        juce::File getFile(int trackIndex) const;
+        float getLengthSeconds(int trackIndex) const;
+        // NaN until the track has been analysed
+        float getBpm(int trackIndex) const;
+        float getLoudness(int trackIndex) const;
+
+        // -1 when the id is not in the library
+        int indexOf(TrackId id) const;
+        // 0 when the file is not in the library
+        TrackId findTrack(const juce::File& file) const;
+        void setLengthSeconds(TrackId id, float lengthSeconds);
+        void setBpm(TrackId id, float bpm);
+        void setLoudness(TrackId id, float loudness);
+
+        // the filtered and sorted view shown by the table
+        int getNumRows() const;
+        int getTrackIndexForRow(int row) const;
+        int getRowForTrack(TrackId id) const;
+
+        void setSort(SortColumn column, bool forwards);
+        void setFilter(const LibraryFilter& filter);
+        // re-applies filter and sort after tracks were added, removed or updated
+        void rebuildView();
+
+        // files are compared by title
+        bool containsTitle(const juce::String& title) const;
+
+       private:
+        struct StringHash {
+                size_t operator()(const juce::String& s) const { return (size_t) s.hashCode64(); }
+        };
+
+        // each distinct string is stored once, columns hold its index
+        class StringPool {
+               public:
+                juce::uint32 intern(const juce::String& s);
+                // -1 when the string has never been interned
+                int find(const juce::String& s) const;
+                const juce::String& get(juce::uint32 index) const { return strings[index]; }
+                int size() const { return (int) strings.size(); }
+                void clear();
+
+               private:
+                std::vector<juce::String> strings;
+                std::unordered_map<juce::String, juce::uint32, StringHash> indices;
+        };
+
+        void applyFilter();
+        void applySort();
+        const std::vector<juce::uint32>& getStringRanks();
+        void removeTitleCount(juce::uint32 title);
+
+        // columns, all the same length
+        std::vector<TrackId> ids;
+        std::vector<juce::uint32> directories;
+        std::vector<juce::uint32> fileNames;
+        std::vector<juce::uint32> titles;
+        std::vector<float> lengths;
+        std::vector<float> bpms;
+        std::vector<float> loudnesses;
+
+        StringPool strings;
+        // position of every pooled string in natural sort order, rebuilt when new strings arrive
+        std::vector<juce::uint32> stringRanks;
+        std::unordered_map<TrackId, int> indexById;
+        std::unordered_map<juce::String, TrackId, StringHash> idByPath;
+        std::unordered_map<juce::uint32, int> titleCounts;
+        TrackId nextId = 1;
+
+        // one bit per track, set when it passes the filter
+        std::vector<std::uint64_t> filterBits;
+        std::vector<juce::uint32> view;
+
+        LibraryFilter filter;
+        SortColumn sortColumn = SortColumn::none;
+        bool sortForwards = true;
+
+        // the calling thread takes a share too, so one core is left to it
+        juce::ThreadPool workers{juce::jmax(1, juce::SystemStats::getNumCpus() - 1)};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LibraryModel)
+};
@@ -0,0 +1,467 @@
+/*
+  ==============================================================================
+
+    LibraryWatcher.cpp
+    Created: 19/10/2026 15:48:20
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "LibraryWatcher.h"
+
+#include <JuceHeader.h>
+
+#include <fstream>
+#include <limits>
+
+#include "Log.h"
+#include "TrackAnalyser.h"
+#include "Tracer.h"
+
+#if JUCE_LINUX
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+const char* const stateFileName = "watchState.csv";
+const char* const rootsFileName = "watchedFolders.txt";
+
+// strips the next comma-separated field off the front of line
+juce::String takeField(juce::String& line) {
+        const juce::String field = line.upToFirstOccurrenceOf(",", false, false);
+        line = line.fromFirstOccurrenceOf(",", false, false);
+        return field;
+}
+}        // namespace
+
+//==============================================================================
+LibraryWatcher::LibraryWatcher(juce::AudioFormatManager& _formatManager)
+    : juce::Thread("Library watcher"), formatManager(_formatManager) {}
+
+LibraryWatcher::~LibraryWatcher() {
+        stop();
+        cancelPendingUpdate();
+}
+
+void LibraryWatcher::setListener(Listener* _listener) { listener = _listener; }
+
+void LibraryWatcher::start() {
+        {
+                const juce::ScopedLock sl(rootLock);
+                roots.clear();
+
+                std::ifstream rootsFile(rootsFileName);
+                std::string line;
+
+                while (getline(rootsFile, line)) {
+                        const juce::File root{juce::String(line).trim()};
+                        if (root.getFullPathName().isNotEmpty()) {
+                                roots.add(root);
+                        }
+                }
+        }
+
+        startThread();
+}
+
+void LibraryWatcher::stop() {
+        // a file that is being analysed is finished first
+        stopThread(10000);
+}
+
+void LibraryWatcher::addRoot(const juce::File& directory) {
+        const juce::ScopedLock sl(rootLock);
+
+        for (const juce::File& root : roots) {
+                if (directory == root || directory.isAChildOf(root)) {
+                        return;
+                }
+        }
+
+        roots.add(directory);
+        newRoots.add(directory);
+        saveRoots();
+        notify();
+}
+
+juce::Array<juce::File> LibraryWatcher::getRoots() const {
+        const juce::ScopedLock sl(rootLock);
+        return roots;
+}
+
+//==============================================================================
+void LibraryWatcher::run() {
+        loadState();
+        openNotifier();
+
+        bool fullScanDue = true;
+        juce::uint32 lastScan = 0;
+        juce::uint32 lastEvent = 0;
+
+        while (!threadShouldExit()) {
+                juce::Array<juce::File> rootsToScan;
+                {
+                        const juce::ScopedLock sl(rootLock);
+                        if (fullScanDue) {
+                                rootsToScan = roots;
+                                newRoots.clear();
+                        } else {
+                                rootsToScan.swapWith(newRoots);
+                        }
+                }
+                fullScanDue = false;
+
+                // a root that is missing (say, an unmounted drive) is skipped rather than reported as emptied
+                for (const juce::File& root : rootsToScan) {
+                        if (root.isDirectory()) {
+                                watchDirectoryTree(root);
+                                scanDirectory(root);
+                        }
+                }
+                if (!rootsToScan.isEmpty()) {
+                        lastScan = juce::Time::getMillisecondCounter();
+                }
+
+                if ((!dirtyFiles.empty() || !dirtyDirectories.empty()) &&
+                    juce::Time::getMillisecondCounter() - lastEvent >= (juce::uint32) settleTimeMs) {
+                        const std::set<juce::String> directories = std::move(dirtyDirectories);
+                        const std::set<juce::String> files = std::move(dirtyFiles);
+                        dirtyDirectories.clear();
+                        dirtyFiles.clear();
+
+                        for (const juce::String& path : directories) {
+                                const juce::File directory{path};
+                                if (directory.isDirectory()) {
+                                        watchDirectoryTree(directory);
+                                }
+                                scanDirectory(directory);
+                        }
+                        for (const juce::String& path : files) {
+                                if (threadShouldExit()) {
+                                        break;
+                                }
+                                checkFile(juce::File{path});
+                        }
+                }
+
+                if (snapshotChanged) {
+                        saveState();
+                        snapshotChanged = false;
+                }
+
+                if (notifierFd >= 0) {
+                        const size_t numDirty = dirtyFiles.size() + dirtyDirectories.size();
+
+                        if (!readNotifications(250)) {
+                                OTODECK_LOG(warning, "LibraryWatcher", "Change notifications overflowed, rescanning");
+                                fullScanDue = true;
+                        }
+                        if (dirtyFiles.size() + dirtyDirectories.size() != numDirty) {
+                                lastEvent = juce::Time::getMillisecondCounter();
+                        }
+                } else {
+                        wait(250);
+                        fullScanDue = juce::Time::getMillisecondCounter() - lastScan >= (juce::uint32) rescanIntervalMs;
+                }
+        }
+
+        closeNotifier();
+
+        if (snapshotChanged) {
+                saveState();
+                snapshotChanged = false;
+        }
+}
+
+void LibraryWatcher::handleAsyncUpdate() {
+        std::vector<Change> changes;
+        {
+                const juce::ScopedLock sl(changeLock);
+                changes.swap(pendingChanges);
+        }
+
+        if (listener != nullptr && !changes.empty()) {
+                listener->watchedFilesChanged(changes);
+        }
+}
+
+//==============================================================================
+void LibraryWatcher::checkFile(const juce::File& file) {
+        const juce::String path = file.getFullPathName();
+        auto known = snapshot.find(path);
+
+        if (!file.existsAsFile() || !isAudioFile(file)) {
+                if (known != snapshot.end()) {
+                        snapshot.erase(known);
+                        snapshotChanged = true;
+
+                        Change change;
+                        change.file = file;
+                        change.removed = true;
+                        post(change);
+                }
+                return;
+        }
+
+        FileState state;
+        state.size = file.getSize();
+        state.modificationTime = file.getLastModificationTime().toMilliseconds();
+
+        if (known != snapshot.end() && known->second.size == state.size &&
+            known->second.modificationTime == state.modificationTime) {
+                return;
+        }
+
+        state.hash = hashFile(file);
+
+        // touched but not rewritten, only the timestamp needs updating
+        if (known != snapshot.end() && known->second.size == state.size && known->second.hash == state.hash) {
+                known->second = state;
+                snapshotChanged = true;
+                return;
+        }
+
+        processFile(file, state);
+}
+
+void LibraryWatcher::scanDirectory(const juce::File& directory) {
+        std::set<juce::String> seen;
+
+        for (const juce::DirectoryEntry& entry : juce::RangedDirectoryIterator(directory, true)) {
+                if (threadShouldExit()) {
+                        // an interrupted scan says nothing about which files are gone
+                        return;
+                }
+
+                const juce::File file = entry.getFile();
+                if (isAudioFile(file)) {
+                        seen.insert(file.getFullPathName());
+                        checkFile(file);
+                }
+        }
+
+        std::vector<juce::File> gone;
+        const juce::String prefix = directory.getFullPathName() + juce::File::getSeparatorString();
+
+        for (auto it = snapshot.lower_bound(prefix); it != snapshot.end() && it->first.startsWith(prefix); ++it) {
+                if (seen.count(it->first) == 0) {
+                        gone.push_back(juce::File{it->first});
+                }
+        }
+        for (const juce::File& file : gone) {
+                checkFile(file);
+        }
+}
+
+void LibraryWatcher::processFile(const juce::File& file, const FileState& state) {
+        OTODECK_TRACE_SCOPE("Watched file");
+        snapshot[file.getFullPathName()] = state;
+        snapshotChanged = true;
+
+        Change change;
+        change.file = file;
+        {
+                std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+                if (reader == nullptr || reader->sampleRate <= 0) {
+                        // remembered anyway, so an unreadable file is not retried on every scan
+                        OTODECK_LOG(warning, "LibraryWatcher", "Cannot read " << file.getFullPathName());
+                        return;
+                }
+                change.lengthSeconds = (float) (reader->lengthInSamples / reader->sampleRate);
+        }
+
+        std::shared_ptr<const TrackAnalysis> analysis = TrackAnalyser::analyseFile(file, formatManager);
+        change.bpm = analysis != nullptr && analysis->beatGrid.isValid() ? (float) analysis->beatGrid.bpm
+                                                                         : std::numeric_limits<float>::quiet_NaN();
+        change.loudnessLufs = analysis != nullptr ? analysis->loudnessLufs : std::numeric_limits<float>::quiet_NaN();
+
+        OTODECK_LOG(debug, "LibraryWatcher", "Processed " << file.getFullPathName());
+        post(change);
+}
+
+void LibraryWatcher::post(Change change) {
+        {
+                const juce::ScopedLock sl(changeLock);
+                pendingChanges.push_back(std::move(change));
+        }
+        triggerAsyncUpdate();
+}
+
+bool LibraryWatcher::isAudioFile(const juce::File& file) const {
+        return formatManager.findFormatForFileExtension(file.getFileExtension()) != nullptr;
+}
+
+juce::uint64 LibraryWatcher::hashFile(const juce::File& file) {
+        // FNV-1a over the first and last 64 KB, enough to tell a re-encode or retag from a touch
+        constexpr int chunkSize = 64 * 1024;
+        juce::uint64 hash = 14695981039346656037ull;
+
+        juce::FileInputStream stream(file);
+        if (!stream.openedOk()) {
+                return hash;
+        }
+
+        juce::HeapBlock<juce::uint8> chunk(chunkSize);
+        auto hashChunk = [&] {
+                const int numRead = stream.read(chunk.get(), chunkSize);
+                for (int i = 0; i < numRead; ++i) {
+                        hash = (hash ^ chunk[i]) * 1099511628211ull;
+                }
+        };
+
+        hashChunk();
+        if (stream.getTotalLength() > chunkSize) {
+                stream.setPosition(juce::jmax<juce::int64>(chunkSize, stream.getTotalLength() - chunkSize));
+                hashChunk();
+        }
+        return hash;
+}
+
+//==============================================================================
+void LibraryWatcher::loadState() {
+        // size,modification time,hash,path - the path goes last as it may contain commas
+        std::ifstream stateFile(stateFileName);
+        std::string line;
+
+        snapshot.clear();
+
+        while (getline(stateFile, line)) {
+                juce::String rest{line};
+                FileState state;
+                state.size = takeField(rest).getLargeIntValue();
+                state.modificationTime = takeField(rest).getLargeIntValue();
+                state.hash = (juce::uint64) takeField(rest).getHexValue64();
+
+                if (rest.isNotEmpty()) {
+                        snapshot[rest] = state;
+                }
+        }
+}
+
+void LibraryWatcher::saveState() const {
+        std::ofstream stateFile(stateFileName);
+
+        for (const auto& [path, state] : snapshot) {
+                stateFile << state.size << "," << state.modificationTime << ","
+                          << juce::String::toHexString((juce::int64) state.hash) << "," << path << "\n";
+        }
+}
+
+void LibraryWatcher::saveRoots() const {
+        std::ofstream rootsFile(rootsFileName);
+
+        for (const juce::File& root : roots) {
+                rootsFile << root.getFullPathName() << "\n";
+        }
+}
+
+//==============================================================================
+#if JUCE_LINUX
+bool LibraryWatcher::openNotifier() {
+        notifierFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        return notifierFd >= 0;
+}
+
+void LibraryWatcher::closeNotifier() {
+        if (notifierFd >= 0) {
+                close(notifierFd);
+                notifierFd = -1;
+        }
+        watches.clear();
+}
+
+void LibraryWatcher::watchDirectoryTree(const juce::File& directory) {
+        // inotify is not recursive, every directory needs its own watch
+        auto addWatch = [this](const juce::File& dir) {
+                const int wd = inotify_add_watch(notifierFd, dir.getFullPathName().toRawUTF8(),
+                                                 IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE |
+                                                     IN_ONLYDIR);
+                if (wd < 0) {
+                        // usually the per-user watch limit, fall back to periodic rescans
+                        OTODECK_LOG(warning, "LibraryWatcher",
+                                    "Cannot watch " << dir.getFullPathName() << ", rescanning periodically");
+                        closeNotifier();
+                        return false;
+                }
+                watches[wd] = dir;
+                return true;
+        };
+
+        if (notifierFd < 0 || !addWatch(directory)) {
+                return;
+        }
+
+        for (const juce::DirectoryEntry& entry :
+             juce::RangedDirectoryIterator(directory, true, "*", juce::File::findDirectories)) {
+                if (threadShouldExit() || !addWatch(entry.getFile())) {
+                        return;
+                }
+        }
+}
+
+bool LibraryWatcher::readNotifications(int timeoutMs) {
+        pollfd pfd{notifierFd, POLLIN, 0};
+
+        if (poll(&pfd, 1, timeoutMs) <= 0) {
+                return true;
+        }
+
+        alignas(inotify_event) char buffer[16 * 1024];
+        bool complete = true;
+
+        for (;;) {
+                const ssize_t length = read(notifierFd, buffer, sizeof(buffer));
+                if (length <= 0) {
+                        break;
+                }
+
+                for (const char* p = buffer; p < buffer + length;) {
+                        const auto* event = reinterpret_cast<const inotify_event*>(p);
+                        p += sizeof(inotify_event) + event->len;
+
+                        if (event->mask & IN_Q_OVERFLOW) {
+                                complete = false;
+                                continue;
+                        }
+
+                        auto watch = watches.find(event->wd);
+                        if (watch == watches.end()) {
+                                continue;
+                        }
+                        if (event->mask & IN_IGNORED) {
+                                watches.erase(watch);
+                                continue;
+                        }
+                        if (event->len == 0) {
+                                continue;
+                        }
+
+                        const juce::String path =
+                            watch->second.getChildFile(juce::String(juce::CharPointer_UTF8(event->name))).getFullPathName();
+
+                        // new files are picked up once they are closed after writing, not when created
+                        if (event->mask & IN_ISDIR) {
+                                dirtyDirectories.insert(path);
+                        } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)) {
+                                dirtyFiles.insert(path);
+                        }
+                }
+        }
+        return complete;
+}
+#else
+bool LibraryWatcher::openNotifier() { return false; }
+
+void LibraryWatcher::closeNotifier() {}
+
+void LibraryWatcher::watchDirectoryTree(const juce::File&) {}
+
+bool LibraryWatcher::readNotifications(int timeoutMs) {
+        wait(timeoutMs);
+        return true;
+}
+#endif
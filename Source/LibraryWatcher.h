@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    LibraryWatcher.h
+    Created: 19/10/2026 15:48:20
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+//==============================================================================
+/*
+ * LibraryWatcher keeps the library in step with a set of music root folders.
+ *
+ * A snapshot of every audio file seen (size, modification time and a hash of
+ * its first and last 64 KB) is kept on disk, so after a restart only files
+ * that are new, changed or gone are processed. While running, inotify reports
+ * changes as they happen on Linux; elsewhere, or when the kernel runs out of
+ * watches, the roots are rescanned periodically against the snapshot instead.
+ *
+ * New and changed files are probed and analysed on the watcher thread and the
+ * results are delivered to the listener in batches on the message thread.
+ */
+class LibraryWatcher : private juce::Thread, private juce::AsyncUpdater {
+       public:
+        struct Change {
+                juce::File file;
+                bool removed = false;
+                float lengthSeconds = 0.0f;
+                // NaN when the analysis failed
+                float bpm = 0.0f;
+                float loudnessLufs = 0.0f;
+        };
+
+        class Listener {
+               public:
+                virtual ~Listener() = default;
+                // message thread
+                virtual void watchedFilesChanged(const std::vector<Change>& changes) = 0;
+        };
+
+        explicit LibraryWatcher(juce::AudioFormatManager& formatManager);
+        ~LibraryWatcher() override;
+
+        void setListener(Listener* listener);
+
+        // restores the saved roots and starts watching them
+        void start();
+        void stop();
+
+        // saved straight away and scanned on the watcher thread
+        void addRoot(const juce::File& directory);
+        juce::Array<juce::File> getRoots() const;
+
+       private:
+        struct FileState {
+                juce::int64 size = 0;
+                juce::int64 modificationTime = 0;
+                juce::uint64 hash = 0;
+        };
+
+        void run() override;
+        void handleAsyncUpdate() override;
+
+        // compares one file against the snapshot and processes it if it changed or disappeared
+        void checkFile(const juce::File& file);
+        // checks every audio file below the directory, and reports snapshot entries below it that are gone
+        void scanDirectory(const juce::File& directory);
+        void processFile(const juce::File& file, const FileState& state);
+        void post(Change change);
+
+        bool isAudioFile(const juce::File& file) const;
+        static juce::uint64 hashFile(const juce::File& file);
+
+        void loadState();
+        void saveState() const;
+        void saveRoots() const;
+
+        // kernel change notifications, all no-ops where inotify is unavailable
+        bool openNotifier();
+        void closeNotifier();
+        void watchDirectoryTree(const juce::File& directory);
+        // waits up to timeoutMs and collects changed paths; returns false if events were lost
+        bool readNotifications(int timeoutMs);
+
+        // how often roots are rescanned when there are no change notifications
+        static constexpr int rescanIntervalMs = 60 * 1000;
+        // changed paths are processed once nothing has happened for this long
+        static constexpr int settleTimeMs = 1000;
+
+        juce::AudioFormatManager& formatManager;
+        Listener* listener = nullptr;
+
+        juce::CriticalSection rootLock;
+        juce::Array<juce::File> roots;
+        juce::Array<juce::File> newRoots;
+
+        // watcher thread only
+        std::map<juce::String, FileState> snapshot;
+        bool snapshotChanged = false;
+        std::set<juce::String> dirtyFiles;
+        std::set<juce::String> dirtyDirectories;
+        int notifierFd = -1;
+        std::map<int, juce::File> watches;
+
+        juce::CriticalSection changeLock;
+        std::vector<Change> pendingChanges;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LibraryWatcher)
+};
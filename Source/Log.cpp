@@ -0,0 +1,263 @@
+/*
+  ==============================================================================
+
+    Log.cpp
+    Created: 20/10/2026 00:41:27
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "Log.h"
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "ThreadSlots.h"
+
+namespace {
+// a burst of a few hundred messages between two drains
+constexpr int messagesPerThread = 512;
+constexpr int maxMessageBytes = 176;
+constexpr int drainIntervalMs = 20;
+
+struct Message {
+        juce::int64 ticks;
+        Log::Level level;
+        const char* category;
+        // set by writeValue, joined with value by the sink
+        const char* text;
+        double value;
+        int suppressed;
+        char message[maxMessageBytes];
+};
+
+// single producer, the owning thread, and single consumer, the sink
+struct ThreadQueue {
+        std::atomic<juce::uint64> written;
+        std::atomic<juce::uint64> read;
+        std::atomic<juce::uint64> dropped;
+        Message messages[messagesPerThread];
+};
+
+// one per thread slot, static and zero-initialised, so logging never allocates and unused queues cost nothing
+ThreadQueue queues[ThreadSlots::maxSlots];
+
+// messages from threads that found every slot taken
+std::atomic<juce::uint64> unqueuedMessages{0};
+
+// timestamps are seconds from static initialisation, in practice from launch
+const juce::int64 origin = juce::Time::getHighResolutionTicks();
+
+#if JUCE_DEBUG
+std::atomic<int> minimumLevel{(int) Log::Level::debug};
+#else
+std::atomic<int> minimumLevel{(int) Log::Level::info};
+#endif
+
+// the slot for the next message, nullptr if the queue is full
+Message* beginMessage(Log::Level level, const char* category, int suppressed) noexcept {
+        const int slot = ThreadSlots::getSlot();
+        if (slot < 0) {
+                unqueuedMessages.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+        }
+        ThreadQueue* queue = &queues[slot];
+
+        const juce::uint64 written = queue->written.load(std::memory_order_relaxed);
+        if (written - queue->read.load(std::memory_order_acquire) >= (juce::uint64) messagesPerThread) {
+                queue->dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+        }
+
+        Message& message = queue->messages[written % messagesPerThread];
+        message.ticks = juce::Time::getHighResolutionTicks();
+        message.level = level;
+        message.category = category;
+        message.text = nullptr;
+        message.value = 0.0;
+        message.suppressed = suppressed;
+        message.message[0] = 0;
+        return &message;
+}
+
+// only after beginMessage() returned a message, so the thread has its slot
+void endMessage() noexcept {
+        ThreadQueue& queue = queues[ThreadSlots::getSlot()];
+        queue.written.store(queue.written.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+const char* getLevelName(Log::Level level) {
+        switch (level) {
+                case Log::Level::debug:
+                        return "DEBUG";
+                case Log::Level::warning:
+                        return "WARN ";
+                case Log::Level::error:
+                        return "ERROR";
+                case Log::Level::info:
+                default:
+                        return "INFO ";
+        }
+}
+
+//==============================================================================
+class Sink : public juce::Thread {
+       public:
+        Sink() : juce::Thread("Log sink") {
+                const juce::File file = juce::File::getCurrentWorkingDirectory().getChildFile("otodeck.log");
+                file.deleteFile();
+                stream = file.createOutputStream();
+        }
+
+        ~Sink() override {
+                stopThread(2000);
+                drain();
+        }
+
+        void run() override {
+                while (!threadShouldExit()) {
+                        drain();
+                        wait(drainIntervalMs);
+                }
+        }
+
+        // also called after the thread has stopped, never by two threads at once
+        void drain() {
+                pending.clear();
+                juce::String dropNotes;
+                const int numThreads = ThreadSlots::getNumUsedSlots();
+
+                for (int thread = 0; thread < numThreads; ++thread) {
+                        ThreadQueue& queue = queues[thread];
+
+                        const juce::uint64 read = queue.read.load(std::memory_order_relaxed);
+                        const juce::uint64 written = queue.written.load(std::memory_order_acquire);
+
+                        for (juce::uint64 index = read; index < written; ++index) {
+                                const Message& message = queue.messages[index % messagesPerThread];
+                                pending.push_back({message.ticks, format(message, thread)});
+                        }
+                        queue.read.store(written, std::memory_order_release);
+
+                        if (const juce::uint64 dropped = queue.dropped.exchange(0, std::memory_order_relaxed)) {
+                                dropNotes << "Log: " << (juce::int64) dropped << " messages dropped on "
+                                          << getThreadName(thread) << "\n";
+                        }
+                }
+
+                if (const juce::uint64 unqueued = unqueuedMessages.exchange(0, std::memory_order_relaxed)) {
+                        dropNotes << "Log: " << (juce::int64) unqueued << " messages lost, "
+                                  << ThreadSlots::getThreadsWithoutSlot() << " threads have no free log queue\n";
+                }
+
+                if (pending.empty() && dropNotes.isEmpty()) {
+                        return;
+                }
+
+                // each queue is already in order, so a stable sort on time merges them
+                std::stable_sort(pending.begin(), pending.end(),
+                                 [](const Line& a, const Line& b) { return a.ticks < b.ticks; });
+
+                juce::String text;
+                for (const Line& line : pending) {
+                        text << line.text << "\n";
+                }
+                text << dropNotes;
+
+                // one write and one flush per drain
+                std::cout << text << std::flush;
+                if (stream != nullptr) {
+                        stream->writeText(text, false, false, nullptr);
+                        stream->flush();
+                }
+        }
+
+       private:
+        struct Line {
+                juce::int64 ticks;
+                juce::String text;
+        };
+
+        static juce::String getThreadName(int thread) {
+                char threadName[48];
+                if (!ThreadSlots::getThreadName(thread, threadName, sizeof(threadName))) {
+                        return "Thread " + juce::String(thread);
+                }
+                return juce::String::fromUTF8(threadName);
+        }
+
+        juce::String format(const Message& message, int thread) {
+                juce::String line;
+                line << juce::String(juce::Time::highResolutionTicksToSeconds(message.ticks - origin), 3) << " "
+                     << getLevelName(message.level) << " [" << getThreadName(thread) << "] " << message.category
+                     << ": ";
+
+                if (message.text != nullptr) {
+                        line << message.text << " " << message.value;
+                } else {
+                        line << juce::String::fromUTF8(message.message);
+                }
+
+                if (message.suppressed > 0) {
+                        line << " (" << message.suppressed << " similar held back)";
+                }
+                return line;
+        }
+
+        std::unique_ptr<juce::FileOutputStream> stream;
+        std::vector<Line> pending;
+};
+
+std::unique_ptr<Sink> sink;
+}        // namespace
+
+//==============================================================================
+bool Log::RateLimit::tryAcquire() noexcept {
+        const juce::uint32 now = juce::Time::getMillisecondCounter() / 1000;
+        juce::uint32 current = second.load(std::memory_order_relaxed);
+
+        if (current != now && second.compare_exchange_strong(current, now, std::memory_order_relaxed)) {
+                sentThisSecond.store(0, std::memory_order_relaxed);
+        }
+
+        if (sentThisSecond.fetch_add(1, std::memory_order_relaxed) < perSecond) {
+                return true;
+        }
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+}
+
+int Log::RateLimit::takeSuppressed() noexcept { return suppressed.exchange(0, std::memory_order_relaxed); }
+
+void Log::setLevel(Level level) noexcept { minimumLevel.store((int) level, std::memory_order_relaxed); }
+
+bool Log::isEnabled(Level level) noexcept { return (int) level >= minimumLevel.load(std::memory_order_relaxed); }
+
+void Log::write(Level level, const char* category, const juce::String& message, int suppressed) noexcept {
+        if (Message* slot = beginMessage(level, category, suppressed)) {
+                message.copyToUTF8(slot->message, maxMessageBytes);
+                endMessage();
+        }
+}
+
+void Log::writeValue(Level level, const char* category, const char* text, double value, int suppressed) noexcept {
+        if (Message* slot = beginMessage(level, category, suppressed)) {
+                slot->text = text;
+                slot->value = value;
+                endMessage();
+        }
+}
+
+void Log::start() {
+        if (sink == nullptr) {
+                sink.reset(new Sink());
+                sink->startThread();
+        }
+}
+
+void Log::stop() { sink = nullptr; }
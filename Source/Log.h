@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    Log.h
+    Created: 20/10/2026 00:41:27
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+
+//==============================================================================
+/*
+ * Asynchronous logging for every thread, the audio thread included.
+ *
+ * A message is a level, a category, a timestamp, the thread and its text,
+ * kept apart until the sink writes them out. Each thread that logs takes one
+ * of a fixed set of statically allocated queues on its first message, and
+ * logging is a copy into that queue: no lock, no flush and no system call.
+ * A background sink drains the queues every 20 ms, in time order, to stdout
+ * and to otodeck.log in the working directory. A full queue drops messages
+ * and the sink reports how many. A thread gives its queue back when it
+ * exits; one that finds none free loses its messages, and the sink reports
+ * those too.
+ *
+ * Use the macros rather than the functions. Messages below the current level
+ * cost one atomic load and are never formatted, and each call site is capped
+ * at a number of messages per second; what it holds back is counted on the
+ * next message that goes out.
+ *
+ * OTODECK_LOG formats with juce::String, which allocates, so on the audio
+ * thread use OTODECK_LOG_VALUE: a string literal and a number, joined by the
+ * sink.
+ */
+namespace Log {
+enum class Level { debug, info, warning, error };
+
+// debug in debug builds and info otherwise until set
+void setLevel(Level level) noexcept;
+bool isEnabled(Level level) noexcept;
+
+// one per call site, constant-initialised so a static one never needs a guard
+class RateLimit {
+       public:
+        explicit constexpr RateLimit(int _perSecond) noexcept : perSecond(_perSecond) {}
+
+        // false once the call site has had its messages for this second
+        bool tryAcquire() noexcept;
+        // messages held back since the last one that went out
+        int takeSuppressed() noexcept;
+
+       private:
+        const int perSecond;
+        std::atomic<juce::uint32> second{0};
+        std::atomic<int> sentThisSecond{0};
+        std::atomic<int> suppressed{0};
+};
+
+constexpr int defaultRatePerSecond = 20;
+
+// category must outlive the log, in practice a string literal; long messages are truncated
+void write(Level level, const char* category, const juce::String& message, int suppressed = 0) noexcept;
+// the audio thread's form: nothing is formatted until the sink writes it
+void writeValue(Level level, const char* category, const char* text, double value, int suppressed = 0) noexcept;
+
+// message thread; messages logged before start() wait in the queues
+void start();
+// writes out whatever is still queued, then stops the sink
+void stop();
+}        // namespace Log
+
+#define OTODECK_LOG(level, category, expression)                                                               \
+        do {                                                                                                   \
+                if (Log::isEnabled(Log::Level::level)) {                                                       \
+                        static Log::RateLimit logRateLimit{Log::defaultRatePerSecond};                        \
+                        if (logRateLimit.tryAcquire()) {                                                       \
+                                juce::String logMessage;                                                       \
+                                logMessage << expression;                                                      \
+                                Log::write(Log::Level::level, category, logMessage,                            \
+                                           logRateLimit.takeSuppressed());                                     \
+                        }                                                                                      \
+                }                                                                                              \
+        } while (false)
+
+#define OTODECK_LOG_VALUE(level, category, text, value)                                                        \
+        do {                                                                                                   \
+                if (Log::isEnabled(Log::Level::level)) {                                                       \
+                        static Log::RateLimit logRateLimit{Log::defaultRatePerSecond};                        \
+                        if (logRateLimit.tryAcquire()) {                                                       \
+                                Log::writeValue(Log::Level::level, category, text, (double) (value),           \
+                                                logRateLimit.takeSuppressed());                                \
+                        }                                                                                      \
+                }                                                                                              \
+        } while (false)
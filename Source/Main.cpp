@@ -8,7 +8,14 @@
 
 #include <JuceHeader.h>
 #include <memory>
+#include "GoldenRender.h"
+#include "KeyLockBenchmark.h"
+#include "LibraryBenchmark.h"
+#include "Log.h"
 #include "MainComponent.h"
+#include "SoakHarness.h"
+#include "StartupMetrics.h"
+#include "SyncDriftTest.h"
 
 //==============================================================================
 class OtoDeckApplication : public juce::JUCEApplication {
@@ -22,6 +29,27 @@ class OtoDeckApplication : public juce::JUCEApplication {
 
         //==============================================================================
         void initialise(const juce::String& commandLine) override {
+                // startup timings are measured from here
+                StartupMetrics::markLaunch();
+                Log::start();
+
+                // offline regression runs and benchmarks, no window and no audio device
+                int exitCode = 0;
+                if (GoldenRender::runFromCommandLine(commandLine, exitCode) ||
+                    SyncDriftTest::runFromCommandLine(commandLine, exitCode) ||
+                    LibraryBenchmark::runFromCommandLine(commandLine, exitCode) ||
+                    KeyLockBenchmark::runFromCommandLine(commandLine, exitCode)) {
+                        setApplicationReturnValue(exitCode);
+                        quit();
+                        return;
+                }
+
+                // headless stress run, quits with the number of failed checks when it is done
+                soakHarness = SoakHarness::createFromCommandLine(commandLine);
+                if (soakHarness != nullptr) {
+                        return;
+                }
+
                 // This method is where you should put your application's initialisation
                 // code..
                 mainWindow.reset(new MainWindow(getApplicationName()));
@@ -31,6 +59,8 @@ class OtoDeckApplication : public juce::JUCEApplication {
                 // Add your application's shutdown code here..
 
                 mainWindow = nullptr;        // (deletes our window)
+                soakHarness = nullptr;
+                Log::stop();
         }
 
         //==============================================================================
@@ -92,6 +122,7 @@ class OtoDeckApplication : public juce::JUCEApplication {
 
        private:
         std::unique_ptr<MainWindow> mainWindow;
+        std::unique_ptr<SoakHarness> soakHarness;
 };
 
 //==============================================================================
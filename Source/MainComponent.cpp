@@ -4,54 +4,351 @@
 
 //==============================================================================
 MainComponent::MainComponent(){
+        // register formats once, before anything can be loaded
+        formatManager.registerBasicFormats();
+
         setSize(600, 400);
 
-        setAudioChannels(0, 2);
+        // restores the buffer size found by the last calibration, if any; outputs 3 and 4, where the device has
+        // them, are the cue bus for previews
+        setAudioChannels(0, 4, BufferSizeTuner::loadSavedState().get());
 
-        addAndMakeVisible(assemblePane1);
-        addAndMakeVisible(assemblePane2);
+        addAndMakeVisible(masterMeterDisplay);
 
-        addAndMakeVisible(playlistComponent);
+        addAndMakeVisible(recordButton);
+        recordButton.setClickingTogglesState(true);
+        recordButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::red);
+        recordButton.onClick = [this] { toggleRecording(); };
 
-        formatManager.registerBasicFormats();
+        addAndMakeVisible(recordFormatBox);
+        recordFormatBox.addItem("WAV", 1);
+        recordFormatBox.addItem("FLAC", 2);
+        recordFormatBox.setSelectedId(1, juce::dontSendNotification);
+
+        addAndMakeVisible(tuneButton);
+        tuneButton.onClick = [this] {
+                if (bufferSizeTuner.isRunning()) {
+                        bufferSizeTuner.cancel();
+                } else {
+                        bufferSizeTuner.start();
+                }
+        };
+
+        addAndMakeVisible(traceButton);
+        traceButton.onClick = [this] { exportTrace(); };
+
+        // item ids are the learn targets plus one; the box clears itself once the control has moved
+        for (int target = 0; target < MidiController::numTargets; ++target) {
+                midiLearnBox.addItem(MidiController::getTargetName(target), target + 1);
+        }
+        midiLearnBox.setTextWhenNothingSelected("MIDI learn");
+        midiLearnBox.onChange = [this] {
+                if (decks != nullptr) {
+                        decks->midiController.learn(midiLearnBox.getSelectedId() - 1);
+                }
+        };
+        addAndMakeVisible(midiLearnBox);
+
+        addAndMakeVisible(statusLabel);
+        statusLabel.setFont(juce::Font(12.0f));
+        statusLabel.setColour(juce::Label::textColourId, juce::Colours::navajowhite);
+
+        memoryGovernor.addClient(&decodedAudioCache);
+        memoryGovernor.addClient(&trackAnalyser);
+        memoryGovernor.addClient(&thumbnailCache);
+        startTimer(1000);
+}
+
+MainComponent::~MainComponent() {
+        stopTimer();
+        shutdownAudio();
+        memoryGovernor.removeClient(&decodedAudioCache);
+        memoryGovernor.removeClient(&trackAnalyser);
+        memoryGovernor.removeClient(&thumbnailCache);
+}
+
+MainComponent::Decks::Decks(MainComponent& _owner) : owner(_owner) {}
+
+void MainComponent::createDecks() {
+        OTODECK_TRACE_SCOPE("Create decks");
+        decks = std::make_unique<Decks>(*this);
+
+        addAndMakeVisible(decks->assemblePane1);
+        addAndMakeVisible(decks->assemblePane2);
+        addAndMakeVisible(decks->playlistComponent);
+        decks->midiController.start();
+
+        // a device that is already running gets them prepared here, later restarts go through prepareToPlay
+        if (deviceSampleRate > 0.0) {
+                prepareDecks(*decks);
+                liveDecks.store(decks.get(), std::memory_order_release);
+                mixerSource.addInputSource(&decks->autoDJ.getDeckOutput(0), false);
+                mixerSource.addInputSource(&decks->autoDJ.getDeckOutput(1), false);
+        }
+        resized();
 }
 
-MainComponent::~MainComponent() { shutdownAudio(); }
+void MainComponent::prepareDecks(Decks& toPrepare) {
+        toPrepare.player1.prepareToPlay(deviceBlockSize, deviceSampleRate);
+        toPrepare.player2.prepareToPlay(deviceBlockSize, deviceSampleRate);
+
+        // blocks are heard after the device buffer and its reported output latency
+        if (auto* device = deviceManager.getCurrentAudioDevice()) {
+                const double latency =
+                    (device->getOutputLatencyInSamples() + device->getCurrentBufferSizeSamples()) / deviceSampleRate;
+                toPrepare.player1.setOutputLatency(latency);
+                toPrepare.player2.setOutputLatency(latency);
+        }
+
+        toPrepare.beatSync.prepare(deviceSampleRate);
+        toPrepare.autoDJ.prepare(deviceSampleRate);
+        toPrepare.midiController.prepare(deviceSampleRate);
+}
 
 //==============================================================================
 void MainComponent::paint(juce::Graphics& g) {
+        StartupMetrics::markFirstFrame();
+
+        // the decks are built once this frame is on screen
+        if (!decksRequested) {
+                decksRequested = true;
+                juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<MainComponent>(this)] {
+                        if (safeThis != nullptr) {
+                                safeThis->createDecks();
+                        }
+                });
+        }
+
         g.fillAll(juce::Colour{12, 15, 88});
         g.setColour(juce::Colours::navajowhite);
 }
 
 void MainComponent::resized() {
-        int rowH = getHeight() / 4;
+        int statusH = 20;
+        int rowH = (getHeight() - statusH) / 4;
 
-        assemblePane1.setBounds(0, 0, getWidth() / 2, rowH * 3);
-        assemblePane2.setBounds(assemblePane1.getBounds().getRight(), 0, getWidth() / 2, rowH * 3);
-        playlistComponent.setBounds(5, assemblePane2.getBounds().getBottom(), getWidth() - 10, rowH);
+        // the same layout before the decks exist, with their space left empty
+        masterMeterDisplay.setBounds(5, rowH * 3, getWidth() - 10, 24);
+        recordButton.setBounds(5, masterMeterDisplay.getBounds().getBottom() + rowH - 24, 50, statusH);
+        if (decks != nullptr) {
+                decks->assemblePane1.setBounds(0, 0, getWidth() / 2, rowH * 3);
+                decks->assemblePane2.setBounds(decks->assemblePane1.getBounds().getRight(), 0, getWidth() / 2,
+                                               rowH * 3);
+                decks->playlistComponent.setBounds(5, masterMeterDisplay.getBounds().getBottom(), getWidth() - 10,
+                                                   rowH - 24);
+        }
+        recordFormatBox.setBounds(recordButton.getBounds().getRight() + 5, recordButton.getY(), 70, statusH);
+        tuneButton.setBounds(recordFormatBox.getBounds().getRight() + 5, recordButton.getY(), 50, statusH);
+        midiLearnBox.setBounds(tuneButton.getBounds().getRight() + 5, recordButton.getY(), 110, statusH);
+        traceButton.setBounds(midiLearnBox.getBounds().getRight() + 5, recordButton.getY(), 50, statusH);
+        statusLabel.setBounds(traceButton.getBounds().getRight() + 5, recordButton.getY(),
+                              getWidth() - traceButton.getBounds().getRight() - 10, statusH);
+}
+
+void MainComponent::timerCallback() {
+        OTODECK_TRACE_SCOPE("Main timer");
+        memoryGovernor.enforceBudget();
+        StartupMetrics::recordWhenComplete();
+
+        if (midiLearnBox.getSelectedId() > 0 && (decks == nullptr || !decks->midiController.isLearning())) {
+                midiLearnBox.setSelectedId(0, juce::dontSendNotification);
+        }
+
+        juce::String status = memoryGovernor.getUsageSummary();
+        status << "  |  " << bufferSizeTuner.getStatusText();
+
+        if (decks != nullptr) {
+                appendDeckStatus(status);
+        }
+
+#if OTODECK_RT_SAFETY_CHECKS
+        status << "  |  RT violations " << juce::String(RealtimeSafety::getViolationCount());
+#endif
+
+        if (masterRecorder.isRecording()) {
+                status << "  |  REC " << juce::String(masterRecorder.getRecordedSeconds(), 0) << " s, buffer "
+                       << juce::roundToInt(masterRecorder.getFifoFill() * 100.0f) << "%, dropped "
+                       << masterRecorder.getDroppedSamples();
+        }
+
+        if (StartupMetrics::getSummary().isNotEmpty()) {
+                status << "  |  " << StartupMetrics::getSummary();
+        }
+
+        statusLabel.setText(status, juce::dontSendNotification);
+}
+
+void MainComponent::appendDeckStatus(juce::String& status) const {
+        if (decks->midiController.getLatencySummary().isNotEmpty()) {
+                status << "  |  " << decks->midiController.getLatencySummary();
+        }
+
+        if (decks->autoDJ.getStatusText().isNotEmpty()) {
+                status << "  |  " << decks->autoDJ.getStatusText();
+        }
+
+        for (int deck = 0; deck < 2; ++deck) {
+                if (decks->beatSync.isFollowing(deck)) {
+                        status << "  |  " << (deck == 0 ? "Left" : "Right") << " sync drift "
+                               << juce::String(decks->beatSync.getPhaseErrorMs(deck), 2) << " ms";
+                }
+        }
+
+        // key lock cost, and how many decks at that cost one core could run
+        const AudioPlayer* players[] = {&decks->player1, &decks->player2};
+        for (int deck = 0; deck < 2; ++deck) {
+                const float load = players[deck]->getKeyLockCpuLoad();
+                if (players[deck]->isKeyLockEnabled() && load > 0.0f) {
+                        status << "  |  " << (deck == 0 ? "Left" : "Right") << " key lock "
+                               << juce::String(load * 100.0f, 1) << "% (" << (int) (1.0f / load) << " decks/core)";
+                }
+        }
+
+        for (int deck = 0; deck < 2; ++deck) {
+                if (players[deck]->isLoopActive()) {
+                        status << "  |  " << (deck == 0 ? "Left" : "Right") << " loop engaged in "
+                               << juce::String(players[deck]->getLoopLatencyMs(), 1) << " ms";
+                }
+        }
+}
+
+void MainComponent::exportTrace() {
+        // the buffers keep the last few seconds of every thread, so this is pressed just after a glitch
+        const juce::File file = juce::File::getCurrentWorkingDirectory()
+                                    .getChildFile("traces")
+                                    .getChildFile("trace-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") +
+                                                  ".json");
+
+        if (Tracer::exportJson(file)) {
+                OTODECK_LOG(info, "MainComponent", "Trace written to " << file.getFullPathName());
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::AlertIconType::InfoIcon, "Trace",
+                                                       "Written to " + file.getFullPathName() +
+                                                           "\nOpen it in ui.perfetto.dev or chrome://tracing.",
+                                                       "OK", nullptr);
+        } else {
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::AlertIconType::WarningIcon, "Trace",
+                                                       "No trace was written (tracing is off or nothing was recorded).",
+                                                       "OK", nullptr);
+        }
+}
+
+void MainComponent::toggleRecording() {
+        if (!recordButton.getToggleState()) {
+                masterRecorder.stopRecording();
+                return;
+        }
+
+        const auto format = recordFormatBox.getSelectedId() == 2 ? MasterRecorder::Format::flac
+                                                                 : MasterRecorder::Format::wav;
+        const juce::File file =
+            juce::File::getSpecialLocation(juce::File::userMusicDirectory)
+                .getChildFile("OtoDeck")
+                .getNonexistentChildFile("mix-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S"),
+                                         MasterRecorder::getFileExtension(format));
+
+        if (!masterRecorder.startRecording(file, format)) {
+                recordButton.setToggleState(false, juce::dontSendNotification);
+        }
 }
 
 void MainComponent::releaseResources() {
+        // decks created while the device is stopped wait for the next prepareToPlay
+        deviceSampleRate = 0.0;
         mixerSource.removeAllInputs();
         mixerSource.releaseResources();
-        player1.releaseResources();
-        player2.releaseResources();
+        if (decks != nullptr) {
+                decks->player1.releaseResources();
+                decks->player2.releaseResources();
+        }
 }
 
 void MainComponent::prepareToPlay(int samplesPerBlockExpected, double sampleRate) {
-        player1.prepareToPlay(samplesPerBlockExpected, sampleRate);
-        player2.prepareToPlay(samplesPerBlockExpected, sampleRate);
+        deviceSampleRate = sampleRate;
+        deviceBlockSize = samplesPerBlockExpected;
+        lastCallbackTicks = 0;
 
+        bufferSizeTuner.prepare(samplesPerBlockExpected, sampleRate);
         mixerSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-        mixerSource.addInputSource(&player1, false);
-        mixerSource.addInputSource(&player2, false);
+        // a device restart ends the recording, so the button has to follow
+        const bool wasRecording = masterRecorder.isRecording();
+        masterRecorder.prepare(2, sampleRate);
+        if (wasRecording) {
+                juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<MainComponent>(this)] {
+                        if (safeThis != nullptr) {
+                                safeThis->recordButton.setToggleState(false, juce::dontSendNotification);
+                        }
+                });
+        }
+        masterMeter.prepare(sampleRate);
+        previewPlayer.prepare(sampleRate);
+
+        // before the first frame there are no decks yet, createDecks() prepares them
+        if (decks != nullptr) {
+                prepareDecks(*decks);
+                liveDecks.store(decks.get(), std::memory_order_release);
+                mixerSource.addInputSource(&decks->autoDJ.getDeckOutput(0), false);
+                mixerSource.addInputSource(&decks->autoDJ.getDeckOutput(1), false);
+        }
 }
 
 void MainComponent::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) {
+        // in a checking build, everything below is watched for allocations, locks and blocking calls
+        const RealtimeSafety::ScopedAudioThread realtimeScope;
+
         if (bufferToFill.buffer == nullptr) {
                 return;
         }
 
-        mixerSource.getNextAudioBlock(bufferToFill);
+        const juce::int64 callbackStart = juce::Time::getHighResolutionTicks();
+        StartupMetrics::markFirstAudio();
+        OTODECK_TRACE_SCOPE("Audio callback");
+
+        // a callback starting well over a period after the last one is where a glitch would be heard
+        if (lastCallbackTicks != 0 && deviceSampleRate > 0.0) {
+                const double gapSeconds = juce::Time::highResolutionTicksToSeconds(callbackStart - lastCallbackTicks);
+                if (gapSeconds > 1.5 * bufferToFill.numSamples / deviceSampleRate) {
+                        Tracer::mark("Late audio callback");
+                        OTODECK_LOG_VALUE(warning, "Audio", "Late callback, ms since the previous one:",
+                                          gapSeconds * 1000.0);
+                }
+        }
+        lastCallbackTicks = callbackStart;
+
+        if (Decks* live = liveDecks.load(std::memory_order_acquire)) {
+                // controller commands first, so a move is heard in the very block that picks it up
+                live->midiController.process(bufferToFill.numSamples);
+
+                // tempo and phase corrections are applied before the decks render this block
+                live->beatSync.process(bufferToFill.numSamples);
+                // schedules Auto DJ transitions in output samples, before the deck outputs are pulled
+                live->autoDJ.process(bufferToFill.numSamples);
+        }
+
+        // the master is the first two outputs, referenced in place without allocating
+        juce::AudioBuffer<float>& outputs = *bufferToFill.buffer;
+        juce::AudioBuffer<float> masterBus(outputs.getArrayOfWritePointers(), juce::jmin(2, outputs.getNumChannels()),
+                                           bufferToFill.startSample, bufferToFill.numSamples);
+        const juce::AudioSourceChannelInfo master(&masterBus, 0, bufferToFill.numSamples);
+
+        mixerSource.getNextAudioBlock(master);
+        masterMeter.process(masterBus, 0, bufferToFill.numSamples);
+
+        // only a copy into the recorder's FIFO, the disk is written from its own thread
+        masterRecorder.pushBlock(master);
+
+        // the preview goes to the cue bus, or without one joins the master after it has been measured and recorded
+        if (outputs.getNumChannels() >= 4) {
+                juce::AudioBuffer<float> cueBus(outputs.getArrayOfWritePointers() + 2, 2, bufferToFill.startSample,
+                                                bufferToFill.numSamples);
+                cueBus.clear();
+                previewPlayer.process(cueBus, 0, bufferToFill.numSamples);
+        } else {
+                previewPlayer.process(masterBus, 0, bufferToFill.numSamples);
+        }
+        for (int channel = 4; channel < outputs.getNumChannels(); ++channel) {
+                outputs.clear(channel, bufferToFill.startSample, bufferToFill.numSamples);
+        }
+
+        // calibration load and callback timing, a no-op unless the tuner is running
+        bufferSizeTuner.callbackFinished(callbackStart, bufferToFill.numSamples);
 }
@@ -2,8 +2,26 @@
 
 #include <JuceHeader.h>
 
+#include <atomic>
+#include <memory>
+
 #include "AudioPlayer.h"
+#include "AutoDJ.h"
+#include "BeatSync.h"
+#include "BufferSizeTuner.h"
+#include "DecodedAudioCache.h"
+#include "LevelMeterDisplay.h"
+#include "Log.h"
+#include "MasterRecorder.h"
+#include "MemoryGovernor.h"
+#include "MidiController.h"
 #include "PlaylistComponent.h"
+#include "PreviewPlayer.h"
+#include "RealtimeSafety.h"
+#include "StartupMetrics.h"
+#include "ThumbnailCacheClient.h"
+#include "Tracer.h"
+#include "TrackAnalyser.h"
 #include "juce_audio_formats/juce_audio_formats.h"
 #include "juce_audio_utils/juce_audio_utils.h"
 #include "juce_core/juce_core.h"
@@ -14,7 +32,7 @@
     This component lives inside our window, and this is where you should put all
     your controls and content.
 */
-class MainComponent : public juce::AudioAppComponent {
+class MainComponent : public juce::AudioAppComponent, private juce::Timer {
        public:
         //==============================================================================
         MainComponent();
@@ -29,21 +47,91 @@ class MainComponent : public juce::AudioAppComponent {
         void releaseResources() override;
 
        private:
+        // keeps caches within budget and refreshes the memory readout
+        void timerCallback() override;
+        void appendDeckStatus(juce::String& status) const;
+
         juce::AudioFormatManager formatManager;
-        juce::AudioThumbnailCache thumbnailCache{100};
+        // one memory budget for every cache below, 1 GB by default
+        MemoryGovernor memoryGovernor{1024 * 1024 * 1024};
+
+        ThumbnailCacheClient thumbnailCache{100};
+        // decoded PCM shared by both decks; it evicts on its own once it alone outgrows the budget,
+        // as the governor only checks every second
+        DecodedAudioCache decodedAudioCache{memoryGovernor.getBudget()};
+        TrackAnalyser trackAnalyser;
 
         juce::FileChooser chooser{"Select a file to proccess..."};
 
-        AudioPlayer player1{formatManager};
-        AudioPlayer player2{formatManager};
+        // auditions library tracks on the cue bus, without a deck
+        PreviewPlayer previewPlayer{formatManager, trackAnalyser};
 
-        AssemblePane assemblePane1{&player1, formatManager, thumbnailCache};
-        AssemblePane assemblePane2{&player2, formatManager, thumbnailCache};
+        juce::MixerAudioSource mixerSource;
 
-        AudioPlayer playMetadata{formatManager};
-        PlaylistComponent playlistComponent{&assemblePane1, &assemblePane2, &playMetadata};
+        /*
+         * Both decks and everything built on them. They are created after the
+         * first frame, so the window and the audio device come up without
+         * waiting for them, and the library starts loading once they exist.
+         */
+        struct Decks {
+                explicit Decks(MainComponent& _owner);
 
-        juce::MixerAudioSource mixerSource;
+                MainComponent& owner;
+
+                AudioPlayer player1{owner.formatManager, owner.decodedAudioCache, owner.trackAnalyser};
+                AudioPlayer player2{owner.formatManager, owner.decodedAudioCache, owner.trackAnalyser};
+
+                AssemblePane assemblePane1{&player1, owner.formatManager, owner.thumbnailCache, owner.trackAnalyser,
+                                           owner.memoryGovernor};
+                AssemblePane assemblePane2{&player2, owner.formatManager, owner.thumbnailCache, owner.trackAnalyser,
+                                           owner.memoryGovernor};
+
+                BeatSync beatSync{player1, player2};
+
+                // plays a queue across both decks, the mixer plays its deck outputs
+                AutoDJ autoDJ{player1, player2, assemblePane1, assemblePane2, owner.trackAnalyser};
+
+                PlaylistComponent playlistComponent{&assemblePane1,          &assemblePane2,       &owner.previewPlayer,
+                                                    owner.decodedAudioCache, owner.formatManager, &autoDJ};
+
+                // controller input straight to the audio thread, with a learnt mapping
+                MidiController midiController{player1, player2};
+        };
+
+        // message thread, called once from the first paint
+        void createDecks();
+        // message thread, while the device is stopped or before the decks are published
+        void prepareDecks(Decks& toPrepare);
+
+        std::unique_ptr<Decks> decks;
+        bool decksRequested = false;
+        // the audio thread's pointer to decks, set once they are prepared
+        std::atomic<Decks*> liveDecks{nullptr};
+
+        // what leaves the mixer, measured on the audio thread
+        LevelMeter masterMeter;
+        LevelMeterDisplay masterMeterDisplay{masterMeter, "MASTER"};
+
+        MasterRecorder masterRecorder;
+        juce::TextButton recordButton{"Rec"};
+        juce::ComboBox recordFormatBox;
+        void toggleRecording();
+
+        // finds the smallest glitch-free buffer size and remembers it
+        BufferSizeTuner bufferSizeTuner{deviceManager};
+        juce::TextButton tuneButton{"Tune"};
+
+        juce::ComboBox midiLearnBox;
+
+        // writes the trace markers of every thread to a Chrome trace file
+        juce::TextButton traceButton{"Trace"};
+        void exportTrace();
+        // audio thread, to mark callbacks that came late; also what decks created later are prepared for
+        double deviceSampleRate = 0.0;
+        int deviceBlockSize = 0;
+        juce::int64 lastCallbackTicks = 0;
+
+        juce::Label statusLabel;
 
         juce::Random rand;
         double phase;
@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+    MasterRecorder.cpp
+    Created: 19/10/2026 14:10:32
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "MasterRecorder.h"
+
+#include <JuceHeader.h>
+
+#include "Log.h"
+#include "Tracer.h"
+
+//==============================================================================
+MasterRecorder::MasterRecorder() : juce::Thread("Master recorder") {}
+
+MasterRecorder::~MasterRecorder() { stopRecording(); }
+
+void MasterRecorder::prepare(int numChannels, double _sampleRate) {
+        stopRecording();
+
+        sampleRate = _sampleRate;
+        const int fifoSize = (int) (sampleRate * fifoSeconds);
+
+        fifoBuffer.setSize(numChannels, fifoSize);
+        fifo.setTotalSize(fifoSize);
+        fifo.reset();
+}
+
+bool MasterRecorder::startRecording(const juce::File& _file, Format format) {
+        stopRecording();
+
+        if (sampleRate <= 0 || fifoBuffer.getNumChannels() == 0) {
+                OTODECK_LOG(warning, "MasterRecorder", "Audio device is not running");
+                return false;
+        }
+
+        std::unique_ptr<juce::AudioFormat> audioFormat;
+        if (format == Format::flac) {
+                audioFormat.reset(new juce::FlacAudioFormat());
+        } else {
+                audioFormat.reset(new juce::WavAudioFormat());
+        }
+
+        _file.getParentDirectory().createDirectory();
+        std::unique_ptr<juce::FileOutputStream> stream(_file.createOutputStream());
+
+        if (stream == nullptr) {
+                OTODECK_LOG(warning, "MasterRecorder", "Could not open " << _file.getFullPathName());
+                return false;
+        }
+
+        writer.reset(audioFormat->createWriterFor(stream.get(), sampleRate, (unsigned int) fifoBuffer.getNumChannels(),
+                                                  24, {}, 0));
+
+        if (writer == nullptr) {
+                OTODECK_LOG(warning, "MasterRecorder", "Could not create writer for " << _file.getFullPathName());
+                return false;
+        }
+
+        // the writer owns the stream now
+        stream.release();
+        file = _file;
+
+        fifo.reset();
+        droppedSamples.store(0);
+        samplesWritten.store(0);
+
+        startThread();
+        recording.store(true);
+
+        OTODECK_LOG(info, "MasterRecorder", "Recording to " << file.getFullPathName());
+        return true;
+}
+
+void MasterRecorder::stopRecording() {
+        if (!recording.exchange(false)) {
+                return;
+        }
+
+        stopThread(2000);
+
+        // whatever is still queued goes to disk before the file is closed
+        drainFifo();
+        writer.reset();
+
+        OTODECK_LOG(info, "MasterRecorder", "Stopped, " << droppedSamples.load() << " samples dropped");
+}
+
+bool MasterRecorder::isRecording() const { return recording.load(); }
+
+void MasterRecorder::pushBlock(const juce::AudioSourceChannelInfo& bufferToFill) {
+        if (!recording.load()) {
+                return;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(bufferToFill.numSamples, start1, size1, start2, size2);
+
+        const int numChannels = juce::jmin(fifoBuffer.getNumChannels(), bufferToFill.buffer->getNumChannels());
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+                if (size1 > 0) {
+                        fifoBuffer.copyFrom(channel, start1, *bufferToFill.buffer, channel, bufferToFill.startSample,
+                                            size1);
+                }
+                if (size2 > 0) {
+                        fifoBuffer.copyFrom(channel, start2, *bufferToFill.buffer, channel,
+                                            bufferToFill.startSample + size1, size2);
+                }
+        }
+
+        fifo.finishedWrite(size1 + size2);
+
+        if (size1 + size2 < bufferToFill.numSamples) {
+                droppedSamples.fetch_add(bufferToFill.numSamples - (size1 + size2));
+        }
+}
+
+float MasterRecorder::getFifoFill() const {
+        const int total = fifo.getTotalSize();
+        return total > 1 ? (float) fifo.getNumReady() / (float) (total - 1) : 0.0f;
+}
+
+juce::int64 MasterRecorder::getDroppedSamples() const { return droppedSamples.load(); }
+
+double MasterRecorder::getRecordedSeconds() const { return sampleRate > 0 ? samplesWritten.load() / sampleRate : 0.0; }
+
+juce::File MasterRecorder::getFile() const { return file; }
+
+juce::String MasterRecorder::getFileExtension(Format format) { return format == Format::flac ? ".flac" : ".wav"; }
+
+void MasterRecorder::run() {
+        while (!threadShouldExit()) {
+                drainFifo();
+                wait(20);
+        }
+}
+
+void MasterRecorder::drainFifo() {
+        OTODECK_TRACE_SCOPE("Recorder write");
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+        if (writer != nullptr) {
+                if (size1 > 0) {
+                        writer->writeFromAudioSampleBuffer(fifoBuffer, start1, size1);
+                }
+                if (size2 > 0) {
+                        writer->writeFromAudioSampleBuffer(fifoBuffer, start2, size2);
+                }
+        }
+
+        fifo.finishedRead(size1 + size2);
+        samplesWritten.fetch_add(size1 + size2);
+}
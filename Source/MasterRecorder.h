@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    MasterRecorder.h
+    Created: 19/10/2026 14:10:32
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+/*
+ * MasterRecorder records the master mix to disk. The audio thread only copies
+ * each block into a preallocated FIFO; a background thread drains the FIFO
+ * and does the encoding and file writing. If the disk falls so far behind
+ * that the FIFO is full, the samples that do not fit are dropped and counted
+ * rather than blocking the audio thread.
+ */
+class MasterRecorder : private juce::Thread {
+       public:
+        enum class Format { wav, flac };
+
+        MasterRecorder();
+        ~MasterRecorder() override;
+
+        // allocates the FIFO, call from prepareToPlay; stops a recording in progress
+        void prepare(int numChannels, double sampleRate);
+
+        bool startRecording(const juce::File& file, Format format);
+        void stopRecording();
+        bool isRecording() const;
+
+        // audio thread, never blocks or allocates
+        void pushBlock(const juce::AudioSourceChannelInfo& bufferToFill);
+
+        // 0..1, how full the FIFO between the audio thread and the disk writer is
+        float getFifoFill() const;
+        juce::int64 getDroppedSamples() const;
+        double getRecordedSeconds() const;
+        juce::File getFile() const;
+
+        static juce::String getFileExtension(Format format);
+
+       private:
+        void run() override;
+        void drainFifo();
+
+        // ten seconds of slack for slow storage
+        static constexpr double fifoSeconds = 10.0;
+
+        juce::AbstractFifo fifo{1};
+        juce::AudioBuffer<float> fifoBuffer;
+        double sampleRate = 0.0;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+        juce::File file;
+
+        std::atomic<bool> recording{false};
+        std::atomic<juce::int64> droppedSamples{0};
+        std::atomic<juce::int64> samplesWritten{0};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MasterRecorder)
+};
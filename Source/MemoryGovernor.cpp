@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    MemoryGovernor.cpp
+    Created: 19/10/2026 11:02:37
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "MemoryGovernor.h"
+
+#include <JuceHeader.h>
+
+#include "Log.h"
+
+//==============================================================================
+MemoryGovernor::MemoryGovernor(size_t budgetBytes) : budget(budgetBytes) {}
+
+MemoryGovernor::~MemoryGovernor() {}
+
+void MemoryGovernor::addClient(Client* client) {
+        const juce::ScopedLock sl(lock);
+        clients.addIfNotAlreadyThere(client);
+}
+
+void MemoryGovernor::removeClient(Client* client) {
+        const juce::ScopedLock sl(lock);
+        clients.removeFirstMatchingValue(client);
+}
+
+void MemoryGovernor::setBudget(size_t budgetBytes) {
+        {
+                const juce::ScopedLock sl(lock);
+                budget = budgetBytes;
+        }
+        enforceBudget();
+}
+
+size_t MemoryGovernor::getBudget() const {
+        const juce::ScopedLock sl(lock);
+        return budget;
+}
+
+size_t MemoryGovernor::getUsage(Category category) const {
+        const juce::ScopedLock sl(lock);
+        size_t total = 0;
+
+        for (auto* client : clients) {
+                if (client->getMemoryCategory() == category) {
+                        total += client->getMemoryInUse();
+                }
+        }
+        return total;
+}
+
+size_t MemoryGovernor::getTotalUsage() const {
+        const juce::ScopedLock sl(lock);
+        size_t total = 0;
+
+        for (auto* client : clients) {
+                total += client->getMemoryInUse();
+        }
+        return total;
+}
+
+void MemoryGovernor::enforceBudget() {
+        const juce::ScopedLock sl(lock);
+
+        // analysis results are the cheapest to rebuild, so they go first within each priority
+        const Category order[] = {Category::analysis, Category::thumbnails, Category::readAhead,
+                                  Category::decodedAudio};
+
+        for (auto priority : {Priority::evictable, Priority::standby}) {
+                for (auto category : order) {
+                        for (auto* client : clients) {
+                                const size_t total = getTotalUsage();
+
+                                if (total <= budget) {
+                                        return;
+                                }
+
+                                if (client->getMemoryCategory() == category) {
+                                        const size_t freed = client->releaseMemory(total - budget, priority);
+
+                                        if (freed > 0) {
+                                                OTODECK_LOG(info, "MemoryGovernor",
+                                                            "Released " << (juce::int64) freed << " bytes of "
+                                                                        << getCategoryName(category));
+                                        }
+                                }
+                        }
+                }
+        }
+}
+
+juce::String MemoryGovernor::getUsageSummary() const {
+        juce::StringArray parts;
+
+        for (int i = 0; i < (int) Category::numCategories; ++i) {
+                const auto category = (Category) i;
+                parts.add(getCategoryName(category) + " " + juce::File::descriptionOfSizeInBytes((juce::int64) getUsage(category)));
+        }
+
+        return "Memory: " + parts.joinIntoString(", ") + " of " +
+               juce::File::descriptionOfSizeInBytes((juce::int64) getBudget());
+}
+
+juce::String MemoryGovernor::getCategoryName(Category category) {
+        switch (category) {
+                case Category::thumbnails:
+                        return "thumbnails";
+                case Category::decodedAudio:
+                        return "audio";
+                case Category::readAhead:
+                        return "read-ahead";
+                case Category::analysis:
+                        return "analysis";
+                default:
+                        break;
+        }
+        return {};
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    MemoryGovernor.h
+    Created: 19/10/2026 11:02:37
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+ * MemoryGovernor keeps one total memory budget for everything the app caches.
+ * Caches register as clients and report their usage per category; when the
+ * total goes over budget the governor asks them to release memory, lowest
+ * priority first. Anything a live deck is playing is reported as Priority::live
+ * and is never released.
+ */
+class MemoryGovernor {
+       public:
+        enum class Category { thumbnails = 0, decodedAudio, readAhead, analysis, numCategories };
+
+        enum class Priority { evictable = 0, standby, live };
+
+        class Client {
+               public:
+                virtual ~Client() = default;
+
+                virtual Category getMemoryCategory() const = 0;
+                virtual size_t getMemoryInUse() const = 0;
+
+                // release up to bytesToFree from items with at most the given priority, returns the bytes freed
+                virtual size_t releaseMemory(size_t bytesToFree, Priority maxPriority) = 0;
+        };
+
+        explicit MemoryGovernor(size_t budgetBytes);
+        ~MemoryGovernor();
+
+        void addClient(Client* client);
+        void removeClient(Client* client);
+
+        void setBudget(size_t budgetBytes);
+        size_t getBudget() const;
+
+        size_t getUsage(Category category) const;
+        size_t getTotalUsage() const;
+
+        // releases memory until the total fits the budget or nothing releasable is left
+        void enforceBudget();
+
+        // e.g. "audio 512.0 MB, thumbnails 40 KB, ... of 1.0 GB"
+        juce::String getUsageSummary() const;
+
+        static juce::String getCategoryName(Category category);
+
+       private:
+        juce::CriticalSection lock;
+        juce::Array<Client*> clients;
+        size_t budget;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MemoryGovernor)
+};
@@ -0,0 +1,242 @@
+/*
+  ==============================================================================
+
+    MidiController.cpp
+    Created: 19/10/2026 21:26:44
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "MidiController.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "Log.h"
+
+namespace {
+// kept with the library in the working directory
+const char* const mappingFileName = "midiMapping.txt";
+
+// jog wheels send relative two's complement steps, 1 clockwise and 127 anticlockwise
+float decodeJog(int value) { return (float) (value < 64 ? value : value - 128); }
+}        // namespace
+
+//==============================================================================
+MidiController::MidiController(AudioPlayer& deckA, AudioPlayer& deckB) : decks{&deckA, &deckB} {
+        for (std::atomic<juce::int8>& slot : mapping) {
+                slot.store(noTarget);
+        }
+}
+
+MidiController::~MidiController() {
+        stopTimer();
+
+        // the inputs stop calling back before the mapping and the FIFO go away
+        for (std::unique_ptr<juce::MidiInput>& input : inputs) {
+                input->stop();
+        }
+        inputs.clear();
+}
+
+void MidiController::start() {
+        loadMapping();
+
+        for (const juce::MidiDeviceInfo& device : juce::MidiInput::getAvailableDevices()) {
+                if (std::unique_ptr<juce::MidiInput> input = juce::MidiInput::openDevice(device.identifier, this)) {
+                        input->start();
+                        inputs.push_back(std::move(input));
+                }
+        }
+
+#if JUCE_LINUX || JUCE_MAC
+        // a port a test sender can connect to, e.g. with aconnect
+        if (std::unique_ptr<juce::MidiInput> input = juce::MidiInput::createNewDevice("OtoDeck Control", this)) {
+                input->start();
+                inputs.push_back(std::move(input));
+        }
+#endif
+
+        OTODECK_LOG(info, "MidiController", (int) inputs.size() << " inputs open");
+        startTimer(500);
+}
+
+void MidiController::learn(int target) { learnTarget.store(juce::jlimit(noTarget, numTargets - 1, target)); }
+
+bool MidiController::isLearning() const { return learnTarget.load() != noTarget; }
+
+juce::String MidiController::getTargetName(int target) {
+        static const char* const controls[] = {"fader", "bass", "mid", "treble", "jog", "cue"};
+        return juce::String(target / numControls == 0 ? "Left " : "Right ") + controls[target % numControls];
+}
+
+juce::String MidiController::getLatencySummary() const {
+        const int count = latencyCount.load();
+
+        if (count == 0) {
+                return {};
+        }
+
+        const double mean = latencySum.load() / count;
+        const double variance = juce::jmax(0.0, latencySumOfSquares.load() / count - mean * mean);
+
+        return "MIDI " + juce::String(mean * 1000.0, 2) + " ms, jitter " + juce::String(std::sqrt(variance) * 1000.0, 2) +
+               " ms, max " + juce::String(latencyMax.load() * 1000.0, 2) + " ms";
+}
+
+//==============================================================================
+void MidiController::handleIncomingMidiMessage(juce::MidiInput*, const juce::MidiMessage& message) {
+        const bool isNote = message.isNoteOnOrOff();
+
+        if (!isNote && !message.isController()) {
+                return;
+        }
+
+        const int number = isNote ? message.getNoteNumber() : message.getControllerNumber();
+        const int value = isNote ? (message.isNoteOn() ? 127 : 0) : message.getControllerValue();
+        std::atomic<juce::int8>& slot = mapping[(size_t) getSlot(message.getChannel() - 1, isNote, number)];
+
+        // learning binds whatever moves next, a note only on its press
+        const int learning = learnTarget.load();
+        if (learning != noTarget && (!isNote || value > 0)) {
+                slot.store((juce::int8) learning);
+                learnTarget.store(noTarget);
+                mappingChanged.store(true);
+                return;
+        }
+
+        const int target = slot.load();
+        if (target == noTarget) {
+                return;
+        }
+
+        const juce::SpinLock::ScopedLockType lock(commandWriteLock);
+        int start1, size1, start2, size2;
+        commandFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+        if (size1 == 0) {
+                droppedCommands.fetch_add(1);
+                return;
+        }
+
+        commands[(size_t) start1] = {(juce::int8) target, (float) value, message.getTimeStamp()};
+        commandFifo.finishedWrite(1);
+}
+
+void MidiController::prepare(double _sampleRate) { sampleRate = _sampleRate; }
+
+void MidiController::process(int numSamples) {
+        int start1, size1, start2, size2;
+        commandFifo.prepareToRead(commandFifo.getNumReady(), start1, size1, start2, size2);
+
+        if (size1 + size2 > 0) {
+                // MIDI time stamps are on the millisecond counter, in seconds
+                const double now = juce::Time::getMillisecondCounterHiRes() * 0.001;
+
+                for (int i = 0; i < size1 + size2; ++i) {
+                        const Command& command = commands[(size_t) (i < size1 ? start1 + i : start2 + i - size1)];
+                        apply(command);
+
+                        const double latency = juce::jmax(0.0, now - command.timestampSeconds);
+                        latencyCount.store(latencyCount.load() + 1);
+                        latencySum.store(latencySum.load() + latency);
+                        latencySumOfSquares.store(latencySumOfSquares.load() + latency * latency);
+                        latencyMax.store(juce::jmax(latencyMax.load(), latency));
+                }
+                commandFifo.finishedRead(size1 + size2);
+        }
+
+        // a jog nudge fades out over about 100 ms once the wheel stops
+        const double decay = std::exp(-numSamples / (0.1 * sampleRate));
+        for (int deck = 0; deck < 2; ++deck) {
+                if (jogNudge[deck] != 0.0) {
+                        jogNudge[deck] = std::abs(jogNudge[deck]) < 1.0e-4 ? 0.0 : jogNudge[deck] * decay;
+                        decks[deck]->setJogFactor(1.0 + jogNudge[deck]);
+                }
+        }
+}
+
+void MidiController::apply(const Command& command) {
+        const int deck = command.target / numControls;
+        AudioPlayer& player = *decks[deck];
+        const float normalised = command.value / 127.0f;
+
+        switch ((Control) (command.target % numControls)) {
+                case Control::fader:
+                        player.setGain(normalised);
+                        break;
+                // EQ knobs sweep -24 dB to +24 dB with unity gain in the middle
+                case Control::bass:
+                        player.setBassGain(juce::Decibels::decibelsToGain(normalised * 48.0f - 24.0f));
+                        break;
+                case Control::mid:
+                        player.setMidGain(juce::Decibels::decibelsToGain(normalised * 48.0f - 24.0f));
+                        break;
+                case Control::treble:
+                        player.setTrebleGain(juce::Decibels::decibelsToGain(normalised * 48.0f - 24.0f));
+                        break;
+                case Control::jog:
+                        // each step nudges the speed by 0.5%, up to 20% either way
+                        jogNudge[deck] = juce::jlimit(-0.2, 0.2, jogNudge[deck] + decodeJog((int) command.value) * 0.005);
+                        player.setJogFactor(1.0 + jogNudge[deck]);
+                        break;
+                case Control::cue:
+                        if (command.value > 0) {
+                                player.cue();
+                        }
+                        break;
+        }
+}
+
+//==============================================================================
+void MidiController::timerCallback() {
+        if (mappingChanged.exchange(false)) {
+                saveMapping();
+        }
+}
+
+void MidiController::saveMapping() const {
+        std::ofstream file(mappingFileName);
+
+        // channel,type,number,target
+        for (int channel = 0; channel < 16; ++channel) {
+                for (int type = 0; type < 2; ++type) {
+                        for (int number = 0; number < 128; ++number) {
+                                const int target = mapping[(size_t) getSlot(channel, type == 1, number)].load();
+                                if (target != noTarget) {
+                                        file << channel << "," << (type == 1 ? "note" : "cc") << "," << number << ","
+                                             << target << "\n";
+                                }
+                        }
+                }
+        }
+}
+
+void MidiController::loadMapping() {
+        std::ifstream file(mappingFileName);
+        std::string line;
+
+        while (std::getline(file, line)) {
+                std::stringstream fields(line);
+                std::string channel, type, number, target;
+
+                if (!std::getline(fields, channel, ',') || !std::getline(fields, type, ',') ||
+                    !std::getline(fields, number, ',') || !std::getline(fields, target)) {
+                        continue;
+                }
+
+                const int channelIndex = std::atoi(channel.c_str());
+                const int noteOrCc = std::atoi(number.c_str());
+                const int targetIndex = std::atoi(target.c_str());
+
+                if (channelIndex >= 0 && channelIndex < 16 && noteOrCc >= 0 && noteOrCc < 128 && targetIndex >= 0 &&
+                    targetIndex < numTargets) {
+                        mapping[(size_t) getSlot(channelIndex, type == "note", noteOrCc)].store((juce::int8) targetIndex);
+                }
+        }
+}
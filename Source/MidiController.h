@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    MidiController.h
+    Created: 19/10/2026 21:26:44
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "AudioPlayer.h"
+
+//==============================================================================
+/*
+ * MidiController maps controller messages straight onto the decks from the
+ * audio thread. The MIDI thread looks each CC or note up in a learnt mapping
+ * and pushes a command into a lock-free FIFO. The audio thread drains the
+ * FIFO at the start of every block and applies the commands to the decks.
+ * The message thread is never involved.
+ *
+ * Every command carries the timestamp of its MIDI message. The delay from
+ * the message to the block that applies it is tracked, as mean, jitter
+ * (standard deviation) and maximum. On Linux the app also opens a virtual
+ * ALSA input, "OtoDeck Control", so a test sender can drive it and measure.
+ *
+ * Mappings are learnt: pick a target, then move the control. The mapping is
+ * stored in midiMapping.txt in the working directory.
+ */
+class MidiController : private juce::MidiInputCallback, private juce::Timer {
+       public:
+        enum class Control { fader, bass, mid, treble, jog, cue };
+        static constexpr int numControls = 6;
+        static constexpr int numTargets = 2 * numControls;
+
+        MidiController(AudioPlayer& deckA, AudioPlayer& deckB);
+        ~MidiController() override;
+
+        // message thread: opens every MIDI input and the virtual port, loads the saved mapping
+        void start();
+
+        // target index is deck * numControls + control, -1 stops learning
+        void learn(int target);
+        bool isLearning() const;
+        static juce::String getTargetName(int target);
+
+        // controller-to-audio delay of the applied commands
+        juce::String getLatencySummary() const;
+
+        // audio thread, once per block before the decks are pulled
+        void prepare(double sampleRate);
+        void process(int numSamples);
+
+       private:
+        struct Command {
+                juce::int8 target;
+                float value;
+                double timestampSeconds;
+        };
+
+        void handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message) override;
+        void timerCallback() override;
+        void apply(const Command& command);
+        void saveMapping() const;
+        void loadMapping();
+
+        static constexpr int noTarget = -1;
+
+        // [channel][0 = CC, 1 = note][number] -> target, read by the MIDI thread, written by it while learning
+        static int getSlot(int channel, bool isNote, int number) { return (channel * 2 + (isNote ? 1 : 0)) * 128 + number; }
+        std::array<std::atomic<juce::int8>, 16 * 2 * 128> mapping;
+        std::atomic<int> learnTarget{noTarget};
+        std::atomic<bool> mappingChanged{false};
+
+        // MIDI thread -> audio thread; each input may call back on its own thread, the lock keeps them to one writer
+        juce::SpinLock commandWriteLock;
+        juce::AbstractFifo commandFifo{256};
+        std::array<Command, 256> commands;
+        std::atomic<int> droppedCommands{0};
+
+        // audio thread
+        AudioPlayer* decks[2];
+        double sampleRate = 44100.0;
+        double jogNudge[2] = {0.0, 0.0};
+
+        // latency statistics, accumulated on the audio thread
+        std::atomic<int> latencyCount{0};
+        std::atomic<double> latencySum{0.0}, latencySumOfSquares{0.0}, latencyMax{0.0};
+
+        std::vector<std::unique_ptr<juce::MidiInput>> inputs;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiController)
+};
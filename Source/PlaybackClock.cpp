@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    PlaybackClock.cpp
+    Created: 19/10/2026 18:22:10
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "PlaybackClock.h"
+
+#include <JuceHeader.h>
+
+//==============================================================================
+void PlaybackClock::publish(double positionSeconds, double lengthSeconds, double _speed, bool _playing) {
+        const juce::uint32 start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        position.store(positionSeconds, std::memory_order_relaxed);
+        length.store(lengthSeconds, std::memory_order_relaxed);
+        speed.store(_speed, std::memory_order_relaxed);
+        timeMs.store(juce::Time::getMillisecondCounterHiRes(), std::memory_order_relaxed);
+        playing.store(_playing, std::memory_order_relaxed);
+
+        sequence.store(start + 2, std::memory_order_release);
+}
+
+PlaybackClock::Snapshot PlaybackClock::read() const {
+        Snapshot snapshot;
+
+        for (;;) {
+                const juce::uint32 before = sequence.load(std::memory_order_acquire);
+
+                if ((before & 1) == 0) {
+                        snapshot.positionSeconds = position.load(std::memory_order_relaxed);
+                        snapshot.lengthSeconds = length.load(std::memory_order_relaxed);
+                        snapshot.speed = speed.load(std::memory_order_relaxed);
+                        snapshot.timeMs = timeMs.load(std::memory_order_relaxed);
+                        snapshot.playing = playing.load(std::memory_order_relaxed);
+
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        if (sequence.load(std::memory_order_relaxed) == before) {
+                                return snapshot;
+                        }
+                }
+        }
+}
+
+void PlaybackClock::setOutputLatency(double seconds) { outputLatency.store(juce::jmax(0.0, seconds)); }
+
+double PlaybackClock::getAudiblePosition() const {
+        const Snapshot snapshot = read();
+
+        if (!snapshot.playing) {
+                return snapshot.positionSeconds;
+        }
+
+        // the published block reaches the speakers one output latency after it was rendered; the clamp
+        // stops the playhead running away if the device stops calling back
+        const double latency = outputLatency.load();
+        const double elapsed = (juce::Time::getMillisecondCounterHiRes() - snapshot.timeMs) / 1000.0 - latency;
+        const double position = snapshot.positionSeconds + juce::jlimit(-latency, 0.25, elapsed) * snapshot.speed;
+
+        return juce::jlimit(0.0, juce::jmax(0.0, snapshot.lengthSeconds), position);
+}
+
+double PlaybackClock::getLengthInSeconds() const { return read().lengthSeconds; }
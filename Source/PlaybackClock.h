@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    PlaybackClock.h
+    Created: 19/10/2026 18:22:10
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+
+//==============================================================================
+/*
+ * PlaybackClock carries a deck's play position from the audio thread to the
+ * UI. Once per block the audio thread publishes the position at the start of
+ * the block together with the time it did so; the UI reads all of it as one
+ * consistent snapshot (a sequence lock, so the audio thread never waits) and
+ * extrapolates to the position that is coming out of the speakers right now,
+ * allowing for the output latency of the device.
+ */
+class PlaybackClock {
+       public:
+        struct Snapshot {
+                double positionSeconds = 0.0;
+                double lengthSeconds = 0.0;
+                double speed = 1.0;
+                double timeMs = 0.0;
+                bool playing = false;
+        };
+
+        // audio thread, once per block before rendering it
+        void publish(double positionSeconds, double lengthSeconds, double speed, bool playing);
+        Snapshot read() const;
+
+        // time from rendering a block to hearing it
+        void setOutputLatency(double seconds);
+
+        // the position being heard now, any thread
+        double getAudiblePosition() const;
+        double getLengthInSeconds() const;
+
+       private:
+        // odd while the audio thread is writing
+        std::atomic<juce::uint32> sequence{0};
+        std::atomic<double> position{0.0};
+        std::atomic<double> length{0.0};
+        std::atomic<double> speed{1.0};
+        std::atomic<double> timeMs{0.0};
+        std::atomic<bool> playing{false};
+
+        std::atomic<double> outputLatency{0.0};
+};
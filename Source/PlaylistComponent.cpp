@@ -12,16 +12,26 @@
 
 #include <JuceHeader.h>
 
+#include <cmath>
 #include <fstream>
 
 #include "AudioPlayer.h"
+#include "Log.h"
+#include "StartupMetrics.h"
+#include "Tracer.h"
 
 //==============================================================================
 PlaylistComponent::PlaylistComponent(AssemblePane* _assemblePane1, AssemblePane* _assemblePane2,
-                                     AudioPlayer* _playerForParsingMetaData)
+                                     PreviewPlayer* _previewPlayer, DecodedAudioCache& _decodedAudioCache,
+                                     juce::AudioFormatManager& _formatManager, AutoDJ* _autoDJ)
     : assemblePane1(_assemblePane1),
       assemblePane2(_assemblePane2),
-      playerForParsingMetaData(_playerForParsingMetaData)
+      previewPlayer(_previewPlayer),
+      decodedAudioCache(_decodedAudioCache),
+      formatManager(_formatManager),
+      autoDJ(_autoDJ),
+      previewStrip(*_previewPlayer),
+      watcher(_formatManager)
 
 {
         // In your constructor, you should add any child components, and initialise any special settings that your
@@ -30,32 +40,52 @@ PlaylistComponent::PlaylistComponent(AssemblePane* _assemblePane1, AssemblePane*
         addAndMakeVisible(tableComponent);
 
         addAndMakeVisible(importButton);
+        addAndMakeVisible(watchButton);
         addAndMakeVisible(searchField);
         addAndMakeVisible(library);
         addAndMakeVisible(addToPlayer1Button);
         addAndMakeVisible(addToPlayer2Button);
+        addAndMakeVisible(queueButton);
+        addAndMakeVisible(autoDJButton);
+        addAndMakeVisible(previewButton);
+        addAndMakeVisible(previewStrip);
 
         importButton.addListener(this);
+        watchButton.addListener(this);
         searchField.addListener(this);
 
         addToPlayer1Button.addListener(this);
         addToPlayer2Button.addListener(this);
-
-        searchField.setTextToShowWhenEmpty("Search titles (enter to submit)", juce::Colours::orangered);
+        queueButton.addListener(this);
+        autoDJButton.addListener(this);
+        previewButton.addListener(this);
+        autoDJButton.setClickingTogglesState(true);
+        autoDJButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::forestgreen);
+
+        searchField.setTextToShowWhenEmpty("Filter titles, bpm:120-130, min:3-6 (enter to submit)",
+                                           juce::Colours::orangered);
         searchField.onReturnKey = [this] { searchLibrary(searchField.getText()); };
 
         // setup table and load library from file
         library.getHeader().addColumn("Title", 1, 1);
         library.getHeader().addColumn("Length", 2, 1);
-        library.getHeader().addColumn("Delete", 3, 1);
+        library.getHeader().addColumn("BPM", 4, 1);
+        library.getHeader().addColumn("Delete", 3, 1, 30, -1,
+                                      juce::TableHeaderComponent::visible | juce::TableHeaderComponent::resizable);
 
         library.setModel(this);
+        // several tracks can be queued for Auto DJ at once
+        library.setMultipleSelectionEnabled(true);
 
-        loadLibrary();
+        // the saved library streams in after the window is up; the watcher starts once it is complete
+        loader.start(this);
 }
 
 PlaylistComponent::~PlaylistComponent() {
         // tableComponent.setModel(nullptr);
+        watcher.stop();
+        // a library still loading is read to the end first, or saving would drop the rest of it
+        loader.finishNow();
         saveLibrary();
 }
 
@@ -75,11 +105,16 @@ void PlaylistComponent::resized() {
         // This method is where you should set the bounds of any child components that your component contains..
 
         // tableComponent.setBounds(5, 5, getWidth() - 5, getHeight());
-        importButton.setBounds(0.3 * getWidth(), 5, 0.4 * getWidth(), getHeight() / 10);
-        library.setBounds(20, 4 * getHeight() / 30, getWidth() - 40, 20 * getHeight() / 30);
+        importButton.setBounds(0.05 * getWidth(), 5, 0.28 * getWidth(), getHeight() / 10);
+        watchButton.setBounds(0.36 * getWidth(), 5, 0.28 * getWidth(), getHeight() / 10);
+        autoDJButton.setBounds(0.67 * getWidth(), 5, 0.28 * getWidth(), getHeight() / 10);
+        library.setBounds(20, 4 * getHeight() / 30, getWidth() - 40, 17 * getHeight() / 30);
+        previewStrip.setBounds(20, library.getBottom() + 2, getWidth() - 140, 3 * getHeight() / 30 - 4);
+        previewButton.setBounds(previewStrip.getRight() + 5, previewStrip.getY(), 95, previewStrip.getHeight());
         searchField.setBounds(0, 16 * getHeight() / 20, getWidth(), getHeight() / 12);
-        addToPlayer1Button.setBounds(0, 18 * getHeight() / 20, getWidth() / 2, getHeight() / 10);
-        addToPlayer2Button.setBounds(getWidth() / 2, 18 * getHeight() / 20, getWidth() / 2, getHeight() / 10);
+        addToPlayer1Button.setBounds(0, 18 * getHeight() / 20, getWidth() / 3, getHeight() / 10);
+        queueButton.setBounds(getWidth() / 3, 18 * getHeight() / 20, getWidth() / 3, getHeight() / 10);
+        addToPlayer2Button.setBounds(2 * getWidth() / 3, 18 * getHeight() / 20, getWidth() / 3, getHeight() / 10);
 
         // set columns
         library.getHeader().setColumnWidth(1, 4 * getWidth() / 20);
@@ -89,7 +124,7 @@ void PlaylistComponent::resized() {
         library.getHeader().setColumnWidth(5, 2 * getWidth() / 20);
 }
 
-int PlaylistComponent::getNumRows() { return tracks.size(); }
+int PlaylistComponent::getNumRows() { return tracks.getNumRows(); }
 
 void PlaylistComponent::paintRowBackground(juce::Graphics& g, int rowNumber, int width, int height,
                                            bool rowIsSelected) {
@@ -102,53 +137,86 @@ void PlaylistComponent::paintRowBackground(juce::Graphics& g, int rowNumber, int
 
 void PlaylistComponent::paintCell(juce::Graphics& g, int rowNumber, int columnId, int width, int height,
                                   bool rowIsSelected) {
-        if (rowNumber < getNumRows())
-                if (columnId == 1) {
-                        g.drawText(tracks[rowNumber].title, 2, 0, width - 4, height, juce::Justification::centredLeft,
-                                   true);
-                }
+        if (rowNumber >= getNumRows()) {
+                return;
+        }
+
+        const int track = tracks.getTrackIndexForRow(rowNumber);
+
+        if (columnId == 1) {
+                g.drawText(tracks.getTitle(track), 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+        }
         if (columnId == 2) {
-                g.drawText(tracks[rowNumber].length, 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+                g.drawText(secondsToMinutes(tracks.getLengthSeconds(track)), 2, 0, width - 4, height,
+                           juce::Justification::centredLeft, true);
+        }
+        if (columnId == 4 && !std::isnan(tracks.getBpm(track))) {
+                g.drawText(juce::String(tracks.getBpm(track), 1), 2, 0, width - 4, height,
+                           juce::Justification::centredLeft, true);
         }
 }
 
+void PlaylistComponent::sortOrderChanged(int newSortColumnId, bool isForwards) {
+        auto column = LibraryModel::SortColumn::none;
+
+        if (newSortColumnId == 1) {
+                column = LibraryModel::SortColumn::title;
+        } else if (newSortColumnId == 2) {
+                column = LibraryModel::SortColumn::length;
+        } else if (newSortColumnId == 4) {
+                column = LibraryModel::SortColumn::bpm;
+        }
+
+        tracks.setSort(column, isForwards);
+        library.updateContent();
+        library.repaint();
+}
+
 PlaylistComponent::Component* PlaylistComponent::refreshComponentForCell(
     int rowNumber, int columnId, bool isRowSelected, PlaylistComponent::Component* existingComponentToUpdate) {
-        if (columnId == 3) {
-                if (existingComponentToUpdate == nullptr) {
-                        juce::TextButton* btn = new juce::TextButton{"Delete Track"};
+        if (columnId != 3) {
+                // the table owns components it was given, hand back nothing for plain cells
+                delete existingComponentToUpdate;
+                return nullptr;
+        }
 
-                        juce::String id{std::to_string(rowNumber)};
-                        btn->setComponentID(id);
+        auto* btn = dynamic_cast<DeleteButton*>(existingComponentToUpdate);
 
-                        btn->addListener(this);
-                        existingComponentToUpdate = btn;
-                        btn->setColour(juce::TextButton::buttonColourId, juce::Colours::red);
-                }
+        if (btn == nullptr) {
+                delete existingComponentToUpdate;
+
+                btn = new DeleteButton();
+                btn->addListener(this);
+                btn->setColour(juce::TextButton::buttonColourId, juce::Colours::red);
         }
-        return existingComponentToUpdate;
+
+        // recycled buttons are re-pointed at the track now shown in this row
+        btn->trackId = rowNumber < getNumRows() ? tracks.getTrackId(tracks.getTrackIndexForRow(rowNumber)) : 0;
+        return btn;
 }
 
 void PlaylistComponent::buttonClicked(juce::Button* button) {
-        // int id = std::stoi(button->getComponentID().toStdString());
-
-        // DBG("Button clicked!" << button->getComponentID());
-        // DBG(trackTitles[id]);
-
         if (button == &importButton) {
-                DBG("Load button clicked");
+                OTODECK_LOG(debug, "PlaylistComponent", "Load button clicked");
                 importToLibrary();
-                library.updateContent();
+        } else if (button == &watchButton) {
+                OTODECK_LOG(debug, "PlaylistComponent", "Watch button clicked");
+                watchFolder();
         } else if (button == &addToPlayer1Button) {
-                DBG("Add to Player 1 clicked");
+                OTODECK_LOG(debug, "PlaylistComponent", "Add to Player 1 clicked");
                 loadInPlayer(assemblePane1);
         } else if (button == &addToPlayer2Button) {
-                DBG("Add to Player 2 clicked");
+                OTODECK_LOG(debug, "PlaylistComponent", "Add to Player 2 clicked");
                 loadInPlayer(assemblePane2);
-        } else {
-                int id = std::stoi(button->getComponentID().toStdString());
-                DBG(tracks[id].title + " removed from Library");
-                deleteFromTracks(id);
+        } else if (button == &queueButton) {
+                queueSelected();
+        } else if (button == &autoDJButton) {
+                autoDJ->setEnabled(autoDJButton.getToggleState());
+        } else if (button == &previewButton) {
+                previewSelected();
+        } else if (auto* deleteButton = dynamic_cast<DeleteButton*>(button)) {
+                deleteFromTracks(deleteButton->trackId);
+                tracks.rebuildView();
                 library.updateContent();
         }
 }
@@ -156,9 +224,10 @@ void PlaylistComponent::buttonClicked(juce::Button* button) {
 void PlaylistComponent::loadInPlayer(AssemblePane* AssemblePane) {
         int selectedRow{library.getSelectedRow()};
 
-        if (selectedRow != -1) {
-                DBG("Adding: " << tracks[selectedRow].title << " to Player");
-                AssemblePane->loadFile(tracks[selectedRow].URL);
+        if (selectedRow != -1 && selectedRow < getNumRows()) {
+                const int track = tracks.getTrackIndexForRow(selectedRow);
+                OTODECK_LOG(debug, "PlaylistComponent", "Adding: " << tracks.getTitle(track) << " to Player");
+                AssemblePane->loadFile(juce::URL{tracks.getFile(track)});
         } else {
                 juce::AlertWindow::showMessageBoxAsync(
                     juce::AlertWindow::AlertIconType::InfoIcon,
@@ -166,8 +235,46 @@ void PlaylistComponent::loadInPlayer(AssemblePane* AssemblePane) {
         }
 }
 
+void PlaylistComponent::previewSelected() {
+        const int selectedRow{library.getSelectedRow()};
+
+        if (selectedRow == -1 || selectedRow >= getNumRows()) {
+                previewPlayer->stop();
+                return;
+        }
+
+        // pressing it again on the track that is playing stops the preview
+        const juce::File file = tracks.getFile(tracks.getTrackIndexForRow(selectedRow));
+        if (previewPlayer->isPlaying() && previewPlayer->getFile() == file) {
+                previewPlayer->stop();
+                return;
+        }
+
+        // starts a third of the way in, past most intros; the strip scrubs from there
+        previewPlayer->preview(file, 1.0 / 3.0);
+}
+
+void PlaylistComponent::queueSelected() {
+        const juce::SparseSet<int> selectedRows = library.getSelectedRows();
+
+        if (selectedRows.isEmpty()) {
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::AlertIconType::InfoIcon,
+                                                       "Auto DJ Information:", "Please select tracks to queue", "OK",
+                                                       nullptr);
+                return;
+        }
+
+        // queued in the order they are shown
+        for (int i = 0; i < selectedRows.size(); ++i) {
+                const int row = selectedRows[i];
+                if (row < getNumRows()) {
+                        autoDJ->enqueue(tracks.getFile(tracks.getTrackIndexForRow(row)));
+                }
+        }
+}
+
 void PlaylistComponent::importToLibrary() {
-        DBG("PlaylistComponent::importToLibrary called");
+        OTODECK_LOG(debug, "PlaylistComponent", "PlaylistComponent::importToLibrary called");
 
         // initialize file chooser
         juce::FileChooser chooser{"Select files"};
@@ -176,17 +283,15 @@ void PlaylistComponent::importToLibrary() {
                                            juce::FileBrowserComponent::openMode;
 
         fChooser.launchAsync(folderChooserFlags, [this](const juce::FileChooser& chooser) {
+                OTODECK_TRACE_SCOPE("Library import");
                 juce::Array<juce::File> files = chooser.getResults();
 
                 for (const juce::File& file : files) {
                         juce::String fileNameWithoutExtension{file.getFileNameWithoutExtension()};
                         if (!isInTracks(fileNameWithoutExtension))        // if not already loaded
                         {
-                                Track newTrack{file};
-                                juce::URL audioURL{file};
-                                newTrack.length = getLength(audioURL);
-                                tracks.push_back(newTrack);
-                                DBG("loaded file: " << newTrack.title);
+                                tracks.addTrack(file, (float) getLength(juce::URL{file}));
+                                OTODECK_LOG(debug, "PlaylistComponent", "Loaded file: " << fileNameWithoutExtension);
                         } else        // display info message
                         {
                                 juce::AlertWindow::showMessageBoxAsync(
@@ -194,20 +299,67 @@ void PlaylistComponent::importToLibrary() {
                                     "Load information:", fileNameWithoutExtension + " already loaded", "OK", nullptr);
                         }
                 }
+
+                tracks.rebuildView();
+                library.updateContent();
+        });
+}
+
+void PlaylistComponent::watchFolder() {
+        constexpr int folderChooserFlags = juce::FileBrowserComponent::canSelectDirectories |
+                                           juce::FileBrowserComponent::openMode;
+
+        fChooser.launchAsync(folderChooserFlags, [this](const juce::FileChooser& chooser) {
+                const juce::File folder = chooser.getResult();
+
+                if (folder.isDirectory()) {
+                        OTODECK_LOG(info, "PlaylistComponent", "Watching folder: " << folder.getFullPathName());
+                        watcher.addRoot(folder);
+                }
         });
 }
 
+void PlaylistComponent::watchedFilesChanged(const std::vector<LibraryWatcher::Change>& changes) {
+        // watched files are matched by path, so a changed file updates its row instead of adding another
+        for (const LibraryWatcher::Change& change : changes) {
+                TrackId id = tracks.findTrack(change.file);
+
+                if (change.removed) {
+                        deleteFromTracks(id);
+                        continue;
+                }
+
+                if (id == 0) {
+                        id = tracks.addTrack(change.file, change.lengthSeconds);
+                        OTODECK_LOG(debug, "PlaylistComponent",
+                                    "Loaded file: " << change.file.getFileNameWithoutExtension());
+                } else {
+                        tracks.setLengthSeconds(id, change.lengthSeconds);
+                }
+                tracks.setBpm(id, change.bpm);
+                tracks.setLoudness(id, change.loudnessLufs);
+        }
+
+        tracks.rebuildView();
+        library.updateContent();
+        library.repaint();
+}
+
 bool PlaylistComponent::isInTracks(juce::String fileNameWithoutExtension) {
-        return (std::find(tracks.begin(), tracks.end(), fileNameWithoutExtension) != tracks.end());
+        return tracks.containsTitle(fileNameWithoutExtension);
 }
 
-void PlaylistComponent::deleteFromTracks(int id) { tracks.erase(tracks.begin() + id); }
+void PlaylistComponent::deleteFromTracks(TrackId id) {
+        const int index = tracks.indexOf(id);
+
+        if (index >= 0) {
+                OTODECK_LOG(info, "PlaylistComponent", tracks.getTitle(index) + " removed from Library");
+                tracks.removeTrack(id);
+        }
+}
 
-juce::String PlaylistComponent::getLength(juce::URL audioURL) {
-        playerForParsingMetaData->loadUrl(audioURL);
-        double seconds{playerForParsingMetaData->getLengthInSeconds()};
-        juce::String minutes{secondsToMinutes(seconds)};
-        return minutes;
+double PlaylistComponent::getLength(juce::URL audioURL) {
+        return decodedAudioCache.probeLengthInSeconds(audioURL.getLocalFile(), formatManager);
 }
 
 juce::String PlaylistComponent::secondsToMinutes(double seconds) {
@@ -224,54 +376,78 @@ juce::String PlaylistComponent::secondsToMinutes(double seconds) {
 }
 
 void PlaylistComponent::searchLibrary(juce::String searchText) {
-        DBG("Searching titles for: " << searchText);
-        if (searchText != "") {
-                int rowNumber = whereInTracks(searchText);
-                library.selectRow(rowNumber);
-        } else {
-                library.deselectAllRows();
-        }
+        OTODECK_LOG(debug, "PlaylistComponent", "Filtering library for: " << searchText);
+        tracks.setFilter(parseFilter(searchText));
+        library.deselectAllRows();
+        library.updateContent();
+        library.repaint();
 }
 
-int PlaylistComponent::whereInTracks(juce::String searchText) {
-        // finds index where track title contains searchText
-        auto it = find_if(tracks.begin(), tracks.end(),
-                          [&searchText](const Track& obj) { return obj.title.contains(searchText); });
-        int i = -1;
-
-        if (it != tracks.end()) {
-                i = std::distance(tracks.begin(), it);
+LibraryFilter PlaylistComponent::parseFilter(const juce::String& searchText) {
+        // "bpm:120-130" and "min:3-6" (length in minutes) are criteria, every other word is title text
+        LibraryFilter filter;
+        juce::StringArray titleWords;
+
+        for (const juce::String& token : juce::StringArray::fromTokens(searchText, " ", "\"")) {
+                const juce::String range = token.fromFirstOccurrenceOf(":", false, false);
+                const float low = range.upToFirstOccurrenceOf("-", false, false).getFloatValue();
+                const float high = range.containsChar('-') ? range.fromFirstOccurrenceOf("-", false, false).getFloatValue()
+                                                           : low;
+
+                if (token.startsWithIgnoreCase("bpm:")) {
+                        filter.minBpm = low;
+                        filter.maxBpm = high;
+                } else if (token.startsWithIgnoreCase("min:")) {
+                        filter.minLengthSeconds = low * 60.0f;
+                        filter.maxLengthSeconds = high * 60.0f;
+                } else if (token.isNotEmpty()) {
+                        titleWords.add(token.unquoted());
+                }
         }
 
-        return i;
+        filter.titleContains = titleWords.joinIntoString(" ");
+        return filter;
 }
 
 void PlaylistComponent::saveLibrary() {
         // create .csv to save library
         std::ofstream myLibrary("audioLibrary.csv");
 
-        // save library to file
-        for (Track& t : tracks) {
-                myLibrary << t.file.getFullPathName() << "," << t.length << "\n";
+        // save library to file as path,length,bpm,loudness - unanalysed values are left empty, and the loudness
+        // carries its unit, as earlier versions stored an RMS level in dBFS there
+        auto analysed = [](float value) { return std::isnan(value) ? juce::String() : juce::String(value, 2); };
+
+        for (int i = 0; i < tracks.getNumTracks(); ++i) {
+                const juce::String loudness = analysed(tracks.getLoudness(i));
+                myLibrary << tracks.getFile(i).getFullPathName() << "," << secondsToMinutes(tracks.getLengthSeconds(i))
+                          << "," << analysed(tracks.getBpm(i)) << ","
+                          << (loudness.isNotEmpty() ? loudness + " LUFS" : loudness) << "\n";
         }
 }
 
-void PlaylistComponent::loadLibrary() {
-        // create input stream from saved library
-        std::ifstream myLibrary("audioLibrary.csv");
-        std::string filePath;
-        std::string length;
-
-        // Read data, line by line
-        if (myLibrary.is_open()) {
-                while (getline(myLibrary, filePath, ',')) {
-                        juce::File file{filePath};
-                        Track newTrack{file};
-
-                        getline(myLibrary, length);
-                        newTrack.length = length;
-                        tracks.push_back(newTrack);
+void PlaylistComponent::libraryEntriesLoaded(const std::vector<LibraryLoader::Entry>& entries) {
+        OTODECK_TRACE_SCOPE("Library rows added");
+        // a track imported while the library was loading is not added twice
+        for (const LibraryLoader::Entry& entry : entries) {
+                if (tracks.findTrack(entry.file) != 0) {
+                        continue;
                 }
+
+                const TrackId id = tracks.addTrack(entry.file, entry.lengthSeconds);
+                tracks.setBpm(id, entry.bpm);
+                tracks.setLoudness(id, entry.loudnessLufs);
         }
-        myLibrary.close();
+
+        tracks.rebuildView();
+        library.updateContent();
+        library.repaint();
+}
+
+void PlaylistComponent::libraryLoadFinished() {
+        OTODECK_LOG(info, "PlaylistComponent", "Library loaded: " << tracks.getNumTracks() << " tracks");
+        StartupMetrics::markLibraryLoaded(tracks.getNumTracks());
+
+        // watched folders only report what changed since the last session, matched against the loaded library
+        watcher.setListener(this);
+        watcher.start();
 }
@@ -11,7 +11,11 @@
 #include <JuceHeader.h>
 
 #include "AssemblePane.h"
-#include "Track.h"
+#include "AutoDJ.h"
+#include "LibraryLoader.h"
+#include "LibraryModel.h"
+#include "LibraryWatcher.h"
+#include "PreviewStrip.h"
 #include "juce_gui_basics/juce_gui_basics.h"
 
 //==============================================================================
@@ -20,11 +24,15 @@
 class PlaylistComponent : public juce::Component,
                           public juce::TableListBoxModel,
                           public juce::Button::Listener,
-                          public juce::TextEditor::Listener        // inherit TableListBoxModel, to allow
-                                                                   // PlayListComponent to behave like a table
+                          public juce::TextEditor::Listener,        // inherit TableListBoxModel, to allow
+                                                                    // PlayListComponent to behave like a table
+                          private LibraryWatcher::Listener,
+                          private LibraryLoader::Listener
 {
        public:
-        PlaylistComponent(AssemblePane* _assemblePane1, AssemblePane* _assemblePane2, AudioPlayer* _playerForParsingMetaData);
+        PlaylistComponent(AssemblePane* _assemblePane1, AssemblePane* _assemblePane2, PreviewPlayer* _previewPlayer,
+                          DecodedAudioCache& _decodedAudioCache, juce::AudioFormatManager& _formatManager,
+                          AutoDJ* _autoDJ);
         ~PlaylistComponent() override;
 
         void paint(juce::Graphics&) override;
@@ -40,35 +48,62 @@ class PlaylistComponent : public juce::Component,
         Component* refreshComponentForCell(int rowNumber, int columnId, bool isRowSelected,
                                            Component* existingComponentToUpdate) override;
 
+        void sortOrderChanged(int newSortColumnId, bool isForwards) override;
+
         void buttonClicked(juce::Button* button) override;
 
        private:
+        // Delete button cell, recycled by the table and pointed at whichever track its row shows
+        class DeleteButton : public juce::TextButton {
+               public:
+                DeleteButton() : juce::TextButton{"Delete Track"} {}
+                TrackId trackId = 0;
+        };
+
         juce::TableListBox tableComponent;
-        std::vector<Track> tracks;
+        LibraryModel tracks;
 
         juce::FileChooser fChooser{"Select a file..."};
 
         juce::TextButton importButton{"IMPORT AUDIO LIBRARY"};
+        juce::TextButton watchButton{"WATCH FOLDER"};
         juce::TextEditor searchField;
         juce::TableListBox library;
         juce::TextButton addToPlayer1Button{"ADD TO LEFT DECK"};
         juce::TextButton addToPlayer2Button{"ADD TO RIGHT DECK"};
+        juce::TextButton queueButton{"QUEUE FOR AUTO DJ"};
+        juce::TextButton autoDJButton{"AUTO DJ"};
+        juce::TextButton previewButton{"PREVIEW"};
 
         AssemblePane* assemblePane1;
         AssemblePane* assemblePane2;
-        AudioPlayer* playerForParsingMetaData;
+        PreviewPlayer* previewPlayer;
+        DecodedAudioCache& decodedAudioCache;
+        juce::AudioFormatManager& formatManager;
+        AutoDJ* autoDJ;
+
+        PreviewStrip previewStrip;
+
+        // declared after tracks, so they stop before the library goes away
+        LibraryWatcher watcher;
+        LibraryLoader loader;
 
-        juce::String getLength(juce::URL audioURL);
+        double getLength(juce::URL audioURL);
         juce::String secondsToMinutes(double seconds);
 
         void importToLibrary();
+        void watchFolder();
+        void watchedFilesChanged(const std::vector<LibraryWatcher::Change>& changes) override;
         void searchLibrary(juce::String searchText);
+        void libraryEntriesLoaded(const std::vector<LibraryLoader::Entry>& entries) override;
+        void libraryLoadFinished() override;
         void saveLibrary();
-        void loadLibrary();
-        void deleteFromTracks(int id);
+        void deleteFromTracks(TrackId id);
         bool isInTracks(juce::String fileNameWithoutExtension);
-        int whereInTracks(juce::String searchText);
+        static LibraryFilter parseFilter(const juce::String& searchText);
         void loadInPlayer(AssemblePane* AssemblePane);
+        void queueSelected();
+        void previewSelected();
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PlaylistComponent)
 };
@@ -0,0 +1,245 @@
+/*
+  ==============================================================================
+
+    PreviewPlayer.cpp
+    Created: 19/10/2026 23:06:52
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "PreviewPlayer.h"
+
+#include <JuceHeader.h>
+
+#include "Log.h"
+
+//==============================================================================
+PreviewPlayer::PreviewPlayer(juce::AudioFormatManager& _formatManager, TrackAnalyser& _trackAnalyser)
+    : juce::Thread("Preview decoder"), formatManager(_formatManager), trackAnalyser(_trackAnalyser) {
+        startThread();
+}
+
+PreviewPlayer::~PreviewPlayer() {
+        stopThread(5000);
+
+        // the audio device is closed by now, nothing else can hold a region
+        delete pendingRegion.exchange(nullptr);
+        freeRetiredRegions();
+        delete outgoing;
+        delete region;
+}
+
+void PreviewPlayer::preview(const juce::File& file, double position) {
+        {
+                const juce::ScopedLock sl(requestLock);
+                requestedFile = file;
+                requestedPosition = juce::jlimit(0.0, 1.0, position);
+                requestedGeneration = ++requestGeneration;
+                requestPending = true;
+                currentFile = file;
+        }
+        notify();
+}
+
+void PreviewPlayer::stop() {
+        {
+                const juce::ScopedLock sl(requestLock);
+                requestPending = false;
+                // a region still being decoded is dropped when it is done
+                ++requestGeneration;
+        }
+        // a region decoded but not yet playing is dropped, whoever takes it out owns it
+        delete pendingRegion.exchange(nullptr);
+        stopRequested.store(true);
+}
+
+bool PreviewPlayer::isPlaying() const { return playing.load(); }
+
+juce::File PreviewPlayer::getFile() const {
+        const juce::ScopedLock sl(requestLock);
+        return currentFile;
+}
+
+double PreviewPlayer::getPosition() const { return audiblePosition.load(); }
+
+std::shared_ptr<const ColouredWaveform> PreviewPlayer::getWaveform() const {
+        const juce::ScopedLock sl(waveformLock);
+        return waveform;
+}
+
+//==============================================================================
+void PreviewPlayer::run() {
+        while (!threadShouldExit()) {
+                freeRetiredRegions();
+
+                juce::File file;
+                double position = 0.0;
+                juce::uint32 generation = 0;
+                {
+                        const juce::ScopedLock sl(requestLock);
+                        if (requestPending) {
+                                file = requestedFile;
+                                position = requestedPosition;
+                                generation = requestedGeneration;
+                                requestPending = false;
+                        }
+                }
+
+                if (file == juce::File()) {
+                        wait(100);
+                        continue;
+                }
+
+                // scrubbing the same track reuses the open reader
+                if (file != readerFile) {
+                        reader.reset(formatManager.createReaderFor(file));
+                        readerFile = file;
+
+                        const juce::ScopedLock sl(waveformLock);
+                        waveform = trackAnalyser.findCachedWaveform(file);
+                }
+
+                std::unique_ptr<Region> next = decodeRegion(position);
+                if (next == nullptr) {
+                        OTODECK_LOG(warning, "PreviewPlayer", "Could not read " << file.getFullPathName());
+                        continue;
+                }
+
+                // stopped or moved on while it was decoding
+                next->generation = generation;
+                if (generation != requestGeneration.load()) {
+                        continue;
+                }
+
+                // a region the audio thread never picked up is replaced; it was never played, so it can go
+                delete pendingRegion.exchange(next.release());
+        }
+}
+
+std::unique_ptr<PreviewPlayer::Region> PreviewPlayer::decodeRegion(double position) {
+        if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0) {
+                return nullptr;
+        }
+
+        auto next = std::make_unique<Region>();
+        next->sampleRate = reader->sampleRate;
+        next->trackLength = reader->lengthInSamples;
+        next->startSample = juce::jlimit<juce::int64>(0, reader->lengthInSamples - 1,
+                                                      (juce::int64) (position * reader->lengthInSamples));
+
+        const int length = (int) juce::jmin<juce::int64>(reader->lengthInSamples - next->startSample,
+                                                         (juce::int64) (regionSeconds * reader->sampleRate));
+        next->samples.setSize(juce::jlimit(1, 2, (int) reader->numChannels), length);
+        reader->read(&next->samples, 0, length, next->startSample, true, true);
+        return next;
+}
+
+void PreviewPlayer::retire(Region* old) {
+        // at most two regions are retired per region the worker publishes, and it empties the queue before each
+        int start1, size1, start2, size2;
+        retiredFifo.prepareToWrite(1, start1, size1, start2, size2);
+        jassert(size1 == 1);
+
+        if (size1 == 1) {
+                retiredRegions[(size_t) start1] = old;
+                retiredFifo.finishedWrite(1);
+        }
+}
+
+void PreviewPlayer::freeRetiredRegions() {
+        int start1, size1, start2, size2;
+        retiredFifo.prepareToRead(retiredFifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i) {
+                delete retiredRegions[(size_t) (start1 + i)];
+        }
+        for (int i = 0; i < size2; ++i) {
+                delete retiredRegions[(size_t) (start2 + i)];
+        }
+        retiredFifo.finishedRead(size1 + size2);
+}
+
+//==============================================================================
+void PreviewPlayer::prepare(double _sampleRate) {
+        sampleRate = _sampleRate;
+        // 10 ms fades
+        fadeStep = (float) (1.0 / (0.01 * sampleRate));
+}
+
+void PreviewPlayer::process(juce::AudioBuffer<float>& bus, int startSample, int numSamples) {
+        // the next region waits while the one before is still fading out, which is at most one fade
+        if (outgoing == nullptr) {
+                if (Region* next = pendingRegion.exchange(nullptr)) {
+                        if (next->generation != requestGeneration.load()) {
+                                // decoded for a request that was stopped or replaced since
+                                retire(next);
+                        } else {
+                                if (region != nullptr && playing.load() && fadeGain > 0.0f) {
+                                        // scrubbing, the old region fades out under the new one
+                                        outgoing = region;
+                                        outgoingPosition = readPosition;
+                                        outgoingGain = fadeGain;
+                                } else if (region != nullptr) {
+                                        retire(region);
+                                }
+
+                                region = next;
+                                readPosition = 0.0;
+                                fadeGain = 0.0f;
+                                stopRequested.store(false);
+                                playing.store(true);
+                        }
+                }
+        }
+
+        if (outgoing != nullptr &&
+            !render(*outgoing, outgoingPosition, outgoingGain, true, bus, startSample, numSamples)) {
+                retire(outgoing);
+                outgoing = nullptr;
+        }
+
+        if (region == nullptr || !playing.load()) {
+                return;
+        }
+
+        if (!render(*region, readPosition, fadeGain, stopRequested.load(), bus, startSample, numSamples)) {
+                playing.store(false);
+        }
+
+        audiblePosition.store((region->startSample + readPosition) / (double) region->trackLength);
+}
+
+bool PreviewPlayer::render(const Region& source, double& position, float& fade, bool fadingOut,
+                           juce::AudioBuffer<float>& bus, int startSample, int numSamples) const {
+        const int regionLength = source.samples.getNumSamples();
+        const int numChannels = source.samples.getNumChannels();
+        const int numOutputs = juce::jmin(2, bus.getNumChannels());
+        const double ratio = source.sampleRate / sampleRate;
+        // the end of the region fades out like a stop
+        const double fadeOutFrom = regionLength - 1 - ratio / fadeStep;
+
+        for (int i = 0; i < numSamples; ++i) {
+                const bool stopping = fadingOut || position >= fadeOutFrom;
+                fade = stopping ? fade - fadeStep : juce::jmin(1.0f, fade + fadeStep);
+
+                if (fade <= 0.0f && stopping) {
+                        fade = 0.0f;
+                        return false;
+                }
+
+                // linear interpolation, enough for auditioning
+                const int index = (int) position;
+                const float fraction = (float) (position - index);
+                const int nextIndex = juce::jmin(index + 1, regionLength - 1);
+
+                for (int channel = 0; channel < numOutputs; ++channel) {
+                        const float* data = source.samples.getReadPointer(juce::jmin(channel, numChannels - 1));
+                        const float sample = data[index] + fraction * (data[nextIndex] - data[index]);
+                        bus.addSample(channel, startSample + i, sample * fade * gain);
+                }
+
+                position = juce::jmin(position + ratio, (double) (regionLength - 1));
+        }
+        return true;
+}
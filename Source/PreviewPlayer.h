@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    PreviewPlayer.h
+    Created: 19/10/2026 23:06:52
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include "ColouredWaveform.h"
+#include "TrackAnalyser.h"
+
+//==============================================================================
+/*
+ * PreviewPlayer auditions a library track without loading it into a deck.
+ *
+ * Only the requested region (regionSeconds from the chosen position) is
+ * decoded, on the preview thread with a reader kept open for the file, and
+ * handed to the audio thread as a finished buffer. Moving the position
+ * decodes a new region while the old one keeps playing, and the two
+ * cross-fade, so scrubbing never interrupts the sound. Every request carries
+ * a generation, and a region decoded for a request that was since stopped or
+ * replaced is dropped instead of played. The preview is rendered onto its own
+ * bus, with short fades at every start and stop, and never passes through a
+ * deck.
+ *
+ * The overview waveform comes from the analyser's cache, so a track that has
+ * never been analysed simply previews without one.
+ */
+class PreviewPlayer : private juce::Thread {
+       public:
+        PreviewPlayer(juce::AudioFormatManager& formatManager, TrackAnalyser& trackAnalyser);
+        ~PreviewPlayer() override;
+
+        // message thread; position is a fraction of the track length
+        void preview(const juce::File& file, double position);
+        void stop();
+        bool isPlaying() const;
+        juce::File getFile() const;
+        // what is being heard, as a fraction of the track length
+        double getPosition() const;
+        std::shared_ptr<const ColouredWaveform> getWaveform() const;
+
+        // audio thread
+        void prepare(double sampleRate);
+        // adds the preview to the first two channels of the bus
+        void process(juce::AudioBuffer<float>& bus, int startSample, int numSamples);
+
+        static constexpr double regionSeconds = 15.0;
+        static constexpr float gain = 0.7f;
+
+       private:
+        struct Region {
+                juce::AudioBuffer<float> samples;
+                double sampleRate = 44100.0;
+                juce::int64 startSample = 0;
+                juce::int64 trackLength = 0;
+                // of the request it was decoded for
+                juce::uint32 generation = 0;
+        };
+
+        void run() override;
+        std::unique_ptr<Region> decodeRegion(double position);
+        // audio thread, the worker frees it
+        void retire(Region* region);
+        void freeRetiredRegions();
+        // audio thread, adds the region to the bus and returns false once it has faded out
+        bool render(const Region& source, double& position, float& fade, bool fadingOut, juce::AudioBuffer<float>& bus,
+                    int startSample, int numSamples) const;
+
+        juce::AudioFormatManager& formatManager;
+        TrackAnalyser& trackAnalyser;
+
+        // message thread -> preview thread
+        juce::CriticalSection requestLock;
+        juce::File requestedFile;
+        double requestedPosition = 0.0;
+        juce::uint32 requestedGeneration = 0;
+        bool requestPending = false;
+        juce::File currentFile;
+
+        // preview thread
+        std::unique_ptr<juce::AudioFormatReader> reader;
+        juce::File readerFile;
+
+        mutable juce::CriticalSection waveformLock;
+        std::shared_ptr<const ColouredWaveform> waveform;
+
+        // bumped by every preview and stop
+        std::atomic<juce::uint32> requestGeneration{0};
+
+        // handed over without locks: the worker publishes, the audio thread swaps it in, and regions it is done
+        // with go back through a single-producer, single-consumer queue for the worker to free
+        std::atomic<Region*> pendingRegion{nullptr};
+        static constexpr int maxRetired = 16;
+        juce::AbstractFifo retiredFifo{maxRetired};
+        std::array<Region*, maxRetired> retiredRegions{};
+
+        std::atomic<bool> stopRequested{false};
+        std::atomic<bool> playing{false};
+        std::atomic<double> audiblePosition{0.0};
+
+        // audio thread
+        Region* region = nullptr;
+        double readPosition = 0.0;
+        // the region being replaced, fading out under the new one
+        Region* outgoing = nullptr;
+        double outgoingPosition = 0.0;
+        float outgoingGain = 0.0f;
+        double sampleRate = 44100.0;
+        float fadeGain = 0.0f;
+        float fadeStep = 0.0f;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PreviewPlayer)
+};
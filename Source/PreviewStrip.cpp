@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    PreviewStrip.cpp
+    Created: 19/10/2026 23:06:52
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "PreviewStrip.h"
+
+#include <JuceHeader.h>
+
+//==============================================================================
+PreviewStrip::PreviewStrip(PreviewPlayer& _previewPlayer) : previewPlayer(_previewPlayer) { startTimerHz(30); }
+
+PreviewStrip::~PreviewStrip() { stopTimer(); }
+
+void PreviewStrip::paint(juce::Graphics& g) {
+        g.fillAll(juce::Colours::black);
+
+        if (waveformImage.isValid()) {
+                g.drawImageAt(waveformImage, 0, 0);
+        }
+
+        const juce::File file = previewPlayer.getFile();
+        g.setColour(juce::Colours::ghostwhite);
+        g.setFont(12.0f);
+        g.drawText(file == juce::File() ? juce::String("Preview: select a track and press PREVIEW")
+                                        : "Preview: " + file.getFileNameWithoutExtension(),
+                   getLocalBounds().reduced(4, 0), juce::Justification::centredLeft, true);
+
+        if (playing) {
+                g.setColour(juce::Colours::yellow);
+                g.drawVerticalLine(juce::roundToInt(position * getWidth()), 0.0f, (float) getHeight());
+        }
+}
+
+void PreviewStrip::resized() { renderWaveformImage(); }
+
+void PreviewStrip::mouseDown(const juce::MouseEvent& event) { scrubTo(event); }
+
+void PreviewStrip::mouseDrag(const juce::MouseEvent& event) { scrubTo(event); }
+
+void PreviewStrip::scrubTo(const juce::MouseEvent& event) {
+        const juce::File file = previewPlayer.getFile();
+        if (file != juce::File() && getWidth() > 0) {
+                previewPlayer.preview(file, juce::jlimit(0.0, 1.0, event.position.x / (double) getWidth()));
+        }
+}
+
+void PreviewStrip::timerCallback() {
+        const auto latest = previewPlayer.getWaveform();
+        if (latest != waveform) {
+                waveform = latest;
+                renderWaveformImage();
+        }
+
+        position = previewPlayer.getPosition();
+        playing = previewPlayer.isPlaying();
+        repaint();
+}
+
+void PreviewStrip::renderWaveformImage() {
+        const int width = getWidth(), height = getHeight();
+
+        if (waveform == nullptr || waveform->getNumColumns() == 0 || width <= 0 || height <= 0) {
+                waveformImage = {};
+                return;
+        }
+
+        waveformImage = juce::Image(juce::Image::RGB, width, height, true);
+        juce::Graphics g(waveformImage);
+        g.fillAll(juce::Colours::black);
+
+        // one pixel per bar of columns, the loudest column in the bar sets its height
+        const int numColumns = waveform->getNumColumns();
+        const float centre = height / 2.0f;
+
+        for (int x = 0; x < width; ++x) {
+                const int first = (int) ((juce::int64) x * numColumns / width);
+                const int last = juce::jmax(first + 1, (int) ((juce::int64) (x + 1) * numColumns / width));
+
+                int peak = 0, low = 0, mid = 0, high = 0;
+                for (int column = first; column < last && column < numColumns; ++column) {
+                        peak = juce::jmax(peak, (int) waveform->peaks[(size_t) column]);
+                        low += waveform->lows[(size_t) column];
+                        mid += waveform->mids[(size_t) column];
+                        high += waveform->highs[(size_t) column];
+                }
+
+                // same colouring as the deck waveform, dimmed so the title stays readable
+                const float strongest = (float) juce::jmax(1, low, mid, high);
+                g.setColour(juce::Colour::fromFloatRGBA(low / strongest, mid / strongest, high / strongest, 0.6f));
+
+                const float halfHeight = centre * peak / 255.0f;
+                g.drawVerticalLine(x, centre - halfHeight, centre + halfHeight);
+        }
+}
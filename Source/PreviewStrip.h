@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    PreviewStrip.h
+    Created: 19/10/2026 23:06:52
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "PreviewPlayer.h"
+
+//==============================================================================
+/*
+ * Scrub bar for the preview player: the cached overview waveform of the track
+ * being previewed, drawn at the strip's own low resolution, with the preview
+ * playhead. Clicking or dragging moves the preview there.
+ */
+class PreviewStrip : public juce::Component, private juce::Timer {
+       public:
+        explicit PreviewStrip(PreviewPlayer& previewPlayer);
+        ~PreviewStrip() override;
+
+        void paint(juce::Graphics&) override;
+        void resized() override;
+        void mouseDown(const juce::MouseEvent& event) override;
+        void mouseDrag(const juce::MouseEvent& event) override;
+
+       private:
+        void timerCallback() override;
+        void renderWaveformImage();
+        void scrubTo(const juce::MouseEvent& event);
+
+        PreviewPlayer& previewPlayer;
+
+        std::shared_ptr<const ColouredWaveform> waveform;
+        juce::Image waveformImage;
+        double position = 0.0;
+        bool playing = false;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PreviewStrip)
+};
@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+    Created: 19/10/2026 19:24:10
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+
+#if OTODECK_RT_SAFETY_CHECKS
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <cstdio>
+#include <unordered_set>
+
+namespace {
+// constant-initialised, so reading them never allocates, even from inside malloc
+thread_local bool isAudioThread = false;
+thread_local bool isReporting = false;
+thread_local bool isExempt = false;
+
+std::atomic<juce::int64> violationCount{0};
+
+void reportViolation(const char* call) {
+        // the report allocates and locks itself, none of that counts
+        isReporting = true;
+        violationCount.fetch_add(1);
+
+        static juce::SpinLock reportedLock;
+        static std::unordered_set<juce::uint64> reported;
+
+        const juce::String trace = juce::SystemStats::getStackBacktrace();
+        const juce::uint64 key = (juce::uint64) trace.hashCode64() ^ (juce::uint64) juce::String(call).hashCode64();
+
+        bool isNew = false;
+        {
+                const juce::SpinLock::ScopedLockType lock(reportedLock);
+                isNew = reported.insert(key).second;
+        }
+
+        if (isNew) {
+                std::fprintf(stderr, "Real-time safety violation: %s on the audio thread\n%s\n", call,
+                             trace.toRawUTF8());
+                std::fflush(stderr);
+        }
+
+        isReporting = false;
+}
+
+inline void check(const char* call) {
+        if (isAudioThread && !isReporting && !isExempt) {
+                reportViolation(call);
+        }
+}
+}        // namespace
+
+namespace RealtimeSafety {
+ScopedAudioThread::ScopedAudioThread() : wasAudioThread(isAudioThread) { isAudioThread = true; }
+
+ScopedAudioThread::~ScopedAudioThread() { isAudioThread = wasAudioThread; }
+
+ScopedExemption::ScopedExemption() : wasExempt(isExempt) { isExempt = true; }
+
+ScopedExemption::~ScopedExemption() { isExempt = wasExempt; }
+
+juce::int64 getViolationCount() { return violationCount.load(); }
+}        // namespace RealtimeSafety
+
+//==============================================================================
+#if JUCE_LINUX
+#include <dlfcn.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+// glibc's own allocator entry points, so malloc is reached without going through dlsym
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void __libc_free(void*);
+}
+
+namespace {
+// the rest are looked up once; dlsym only allocates, which the wrappers above already handle
+template <typename Function>
+Function findNext(std::atomic<Function>& cached, const char* name) {
+        Function function = cached.load(std::memory_order_relaxed);
+        if (function == nullptr) {
+                function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+                cached.store(function, std::memory_order_relaxed);
+        }
+        return function;
+}
+
+// on x86-64 plain dlsym finds the old GLIBC_2.2.5 condition variables, which misread a pthread_cond_t
+// set up by the current GLIBC_2.3.2 ones the callers link against; newer ports only have one version
+template <typename Function>
+Function findNextCondition(std::atomic<Function>& cached, const char* name) {
+        Function function = cached.load(std::memory_order_relaxed);
+        if (function == nullptr) {
+                function = reinterpret_cast<Function>(dlvsym(RTLD_NEXT, name, "GLIBC_2.3.2"));
+                if (function == nullptr) {
+                        function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+                }
+                cached.store(function, std::memory_order_relaxed);
+        }
+        return function;
+}
+}        // namespace
+
+extern "C" {
+void* malloc(size_t size) {
+        check("malloc");
+        return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+        check("calloc");
+        return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+        check("realloc");
+        return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) {
+        if (pointer != nullptr) {
+                check("free");
+        }
+        __libc_free(pointer);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+        static std::atomic<int (*)(pthread_mutex_t*)> next{nullptr};
+        check("pthread_mutex_lock");
+        return findNext(next, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex) {
+        static std::atomic<int (*)(pthread_cond_t*, pthread_mutex_t*)> next{nullptr};
+        check("pthread_cond_wait");
+        return findNextCondition(next, "pthread_cond_wait")(condition, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time) {
+        static std::atomic<int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*)> next{nullptr};
+        check("pthread_cond_timedwait");
+        return findNextCondition(next, "pthread_cond_timedwait")(condition, mutex, time);
+}
+
+int nanosleep(const struct timespec* request, struct timespec* remaining) {
+        static std::atomic<int (*)(const struct timespec*, struct timespec*)> next{nullptr};
+        check("nanosleep");
+        return findNext(next, "nanosleep")(request, remaining);
+}
+
+int usleep(useconds_t microseconds) {
+        static std::atomic<int (*)(useconds_t)> next{nullptr};
+        check("usleep");
+        return findNext(next, "usleep")(microseconds);
+}
+
+ssize_t read(int fd, void* buffer, size_t count) {
+        static std::atomic<ssize_t (*)(int, void*, size_t)> next{nullptr};
+        check("read");
+        return findNext(next, "read")(fd, buffer, count);
+}
+
+ssize_t write(int fd, const void* buffer, size_t count) {
+        static std::atomic<ssize_t (*)(int, const void*, size_t)> next{nullptr};
+        check("write");
+        return findNext(next, "write")(fd, buffer, count);
+}
+}
+#endif        // JUCE_LINUX
+
+#endif        // OTODECK_RT_SAFETY_CHECKS
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Created: 19/10/2026 19:24:10
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Set to 1 in the exporter's preprocessor definitions for a checking build.
+#ifndef OTODECK_RT_SAFETY_CHECKS
+#define OTODECK_RT_SAFETY_CHECKS 0
+#endif
+
+//==============================================================================
+/*
+ * Real-time safety checking for the audio callback.
+ *
+ * In a build with OTODECK_RT_SAFETY_CHECKS=1 on Linux, malloc, calloc,
+ * realloc, free, mutex locks, condition waits, sleeps and read/write are
+ * interposed. While a ScopedAudioThread is alive on a thread, each call to
+ * one of them is counted and reported on stderr once per distinct stack
+ * trace. Everything that allocates or locks is caught at its source this way:
+ * copying an AudioBuffer, posting to the message thread with callAsync (which
+ * allocates the message and takes the queue lock) or taking a CriticalSection.
+ *
+ * In normal builds all of this compiles to nothing.
+ */
+namespace RealtimeSafety {
+#if OTODECK_RT_SAFETY_CHECKS
+// marks the calling thread as the audio thread for the lifetime of the object
+class ScopedAudioThread {
+       public:
+        ScopedAudioThread();
+        ~ScopedAudioThread();
+
+       private:
+        bool wasAudioThread;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedAudioThread)
+};
+
+// stops counting on the calling thread for the lifetime of the object, for one-time setup the
+// audio thread cannot avoid, such as registering a thread_local destructor on its first trace marker
+class ScopedExemption {
+       public:
+        ScopedExemption();
+        ~ScopedExemption();
+
+       private:
+        bool wasExempt;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedExemption)
+};
+
+// violations seen since startup, including repeats of an already reported trace
+juce::int64 getViolationCount();
+#else
+class ScopedAudioThread {
+       public:
+        ScopedAudioThread() {}
+};
+
+class ScopedExemption {
+       public:
+        ScopedExemption() {}
+};
+
+inline juce::int64 getViolationCount() { return 0; }
+#endif
+}        // namespace RealtimeSafety
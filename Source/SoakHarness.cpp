@@ -0,0 +1,426 @@
+/*
+  ==============================================================================
+
+    SoakHarness.cpp
+    Created: 20/10/2026 00:12:45
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "SoakHarness.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <iostream>
+
+#include "RealtimeSafety.h"
+#include "TestSupport.h"
+
+namespace {
+const char* const resultsFileName = "soakResults.csv";
+
+// the baseline for growth checks is taken once this much of the run is over
+const double warmUpFraction = 0.2;
+const juce::int64 maxMemoryGrowthBytes = 32 * 1024 * 1024;
+const int maxHandleGrowth = 8;
+const int maxThreadGrowth = 4;
+// of all callbacks
+const double maxXrunRatio = 0.001;
+// of the block period
+const double maxP99Load = 0.5;
+// against the best 99th percentile of earlier runs
+const double maxP99Regression = 1.5;
+}        // namespace
+
+//==============================================================================
+SoakHarness::ScratchDirectory::ScratchDirectory()
+    : launchDirectory(juce::File::getCurrentWorkingDirectory()),
+      directory(juce::File::getSpecialLocation(juce::File::tempDirectory)
+                    .getNonexistentChildFile("otodeck-soak", "", false)) {
+        const juce::File fixtureDirectory = directory.getChildFile("fixtures");
+        fixtureDirectory.createDirectory();
+        directory.setAsCurrentWorkingDirectory();
+
+        juce::String library;
+        for (int index = 0; index < numFixtures; ++index) {
+                const juce::File file = fixtureDirectory.getChildFile("fixture" + juce::String(index) + ".wav");
+                if (writeFixture(file, index)) {
+                        fixtures.add(file);
+                        library << file.getFullPathName() << ",0:00,,\n";
+                }
+        }
+
+        // the library starts with every fixture, and the watched folder brings back rewritten ones
+        directory.getChildFile("audioLibrary.csv").replaceWithText(library);
+        directory.getChildFile("watchedFolders.txt").replaceWithText(fixtureDirectory.getFullPathName() + "\n");
+}
+
+SoakHarness::ScratchDirectory::~ScratchDirectory() {
+        launchDirectory.setAsCurrentWorkingDirectory();
+        directory.deleteRecursively();
+}
+
+bool SoakHarness::writeFixture(const juce::File& file, int index) {
+        const double seconds = 20.0 + 8.0 * index;
+        const double bpm = 118.0 + 3.0 * index;
+
+        const TestSupport::Pulse kick{bpm, 55.0, 0.08, 0.8};
+        double tonePhase = 0.0;
+
+        auto frame = [&](double t, double& left, double& right) {
+                tonePhase += juce::MathConstants<double>::twoPi * (220.0 + 20.0 * index) / sampleRate;
+                const double beat = kick.getSample(t);
+                left = beat + 0.1 * std::sin(tonePhase);
+                right = beat + 0.1 * std::cos(tonePhase);
+        };
+        const juce::AudioBuffer<float> buffer = TestSupport::synthesise(2, seconds, sampleRate, frame);
+
+        juce::TemporaryFile temporary(file);
+        {
+                std::unique_ptr<juce::OutputStream> stream = temporary.getFile().createOutputStream();
+                if (stream == nullptr) {
+                        return false;
+                }
+
+                juce::WavAudioFormat wav;
+                std::unique_ptr<juce::AudioFormatWriter> writer(
+                    wav.createWriterFor(stream.get(), sampleRate, 2, 16, {}, 0));
+                if (writer == nullptr) {
+                        return false;
+                }
+                stream.release();
+
+                if (!writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples())) {
+                        return false;
+                }
+        }
+        return temporary.overwriteTargetFileWithTemporary();
+}
+
+//==============================================================================
+std::unique_ptr<SoakHarness> SoakHarness::createFromCommandLine(const juce::String& commandLine) {
+        double minutes = 0.0;
+        if (!TestSupport::findFlag(commandLine, "--soak", 60.0, minutes)) {
+                return nullptr;
+        }
+
+        return std::unique_ptr<SoakHarness>(new SoakHarness(minutes));
+}
+
+SoakHarness::SoakHarness(double minutes)
+    : juce::Thread("Soak audio device"),
+      durationMs(minutes * 60.0 * 1000.0),
+      startMs(juce::Time::getMillisecondCounterHiRes()),
+      callbackHistogram((size_t) histogramSize, 0) {
+        formatManager.registerBasicFormats();
+        memoryGovernor.addClient(&decodedAudioCache);
+        memoryGovernor.addClient(&trackAnalyser);
+        memoryGovernor.addClient(&thumbnailCache);
+
+        // the panes lay out and paint as they would in the window, without being on screen
+        assemblePane1.setSize(600, 420);
+        assemblePane2.setSize(600, 420);
+        playlistComponent.setSize(1200, 200);
+
+        player1.prepareToPlay(blockSize, sampleRate);
+        player2.prepareToPlay(blockSize, sampleRate);
+        autoDJ.prepare(sampleRate);
+        previewPlayer.prepare(sampleRate);
+        mixerSource.prepareToPlay(blockSize, sampleRate);
+        mixerSource.addInputSource(&autoDJ.getDeckOutput(0), false);
+        mixerSource.addInputSource(&autoDJ.getDeckOutput(1), false);
+        output.setSize(2, blockSize);
+
+        violationsAtStart = RealtimeSafety::getViolationCount();
+        std::cout << "Soak: " << minutes << " minutes in " << scratch.directory.getFullPathName() << std::endl;
+
+        startThread();
+        // time-compressed, a DJ does not touch the decks fifty times a second
+        startTimer(20);
+}
+
+SoakHarness::~SoakHarness() {
+        stopTimer();
+        stopThread(5000);
+
+        mixerSource.removeAllInputs();
+        mixerSource.releaseResources();
+        player1.releaseResources();
+        player2.releaseResources();
+        memoryGovernor.removeClient(&decodedAudioCache);
+        memoryGovernor.removeClient(&trackAnalyser);
+        memoryGovernor.removeClient(&thumbnailCache);
+}
+
+//==============================================================================
+void SoakHarness::run() {
+        const double periodMs = 1000.0 * blockSize / sampleRate;
+
+        while (!threadShouldExit()) {
+                const RealtimeSafety::ScopedAudioThread realtimeScope;
+                const juce::int64 start = juce::Time::getHighResolutionTicks();
+
+                autoDJ.process(blockSize);
+                mixerSource.getNextAudioBlock(juce::AudioSourceChannelInfo(&output, 0, blockSize));
+                previewPlayer.process(output, 0, blockSize);
+
+                const double elapsedMs =
+                    juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0;
+
+                ++callbackHistogram[(size_t) juce::jlimit(0, histogramSize - 1, (int) (elapsedMs * 1000.0))];
+                callbacks.fetch_add(1);
+                if (elapsedMs > periodMs) {
+                        xruns.fetch_add(1);
+                }
+
+                for (int channel = 0; channel < output.getNumChannels(); ++channel) {
+                        const float* data = output.getReadPointer(channel);
+                        bool finite = true;
+                        for (int i = 0; i < blockSize; ++i) {
+                                finite = finite && std::isfinite(data[i]);
+                        }
+                        if (!finite) {
+                                nonFiniteBlocks.fetch_add(1);
+                                break;
+                        }
+                }
+        }
+}
+
+void SoakHarness::timerCallback() {
+        const double elapsedMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+
+        if (elapsedMs >= durationMs) {
+                finish();
+                return;
+        }
+
+        performRandomOperation();
+        memoryGovernor.enforceBudget();
+
+        if (!baselineTaken && elapsedMs >= durationMs * warmUpFraction) {
+                baseline = readProcessStats();
+                baselineTaken = true;
+        }
+
+        if (elapsedMs - lastReportMs >= 60000.0) {
+                lastReportMs = elapsedMs;
+                const ProcessStats stats = readProcessStats();
+                std::cout << "Soak: " << juce::roundToInt(elapsedMs / 60000.0) << " min, " << operations
+                          << " operations, " << callbacks.load() << " callbacks, " << xruns.load() << " xruns, "
+                          << stats.residentBytes / (1024 * 1024) << " MB resident, " << stats.handles << " handles, "
+                          << stats.threads << " threads" << std::endl;
+        }
+}
+
+void SoakHarness::performRandomOperation() {
+        ++operations;
+
+        const int deck = random.nextInt(2);
+        AudioPlayer& player = deck == 0 ? player1 : player2;
+        AssemblePane& pane = deck == 0 ? assemblePane1 : assemblePane2;
+        const juce::File fixture =
+            scratch.fixtures.isEmpty() ? juce::File() : scratch.fixtures[random.nextInt(scratch.fixtures.size())];
+
+        switch (random.nextInt(12)) {
+                case 0:
+                        if (fixture != juce::File()) {
+                                pane.loadFile(juce::URL{fixture});
+                        }
+                        break;
+                case 1:
+                        if (player.isPlaying()) {
+                                player.stop();
+                        } else {
+                                player.start();
+                        }
+                        break;
+                case 2:
+                        player.setPositionRelative(random.nextDouble());
+                        break;
+                case 3: {
+                        const float gain = juce::Decibels::decibelsToGain(random.nextFloat() * 24.0f - 12.0f);
+                        const int band = random.nextInt(4);
+                        if (band == 0) {
+                                player.setBassGain(gain);
+                        } else if (band == 1) {
+                                player.setMidGain(gain);
+                        } else if (band == 2) {
+                                player.setTrebleGain(gain);
+                        } else {
+                                player.setFilterPosition(random.nextFloat() * 2.0f - 1.0f);
+                        }
+                        break;
+                }
+                case 4:
+                        player.setSpeed(0.5 + random.nextDouble());
+                        break;
+                case 5:
+                        player.setKeyLockEnabled(!player.isKeyLockEnabled());
+                        break;
+                case 6:
+                        if (random.nextBool()) {
+                                player.setBeatLoop(std::pow(2.0, random.nextInt(5) - 2));
+                        } else {
+                                player.exitLoop();
+                        }
+                        break;
+                case 7: {
+                        // the same path as pressing a row's delete button
+                        const int numRows = playlistComponent.getNumRows();
+                        if (numRows > 0) {
+                                std::unique_ptr<juce::Component> cell(
+                                    playlistComponent.refreshComponentForCell(random.nextInt(numRows), 3, false, nullptr));
+                                if (auto* button = dynamic_cast<juce::Button*>(cell.get())) {
+                                        playlistComponent.buttonClicked(button);
+                                }
+                        }
+                        break;
+                }
+                case 8:
+                        // the watcher picks the rewritten file up and puts a deleted row back
+                        if (fixture != juce::File()) {
+                                writeFixture(fixture, scratch.fixtures.indexOf(fixture));
+                        }
+                        break;
+                case 9:
+                        if (fixture != juce::File() && random.nextBool()) {
+                                previewPlayer.preview(fixture, random.nextDouble());
+                        } else {
+                                previewPlayer.stop();
+                        }
+                        break;
+                case 10:
+                        if (fixture != juce::File() && random.nextInt(4) > 0) {
+                                autoDJ.enqueue(fixture);
+                        } else {
+                                autoDJ.setEnabled(!autoDJ.isEnabled());
+                        }
+                        break;
+                default:
+                        // paints everything, waveform and meter included, into an image
+                        pane.createComponentSnapshot(pane.getLocalBounds());
+                        break;
+        }
+}
+
+//==============================================================================
+SoakHarness::ProcessStats SoakHarness::readProcessStats() {
+        ProcessStats stats;
+#if JUCE_LINUX
+        juce::StringArray lines;
+        lines.addLines(juce::File("/proc/self/status").loadFileAsString());
+
+        for (const juce::String& line : lines) {
+                const juce::String value = line.fromFirstOccurrenceOf(":", false, false).trim();
+                if (line.startsWith("VmRSS:")) {
+                        stats.residentBytes = value.getLargeIntValue() * 1024;
+                } else if (line.startsWith("Threads:")) {
+                        stats.threads = value.getIntValue();
+                }
+        }
+        stats.handles = juce::File("/proc/self/fd").getNumberOfChildFiles(juce::File::findFilesAndDirectories);
+#endif
+        return stats;
+}
+
+int SoakHarness::getPercentile(double fraction) const {
+        juce::int64 total = 0;
+        for (juce::uint32 count : callbackHistogram) {
+                total += count;
+        }
+
+        const juce::int64 target = (juce::int64) std::ceil(fraction * total);
+        juce::int64 seen = 0;
+
+        for (int bucket = 0; bucket < histogramSize; ++bucket) {
+                seen += callbackHistogram[(size_t) bucket];
+                if (seen >= target && seen > 0) {
+                        return bucket;
+                }
+        }
+        return histogramSize - 1;
+}
+
+void SoakHarness::finish() {
+        stopTimer();
+        stopThread(5000);
+
+        const ProcessStats stats = readProcessStats();
+        const double periodUs = 1.0e6 * blockSize / sampleRate;
+        const juce::int64 totalCallbacks = callbacks.load();
+        const int p50 = getPercentile(0.5), p99 = getPercentile(0.99), p999 = getPercentile(0.999);
+
+        int maxUs = 0;
+        for (int bucket = histogramSize - 1; bucket >= 0; --bucket) {
+                if (callbackHistogram[(size_t) bucket] > 0) {
+                        maxUs = bucket;
+                        break;
+                }
+        }
+
+        // the best 99th percentile of earlier runs, fifth column of the results file
+        const juce::File resultsFile = scratch.launchDirectory.getChildFile(resultsFileName);
+        juce::StringArray previousRuns;
+        previousRuns.addLines(resultsFile.loadFileAsString());
+        int bestP99 = 0;
+        for (const juce::String& line : previousRuns) {
+                const int previous = juce::StringArray::fromTokens(line, ",", "")[4].getIntValue();
+                if (previous > 0 && (bestP99 == 0 || previous < bestP99)) {
+                        bestP99 = previous;
+                }
+        }
+
+        juce::StringArray failures;
+        auto check = [&failures](bool passed, const juce::String& failure) {
+                if (!passed) {
+                        failures.add(failure);
+                }
+        };
+
+        check(totalCallbacks > 0, "no callbacks were rendered");
+        check(nonFiniteBlocks.load() == 0, juce::String(nonFiniteBlocks.load()) + " blocks with NaN or inf");
+        check(xruns.load() <= maxXrunRatio * totalCallbacks, juce::String(xruns.load()) + " xruns");
+        check(p99 <= maxP99Load * periodUs, "99th percentile callback " + juce::String(p99) + " us");
+        check(bestP99 == 0 || p99 <= maxP99Regression * bestP99,
+              "99th percentile regressed from " + juce::String(bestP99) + " us to " + juce::String(p99) + " us");
+        check(RealtimeSafety::getViolationCount() == violationsAtStart, "real-time safety violations");
+
+        if (baselineTaken && stats.residentBytes >= 0) {
+                check(stats.residentBytes - baseline.residentBytes <= maxMemoryGrowthBytes,
+                      "resident memory grew by " +
+                          juce::String((stats.residentBytes - baseline.residentBytes) / 1024) + " KB");
+                check(stats.handles - baseline.handles <= maxHandleGrowth,
+                      "open handles grew by " + juce::String(stats.handles - baseline.handles));
+                check(stats.threads - baseline.threads <= maxThreadGrowth,
+                      "threads grew by " + juce::String(stats.threads - baseline.threads));
+        }
+
+        // date,minutes,callbacks,xruns,p99,p50,p99.9,max (us),memory growth (KB),handle growth,thread growth,
+        // operations,failures
+        const juce::String row =
+            juce::Time::getCurrentTime().toISO8601(true) + "," + juce::String(durationMs / 60000.0, 1) + "," +
+            juce::String(totalCallbacks) + "," + juce::String(xruns.load()) + "," + juce::String(p99) + "," +
+            juce::String(p50) + "," + juce::String(p999) + "," + juce::String(maxUs) + "," +
+            juce::String(baselineTaken ? (stats.residentBytes - baseline.residentBytes) / 1024 : 0) + "," +
+            juce::String(baselineTaken ? stats.handles - baseline.handles : 0) + "," +
+            juce::String(baselineTaken ? stats.threads - baseline.threads : 0) + "," + juce::String(operations) + "," +
+            juce::String(failures.size()) + "\n";
+        resultsFile.appendText(row);
+
+        std::cout << "Soak: " << totalCallbacks << " callbacks (" << juce::String(totalCallbacks * periodUs / 3.6e9, 2)
+                  << " h of audio), " << xruns.load() << " xruns, callback p50 " << p50 << " us, p99 " << p99
+                  << " us, p99.9 " << p999 << " us, max " << maxUs << " us, period " << juce::roundToInt(periodUs)
+                  << " us" << std::endl;
+        for (const juce::String& failure : failures) {
+                std::cout << "Soak: FAIL, " << failure << std::endl;
+        }
+        std::cout << "Soak: " << (failures.isEmpty() ? "passed" : "failed") << std::endl;
+
+        if (auto* app = juce::JUCEApplicationBase::getInstance()) {
+                app->setApplicationReturnValue(failures.size());
+        }
+        juce::JUCEApplicationBase::quit();
+}
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    SoakHarness.h
+    Created: 20/10/2026 00:12:45
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <vector>
+
+#include "AssemblePane.h"
+#include "AudioPlayer.h"
+#include "AutoDJ.h"
+#include "DecodedAudioCache.h"
+#include "MemoryGovernor.h"
+#include "PlaylistComponent.h"
+#include "PreviewPlayer.h"
+#include "ThumbnailCacheClient.h"
+#include "TrackAnalyser.h"
+
+//==============================================================================
+/*
+ * Headless soak test. "--soak [minutes]" (default 60) builds the decks, the
+ * playlist and Auto DJ as the app does, in a scratch working directory with
+ * synthetic fixture tracks, and drives them with random loads, seeks, EQ, filter
+ * and speed changes, key lock, loops, previews, row deletions and rewritten files
+ * at fifty operations a second.
+ *
+ * A dummy device thread renders the mix back to back, as fast as it can, so
+ * an hour of wall time is many hours of audio. Every callback is timed; one
+ * that takes longer than its own period counts as an xrun. Resident memory,
+ * open file handles and threads are sampled throughout.
+ *
+ * The run fails on non-finite output, on growth of memory, handles or threads
+ * after the warm-up, on xruns or a slow 99th percentile callback, or on a
+ * 99th percentile well above the best earlier run in soakResults.csv. The
+ * exit code is the number of failed checks.
+ */
+class SoakHarness : private juce::Thread, private juce::Timer {
+       public:
+        // nullptr when the command line does not ask for a soak run
+        static std::unique_ptr<SoakHarness> createFromCommandLine(const juce::String& commandLine);
+        ~SoakHarness() override;
+
+       private:
+        explicit SoakHarness(double minutes);
+
+        // switches to a scratch directory before anything reads the library, and back at the very end
+        struct ScratchDirectory {
+                ScratchDirectory();
+                ~ScratchDirectory();
+
+                const juce::File launchDirectory;
+                const juce::File directory;
+                // listed in the scratch library and in a watched folder
+                juce::Array<juce::File> fixtures;
+        };
+
+        struct ProcessStats {
+                // -1 where the platform does not report it
+                juce::int64 residentBytes = -1;
+                int handles = -1;
+                int threads = -1;
+        };
+
+        // the dummy audio device
+        void run() override;
+        void timerCallback() override;
+        void performRandomOperation();
+        void finish();
+
+        static ProcessStats readProcessStats();
+        // a synthetic track with a steady kick, written next to the file and moved over it
+        static bool writeFixture(const juce::File& file, int index);
+        // microseconds below which the given fraction of callbacks finished
+        int getPercentile(double fraction) const;
+
+        static constexpr int blockSize = 512;
+        static constexpr double sampleRate = 44100.0;
+        static constexpr int numFixtures = 6;
+        // 1 µs buckets, anything slower lands in the last one
+        static constexpr int histogramSize = 50000;
+
+        ScratchDirectory scratch;
+        const double durationMs;
+        const double startMs;
+        juce::Random random;
+
+        juce::AudioFormatManager formatManager;
+        // smaller than the app's budgets, so the caches are full and evicting long before the warm-up ends
+        MemoryGovernor memoryGovernor{256 * 1024 * 1024};
+        ThumbnailCacheClient thumbnailCache{10};
+        DecodedAudioCache decodedAudioCache{memoryGovernor.getBudget()};
+        TrackAnalyser trackAnalyser;
+
+        AudioPlayer player1{formatManager, decodedAudioCache, trackAnalyser};
+        AudioPlayer player2{formatManager, decodedAudioCache, trackAnalyser};
+        AssemblePane assemblePane1{&player1, formatManager, thumbnailCache, trackAnalyser, memoryGovernor};
+        AssemblePane assemblePane2{&player2, formatManager, thumbnailCache, trackAnalyser, memoryGovernor};
+        PreviewPlayer previewPlayer{formatManager, trackAnalyser};
+        AutoDJ autoDJ{player1, player2, assemblePane1, assemblePane2, trackAnalyser};
+        PlaylistComponent playlistComponent{&assemblePane1,    &assemblePane2, &previewPlayer,
+                                            decodedAudioCache, formatManager,  &autoDJ};
+
+        juce::MixerAudioSource mixerSource;
+
+        // dummy device thread, read once it has stopped
+        juce::AudioBuffer<float> output;
+        std::vector<juce::uint32> callbackHistogram;
+        std::atomic<juce::int64> callbacks{0};
+        std::atomic<juce::int64> xruns{0};
+        std::atomic<juce::int64> nonFiniteBlocks{0};
+
+        // message thread
+        ProcessStats baseline;
+        bool baselineTaken = false;
+        juce::int64 operations = 0;
+        double lastReportMs = 0.0;
+        juce::int64 violationsAtStart = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoakHarness)
+};
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    StartupMetrics.cpp
+    Created: 19/10/2026 22:41:37
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "StartupMetrics.h"
+
+#include <JuceHeader.h>
+
+#include <atomic>
+
+#include "Log.h"
+
+namespace {
+const char* const metricsFileName = "startupMetrics.csv";
+// without an audio device there is never a first callback
+const double audioTimeoutMs = 10000.0;
+
+std::atomic<double> launchMs{0.0};
+std::atomic<double> firstFrameMs{-1.0};
+std::atomic<double> firstAudioMs{-1.0};
+double libraryMs = -1.0;
+int libraryTracks = 0;
+bool recorded = false;
+juce::String summary;
+
+double sinceLaunch() { return juce::Time::getMillisecondCounterHiRes() - launchMs.load(); }
+
+juce::String formatMs(double ms) { return ms >= 0.0 ? juce::String(ms, 1) : juce::String(); }
+}        // namespace
+
+//==============================================================================
+void StartupMetrics::markLaunch() { launchMs.store(juce::Time::getMillisecondCounterHiRes()); }
+
+void StartupMetrics::markFirstFrame() {
+        if (firstFrameMs.load() < 0.0) {
+                firstFrameMs.store(sinceLaunch());
+        }
+}
+
+void StartupMetrics::markFirstAudio() {
+        if (firstAudioMs.load(std::memory_order_relaxed) < 0.0) {
+                firstAudioMs.store(sinceLaunch(), std::memory_order_relaxed);
+        }
+}
+
+void StartupMetrics::markLibraryLoaded(int numTracks) {
+        if (libraryMs < 0.0) {
+                libraryMs = sinceLaunch();
+                libraryTracks = numTracks;
+        }
+}
+
+void StartupMetrics::recordWhenComplete() {
+        const double frame = firstFrameMs.load();
+        const double audio = firstAudioMs.load();
+
+        if (recorded || frame < 0.0 || libraryMs < 0.0 || (audio < 0.0 && sinceLaunch() < audioTimeoutMs)) {
+                return;
+        }
+        recorded = true;
+
+        // date,first frame,first audio,library loaded,tracks; first audio is empty when there was none
+        const juce::File file = juce::File::getCurrentWorkingDirectory().getChildFile(metricsFileName);
+        file.appendText(juce::Time::getCurrentTime().toISO8601(true) + "," + formatMs(frame) + "," +
+                        formatMs(audio) + "," + formatMs(libraryMs) + "," + juce::String(libraryTracks) + "\n");
+
+        summary = "Startup: frame " + juce::String(juce::roundToInt(frame)) + " ms, audio " +
+                  (audio >= 0.0 ? juce::String(juce::roundToInt(audio)) + " ms" : juce::String("none")) +
+                  ", library " + juce::String(juce::roundToInt(libraryMs)) + " ms";
+        OTODECK_LOG(info, "StartupMetrics", summary);
+}
+
+juce::String StartupMetrics::getSummary() { return summary; }
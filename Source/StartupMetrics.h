@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    StartupMetrics.h
+    Created: 19/10/2026 22:41:37
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+ * Launch timings, all in milliseconds from the start of initialise(): time to
+ * the first painted frame, to the first audio callback and to the library
+ * being fully loaded. Every launch appends one row to startupMetrics.csv, so
+ * a slower startup shows up next to the launches before it.
+ */
+namespace StartupMetrics {
+void markLaunch();
+// message thread, the first call counts
+void markFirstFrame();
+// audio thread, lock-free and allocation-free
+void markFirstAudio();
+void markLibraryLoaded(int numTracks);
+
+// message thread, called periodically; writes the row once everything is in, or once waiting for audio has
+// timed out (no device)
+void recordWhenComplete();
+
+// empty until the row is written
+juce::String getSummary();
+}        // namespace StartupMetrics
@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    SyncDriftTest.cpp
+    Created: 20/10/2026 02:31:09
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "SyncDriftTest.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "AudioPlayer.h"
+#include "BeatSync.h"
+#include "DecodedAudioCache.h"
+#include "TestSupport.h"
+#include "TrackAnalyser.h"
+
+namespace {
+const double sampleRate = 44100.0;
+const int blockSize = 512;
+
+const double leaderBpm = 120.0;
+const double followerBpm = 126.0;
+// the follower starts a quarter beat off, so the correction has something to pull in
+const double followerStartSeconds = 0.12;
+
+// the pull-in runs at the nudge limit for about three seconds, then the integral term settles over a few more
+const double settleSeconds = 20.0;
+// "sub-millisecond" from the request, and half of it for slow drift over the run
+const double maxPhaseErrorMs = 1.0;
+const double maxDriftMs = 0.5;
+
+// well above the noise floor and low on the click's first rise, so its delay is a few microseconds
+const float onsetThreshold = 0.1f;
+// half the leader's beat, so one click is only ever seen once
+const double onsetHoldOffSeconds = 0.25;
+
+// a short decaying 1 kHz click on every beat, mono to keep long fixtures small
+std::shared_ptr<const DecodedTrack> makeClickTrack(const juce::String& key, double bpm, double seconds) {
+        const TestSupport::Pulse click{bpm, 1000.0, 0.01, 0.8};
+        auto frame = [&](double t, double& left, double&) { left = click.getSample(t); };
+        return TestSupport::makeDecodedTrack(key, TestSupport::synthesise(1, seconds, sampleRate, frame), sampleRate);
+}
+
+// the deck reads its beat grid from the analyser, so the analysis has to be done before it is loaded for good
+bool loadAnalysed(AudioPlayer& player, TrackAnalyser& trackAnalyser, const std::shared_ptr<const DecodedTrack>& track) {
+        const double deadline = juce::Time::getMillisecondCounterHiRes() + 120000.0;
+
+        while (trackAnalyser.requestAnalysis(track) == nullptr) {
+                if (juce::Time::getMillisecondCounterHiRes() > deadline) {
+                        return false;
+                }
+                juce::Thread::sleep(20);
+        }
+
+        player.loadTrack(track);
+        return player.getBeatGrid().isValid();
+}
+
+// click onsets in one deck's rendered output, in output samples to a fraction of a sample
+class OnsetDetector {
+       public:
+        void process(const float* samples, int numSamples, juce::int64 blockStart) {
+                for (int i = 0; i < numSamples; ++i) {
+                        const float level = std::abs(samples[i]);
+                        const juce::int64 position = blockStart + i;
+
+                        if (position >= armedAt && level >= onsetThreshold && previous < onsetThreshold) {
+                                // where the straight line between the two samples crosses the threshold
+                                const double fraction = (onsetThreshold - previous) / (level - previous);
+                                onsets.push_back((double) (position - 1) + fraction);
+                                armedAt = position + (juce::int64) (onsetHoldOffSeconds * sampleRate);
+                        }
+                        previous = level;
+                }
+        }
+
+        std::vector<double> onsets;
+
+       private:
+        float previous = 0.0f;
+        juce::int64 armedAt = 0;
+};
+
+struct Window {
+        double sum = 0.0;
+        int count = 0;
+
+        void add(double value) {
+                sum += value;
+                ++count;
+        }
+        double getMean() const { return count > 0 ? sum / count : 0.0; }
+};
+}        // namespace
+
+//==============================================================================
+namespace SyncDriftTest {
+int run(double minutes) {
+        const double renderSeconds = settleSeconds + minutes * 60.0;
+        std::cout << "Sync drift: " << minutes << " minutes, " << leaderBpm << " BPM leading " << followerBpm
+                  << " BPM" << std::endl;
+
+        const std::shared_ptr<const DecodedTrack> leaderTrack =
+            makeClickTrack("sync-drift-leader", leaderBpm, renderSeconds + 1.0);
+        const std::shared_ptr<const DecodedTrack> followerTrack =
+            makeClickTrack("sync-drift-follower", followerBpm, renderSeconds + 1.0);
+
+        juce::AudioFormatManager formatManager;
+        DecodedAudioCache decodedAudioCache{16 * 1024 * 1024};
+        TrackAnalyser trackAnalyser;
+        AudioPlayer leader{formatManager, decodedAudioCache, trackAnalyser};
+        AudioPlayer follower{formatManager, decodedAudioCache, trackAnalyser};
+        BeatSync beatSync{leader, follower};
+
+        for (AudioPlayer* player : {&leader, &follower}) {
+                player->setNonRealtime(true);
+                player->prepareToPlay(blockSize, sampleRate);
+        }
+
+        if (!loadAnalysed(leader, trackAnalyser, leaderTrack) ||
+            !loadAnalysed(follower, trackAnalyser, followerTrack)) {
+                std::cout << "FAIL, no beat grid was found for the fixtures" << std::endl;
+                return 1;
+        }
+        std::cout << "Grids: " << leader.getBeatGrid().bpm << " and " << follower.getBeatGrid().bpm << " BPM"
+                  << std::endl;
+
+        follower.setPosition(followerStartSeconds);
+        follower.setSyncEnabled(true);
+        beatSync.prepare(sampleRate);
+        leader.start();
+        follower.start();
+
+        // each deck renders on its own, so the clicks of each can be found in what it actually plays
+        juce::AudioBuffer<float> leaderBlock(2, blockSize);
+        juce::AudioBuffer<float> followerBlock(2, blockSize);
+        OnsetDetector leaderOnsets, followerOnsets;
+        Window estimate;
+
+        const juce::int64 totalBlocks = (juce::int64) (renderSeconds * sampleRate) / blockSize;
+        const juce::int64 settleBlocks = (juce::int64) (settleSeconds * sampleRate) / blockSize;
+        const double startMs = juce::Time::getMillisecondCounterHiRes();
+
+        for (juce::int64 index = 0; index < totalBlocks; ++index) {
+                beatSync.process(blockSize);
+                leaderBlock.clear();
+                followerBlock.clear();
+                leader.getNextAudioBlock(juce::AudioSourceChannelInfo(&leaderBlock, 0, blockSize));
+                follower.getNextAudioBlock(juce::AudioSourceChannelInfo(&followerBlock, 0, blockSize));
+
+                leaderOnsets.process(leaderBlock.getReadPointer(0), blockSize, index * blockSize);
+                followerOnsets.process(followerBlock.getReadPointer(0), blockSize, index * blockSize);
+
+                if (index >= settleBlocks) {
+                        estimate.add(beatSync.getPhaseErrorMs(1));
+                }
+        }
+
+        leader.releaseResources();
+        follower.releaseResources();
+
+        // each follower click against the nearest leader click, positive when the follower is late
+        const double settleSample = settleSeconds * sampleRate;
+        const double endSample = (double) (totalBlocks * blockSize);
+        const double minuteSamples = 60.0 * sampleRate;
+
+        double maxErrorMs = 0.0;
+        Window all, firstMinute, lastMinute;
+        size_t nearest = 0;
+        const std::vector<double>& leaderClicks = leaderOnsets.onsets;
+
+        for (double click : followerOnsets.onsets) {
+                if (click < settleSample || leaderClicks.empty()) {
+                        continue;
+                }
+                while (nearest + 1 < leaderClicks.size() &&
+                       std::abs(leaderClicks[nearest + 1] - click) <= std::abs(leaderClicks[nearest] - click)) {
+                        ++nearest;
+                }
+
+                const double errorMs = (click - leaderClicks[nearest]) / sampleRate * 1000.0;
+                maxErrorMs = juce::jmax(maxErrorMs, std::abs(errorMs));
+                all.add(errorMs);
+
+                if (click < settleSample + minuteSamples) {
+                        firstMinute.add(errorMs);
+                }
+                if (click >= endSample - minuteSamples) {
+                        lastMinute.add(errorMs);
+                }
+        }
+
+        // a click per beat at 120 BPM, with some slack for the ends
+        const int expectedClicks = (int) ((endSample - settleSample) / sampleRate * leaderBpm / 60.0);
+        const bool following = beatSync.isFollowing(1) && all.count >= expectedClicks - 2;
+        const double driftMs = lastMinute.getMean() - firstMinute.getMean();
+        const bool errorPassed = all.count > 0 && maxErrorMs <= maxPhaseErrorMs;
+        const bool driftPassed = std::abs(driftMs) <= maxDriftMs;
+
+        std::cout << "Rendered in " << juce::String((juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0, 1)
+                  << " s" << std::endl;
+        std::cout << "following: " << (following ? "ok" : "FAIL") << ", " << all.count << " clicks measured, "
+                  << expectedClicks << " expected" << std::endl;
+        std::cout << "max phase error: " << (errorPassed ? "ok" : "FAIL") << ", " << maxErrorMs << " ms (limit "
+                  << maxPhaseErrorMs << " ms), mean " << all.getMean() << " ms" << std::endl;
+        std::cout << "drift: " << (driftPassed ? "ok" : "FAIL") << ", " << driftMs << " ms from the first to the last minute"
+                  << " (limit " << maxDriftMs << " ms)" << std::endl;
+        std::cout << "BeatSync's own estimate from the transport positions: mean " << estimate.getMean() << " ms"
+                  << std::endl;
+
+        return (following ? 0 : 1) + (errorPassed ? 0 : 1) + (driftPassed ? 0 : 1);
+}
+
+bool runFromCommandLine(const juce::String& commandLine, int& exitCode) {
+        double minutes = 0.0;
+        if (!TestSupport::findFlag(commandLine, "--sync-drift", 10.0, minutes)) {
+                return false;
+        }
+
+        exitCode = run(minutes);
+        return true;
+}
+}        // namespace SyncDriftTest
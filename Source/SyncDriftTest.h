@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    SyncDriftTest.h
+    Created: 20/10/2026 02:31:09
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+ * Long offline render of beat sync, to catch phase drift that a few seconds
+ * of listening never shows.
+ *
+ * "--sync-drift [minutes]" (default 10) renders two synthetic click tracks at
+ * 120 and 126 BPM offline through AudioPlayer and BeatSync, the second deck
+ * following the first. Each deck renders into its own buffer and the clicks
+ * are found in that output, so the measurement covers everything between the
+ * read position and what is heard: the resampler, a wrong analysed grid, the
+ * controller's steady-state offset. It does not use BeatSync's own estimate,
+ * which comes from the same transport positions the sync steers.
+ *
+ * After a settling time every follower click is timed against the nearest
+ * leader click. The run fails when the largest error or the drift between the
+ * first and the last minute goes over its limit, or when clicks go missing.
+ * The exit code is the number of failed checks.
+ */
+namespace SyncDriftTest {
+// returns the number of failed checks
+int run(double minutes);
+
+// handles --sync-drift, false if the command line does not ask for it
+bool runFromCommandLine(const juce::String& commandLine, int& exitCode);
+}        // namespace SyncDriftTest
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    TestSupport.cpp
+    Created: 20/10/2026 03:41:55
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "TestSupport.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <utility>
+
+//==============================================================================
+double TestSupport::Pulse::getSample(double seconds) const {
+        const double sinceBeat = std::fmod(seconds, 60.0 / bpm);
+        return level * std::sin(juce::MathConstants<double>::twoPi * frequency * sinceBeat) *
+               std::exp(-sinceBeat / decaySeconds);
+}
+
+TestSupport::Hats::Hats(double _bpm, int perBeat, double _decaySeconds, double _level, juce::int64 seed)
+    : period(60.0 / _bpm / perBeat), decaySeconds(_decaySeconds), level(_level), random(seed) {}
+
+double TestSupport::Hats::getNextSample(double seconds) {
+        const double sinceHat = std::fmod(seconds + period / 2.0, period);
+        return level * (random.nextDouble() * 2.0 - 1.0) * std::exp(-sinceHat / decaySeconds);
+}
+
+//==============================================================================
+juce::AudioBuffer<float> TestSupport::synthesise(int numChannels, double seconds, double sampleRate,
+                                                 const FrameFunction& frame) {
+        const int length = (int) (seconds * sampleRate);
+        juce::AudioBuffer<float> buffer(numChannels, length);
+
+        for (int i = 0; i < length; ++i) {
+                double left = 0.0, right = 0.0;
+                frame(i / sampleRate, left, right);
+
+                buffer.setSample(0, i, (float) left);
+                if (numChannels > 1) {
+                        buffer.setSample(1, i, (float) right);
+                }
+        }
+        return buffer;
+}
+
+std::shared_ptr<const DecodedTrack> TestSupport::makeDecodedTrack(const juce::String& key,
+                                                                  juce::AudioBuffer<float> samples, double sampleRate) {
+        auto track = std::make_shared<DecodedTrack>();
+        const int length = samples.getNumSamples();
+
+        track->key = key;
+        track->sampleRate = sampleRate;
+        track->samples = std::move(samples);
+
+        track->lengthInSamples.store(length);
+        track->samplesReady.store(length);
+        track->complete.store(true);
+        return track;
+}
+
+//==============================================================================
+bool TestSupport::findFlag(const juce::String& commandLine, const juce::String& flag, juce::String& argument) {
+        const juce::StringArray arguments = juce::StringArray::fromTokens(commandLine, true);
+        const int index = arguments.indexOf(flag);
+
+        if (index < 0) {
+                return false;
+        }
+
+        // StringArray returns an empty string past the end
+        argument = arguments[index + 1].unquoted();
+        if (argument.startsWith("--")) {
+                argument = {};
+        }
+        return true;
+}
+
+bool TestSupport::findFlag(const juce::String& commandLine, const juce::String& flag, double defaultValue,
+                           double& value) {
+        juce::String argument;
+        if (!findFlag(commandLine, flag, argument)) {
+                return false;
+        }
+
+        value = argument.getDoubleValue();
+        if (!(value > 0.0)) {
+                value = defaultValue;
+        }
+        return true;
+}
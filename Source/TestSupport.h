@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    TestSupport.h
+    Created: 20/10/2026 03:41:55
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <functional>
+#include <memory>
+
+#include "DecodedAudioCache.h"
+
+//==============================================================================
+/*
+ * What the command line harnesses share: the synthetic fixture tracks and
+ * the "--flag [value]" parsing. Each harness keeps its own fixture
+ * parameters, so a change here must not change any fixture's samples, or
+ * the golden references no longer match.
+ */
+namespace TestSupport {
+// a decaying sine started on every beat: a kick at tens of Hz, a click at 1 kHz
+struct Pulse {
+        double bpm;
+        double frequency;
+        double decaySeconds;
+        double level;
+
+        double getSample(double seconds) const;
+};
+
+// a burst of noise halfway between two of perBeat ticks a beat
+class Hats {
+       public:
+        Hats(double _bpm, int perBeat, double _decaySeconds, double _level, juce::int64 seed);
+
+        // takes one random number, so call it once per sample, in order
+        double getNextSample(double seconds);
+
+       private:
+        const double period;
+        const double decaySeconds;
+        const double level;
+        juce::Random random;
+};
+
+// fills in one sample frame at the given time; a mono fixture only keeps left
+using FrameFunction = std::function<void(double seconds, double& left, double& right)>;
+
+// called for every frame in order, so the function may keep state such as an oscillator phase
+juce::AudioBuffer<float> synthesise(int numChannels, double seconds, double sampleRate, const FrameFunction& frame);
+
+// a DecodedTrack that is already complete, as if the cache had finished decoding it
+std::shared_ptr<const DecodedTrack> makeDecodedTrack(const juce::String& key, juce::AudioBuffer<float> samples,
+                                                     double sampleRate);
+
+// false if the command line does not have the flag; otherwise argument is the token after it, empty when
+// there is none or it is the next flag
+bool findFlag(const juce::String& commandLine, const juce::String& flag, juce::String& argument);
+
+// as above, with the argument read as a number, and defaultValue when it is missing or not positive
+bool findFlag(const juce::String& commandLine, const juce::String& flag, double defaultValue, double& value);
+}        // namespace TestSupport
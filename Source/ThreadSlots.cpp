@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    ThreadSlots.cpp
+    Created: 20/10/2026 03:26:18
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "ThreadSlots.h"
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#include "RealtimeSafety.h"
+
+namespace {
+enum SlotState { unused = 0, taken, givenBack };
+
+struct Slot {
+        std::atomic<int> state;
+        std::atomic<juce::uint32> givenBackAt;
+        // a seqlock around the name: odd while it is being written, and bumped for every new owner
+        std::atomic<juce::uint32> owner;
+        char threadName[48];
+};
+
+// static storage, zero-initialised
+Slot slots[ThreadSlots::maxSlots];
+std::atomic<int> numUsedSlots{0};
+std::atomic<int> threadsWithoutSlot{0};
+
+// constant-initialised, so reading them never allocates
+thread_local int threadSlot = -1;
+thread_local bool hasExited = false;
+
+// gives the slot back when its thread exits
+struct SlotHolder {
+        int slot = -1;
+        bool isWithoutSlot = false;
+
+        ~SlotHolder() {
+                // anything the thread records while its other thread_locals are torn down is dropped
+                hasExited = true;
+                threadSlot = -1;
+
+                if (slot >= 0) {
+                        slots[slot].givenBackAt.store(juce::Time::getMillisecondCounter(), std::memory_order_relaxed);
+                        slots[slot].state.store(givenBack, std::memory_order_release);
+                }
+                if (isWithoutSlot) {
+                        threadsWithoutSlot.fetch_sub(1, std::memory_order_relaxed);
+                }
+        }
+};
+
+// its destructor is registered on the thread's first use, see takeSlot()
+thread_local SlotHolder slotHolder;
+
+// the name is copied into the slot; String copies share their text, so this does not allocate either
+void nameSlot(Slot& slot, int index) noexcept {
+        slot.owner.fetch_add(1, std::memory_order_acq_rel);
+        auto* messageManager = juce::MessageManager::getInstanceWithoutCreating();
+
+        if (messageManager != nullptr && messageManager->isThisTheMessageThread()) {
+                std::snprintf(slot.threadName, sizeof(slot.threadName), "Message thread");
+        } else if (auto* thread = juce::Thread::getCurrentThread()) {
+                thread->getThreadName().copyToUTF8(slot.threadName, sizeof(slot.threadName));
+        } else {
+                std::snprintf(slot.threadName, sizeof(slot.threadName), "Thread %d", index);
+        }
+        slot.owner.fetch_add(1, std::memory_order_release);
+}
+
+bool tryTake(Slot& slot, juce::uint32 now) noexcept {
+        int state = slot.state.load(std::memory_order_acquire);
+        if (state == taken ||
+            (state == givenBack &&
+             now - slot.givenBackAt.load(std::memory_order_relaxed) < (juce::uint32) ThreadSlots::reuseDelayMs)) {
+                return false;
+        }
+        return slot.state.compare_exchange_strong(state, taken, std::memory_order_acq_rel);
+}
+
+int takeSlot() noexcept {
+        // the first touch of slotHolder registers its destructor with the C++ runtime, which allocates once per
+        // thread; on the audio thread that is its first marker or message, and the checking build lets it through
+        const RealtimeSafety::ScopedExemption exemption;
+        SlotHolder& holder = slotHolder;
+        const juce::uint32 now = juce::Time::getMillisecondCounter();
+
+        for (int index = 0; index < ThreadSlots::maxSlots; ++index) {
+                if (!tryTake(slots[index], now)) {
+                        continue;
+                }
+
+                nameSlot(slots[index], index);
+
+                int used = numUsedSlots.load(std::memory_order_relaxed);
+                while (used <= index && !numUsedSlots.compare_exchange_weak(used, index + 1)) {
+                }
+
+                if (holder.isWithoutSlot) {
+                        holder.isWithoutSlot = false;
+                        threadsWithoutSlot.fetch_sub(1, std::memory_order_relaxed);
+                }
+                holder.slot = index;
+                threadSlot = index;
+                return index;
+        }
+
+        if (!holder.isWithoutSlot) {
+                holder.isWithoutSlot = true;
+                threadsWithoutSlot.fetch_add(1, std::memory_order_relaxed);
+        }
+        return -1;
+}
+}        // namespace
+
+//==============================================================================
+int ThreadSlots::getSlot() noexcept {
+        if (threadSlot >= 0 || hasExited) {
+                return threadSlot;
+        }
+        return takeSlot();
+}
+
+juce::uint32 ThreadSlots::getOwner(int slot) noexcept { return slots[slot].owner.load(std::memory_order_acquire); }
+
+int ThreadSlots::getNumUsedSlots() noexcept { return numUsedSlots.load(std::memory_order_acquire); }
+
+bool ThreadSlots::getThreadName(int slot, char* destination, size_t destinationSize) noexcept {
+        if (!juce::isPositiveAndBelow(slot, maxSlots) || destinationSize == 0) {
+                return false;
+        }
+
+        const juce::uint32 before = slots[slot].owner.load(std::memory_order_acquire);
+        if (before == 0 || (before & 1) != 0) {
+                return false;
+        }
+
+        std::strncpy(destination, slots[slot].threadName, destinationSize - 1);
+        destination[destinationSize - 1] = 0;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return slots[slot].owner.load(std::memory_order_relaxed) == before;
+}
+
+int ThreadSlots::getThreadsWithoutSlot() noexcept { return threadsWithoutSlot.load(std::memory_order_relaxed); }
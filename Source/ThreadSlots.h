@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    ThreadSlots.h
+    Created: 20/10/2026 03:26:18
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+ * Per-thread slots for the tracer and the log.
+ *
+ * Each thread that calls getSlot() takes one of a fixed number of indices on
+ * its first call, without a lock, and names it after itself. Tracer and Log
+ * keep a statically allocated buffer per index, so a thread finds its own
+ * buffer from the index alone.
+ *
+ * A thread gives its slot back when it exits. Recordings, buffer size tuning
+ * and device restarts each start new threads, so slots held for good would
+ * soon run out and leave the audio callback untraced. A slot given back is
+ * handed out again only after reuseDelayMs, by which time the log sink has
+ * written out whatever the old thread left queued in it.
+ *
+ * A thread that finds every slot taken gets -1 and tries again on its next
+ * call; getThreadsWithoutSlot() counts such threads so the tracer and the log
+ * can report what they missed.
+ */
+namespace ThreadSlots {
+constexpr int maxSlots = 32;
+constexpr int reuseDelayMs = 1000;
+
+// the calling thread's slot, or -1 if every slot is taken
+int getSlot() noexcept;
+
+// changes each time the slot is handed to another thread, so a buffer can tell its new owner from the old one
+juce::uint32 getOwner(int slot) noexcept;
+
+// one past the highest slot handed out so far, the bound for loops over them
+int getNumUsedSlots() noexcept;
+
+// copies the name of the slot's thread, false if the slot has not been named yet or is being renamed
+bool getThreadName(int slot, char* destination, size_t destinationSize) noexcept;
+
+// live threads that asked for a slot and found none free
+int getThreadsWithoutSlot() noexcept;
+}        // namespace ThreadSlots
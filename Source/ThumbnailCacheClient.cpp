@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    ThumbnailCacheClient.cpp
+    Created: 20/10/2026 02:14:36
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "ThumbnailCacheClient.h"
+
+#include <JuceHeader.h>
+
+//==============================================================================
+ThumbnailCacheClient::ThumbnailCacheClient(int maxNumThumbsToStore)
+    : juce::AudioThumbnailCache(maxNumThumbsToStore), maxThumbs(juce::jmax(1, maxNumThumbsToStore)) {}
+
+MemoryGovernor::Category ThumbnailCacheClient::getMemoryCategory() const {
+        return MemoryGovernor::Category::thumbnails;
+}
+
+size_t ThumbnailCacheClient::getMemoryInUse() const {
+        const juce::ScopedLock sl(sizeLock);
+        return bytesInUse;
+}
+
+size_t ThumbnailCacheClient::releaseMemory(size_t, MemoryGovernor::Priority) {
+        // it cannot drop single thumbnails by age, and a cleared cache only costs a rebuild
+        clear();
+
+        const juce::ScopedLock sl(sizeLock);
+        const size_t freed = bytesInUse;
+        stored.clear();
+        bytesInUse = 0;
+        return freed;
+}
+
+void ThumbnailCacheClient::saveNewlyFinishedThumbnail(const juce::AudioThumbnailBase& thumbnail,
+                                                      juce::int64 hashCode) {
+        // the same serialisation storeThumb() has just done, for this one thumbnail only
+        juce::MemoryOutputStream stream;
+        thumbnail.saveTo(stream);
+
+        const juce::ScopedLock sl(sizeLock);
+        // a thumbnail stored again replaces its earlier size
+        Stored& entry = stored[hashCode];
+        bytesInUse -= entry.bytes;
+        entry = {stream.getDataSize(), ++storeCounter};
+        bytesInUse += entry.bytes;
+
+        if ((int) stored.size() <= maxThumbs) {
+                return;
+        }
+
+        // the cache replaced its least recently used thumbnail; the least recently stored is close enough
+        auto oldest = stored.begin();
+        for (auto it = stored.begin(); it != stored.end(); ++it) {
+                if (it->second.order < oldest->second.order) {
+                        oldest = it;
+                }
+        }
+        bytesInUse -= oldest->second.bytes;
+        stored.erase(oldest);
+}
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    ThumbnailCacheClient.h
+    Created: 20/10/2026 02:14:36
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <map>
+
+#include "MemoryGovernor.h"
+
+//==============================================================================
+/*
+ * A juce::AudioThumbnailCache under the MemoryGovernor. The cache only holds
+ * copies of thumbnails that were already built, for when a track is loaded
+ * again, so all of it is evictable.
+ *
+ * JUCE does not report the cache's size, so it is kept as a running estimate:
+ * each thumbnail is measured once, when it is stored, and the oldest is
+ * assumed gone once more are stored than the cache keeps. The governor asks
+ * for the size every second, which must not cost a pass over the whole cache.
+ */
+class ThumbnailCacheClient : public juce::AudioThumbnailCache, public MemoryGovernor::Client {
+       public:
+        explicit ThumbnailCacheClient(int maxNumThumbsToStore);
+
+        MemoryGovernor::Category getMemoryCategory() const override;
+        size_t getMemoryInUse() const override;
+        size_t releaseMemory(size_t bytesToFree, MemoryGovernor::Priority maxPriority) override;
+
+       protected:
+        // called by storeThumb() for every finished thumbnail
+        void saveNewlyFinishedThumbnail(const juce::AudioThumbnailBase& thumbnail, juce::int64 hashCode) override;
+
+       private:
+        struct Stored {
+                size_t bytes = 0;
+                juce::uint64 order = 0;
+        };
+
+        const int maxThumbs;
+
+        juce::CriticalSection sizeLock;
+        std::map<juce::int64, Stored> stored;
+        juce::uint64 storeCounter = 0;
+        size_t bytesInUse = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ThumbnailCacheClient)
+};
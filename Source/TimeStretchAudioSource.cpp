@@ -0,0 +1,268 @@
+/*
+  ==============================================================================
+
+    TimeStretchAudioSource.cpp
+    Created: 19/10/2026 16:31:07
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "TimeStretchAudioSource.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+//==============================================================================
+TimeStretchAudioSource::TimeStretchAudioSource(juce::AudioSource* _input, int _numChannels)
+    : input(_input), numChannels(juce::jmax(1, _numChannels)) {
+        jassert(input != nullptr);
+}
+
+TimeStretchAudioSource::~TimeStretchAudioSource() {}
+
+void TimeStretchAudioSource::setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled); }
+
+bool TimeStretchAudioSource::isEnabled() const { return enabled.load(); }
+
+void TimeStretchAudioSource::setTempo(double newTempo) { tempo.store(juce::jlimit(0.1, maxTempo, newTempo)); }
+
+void TimeStretchAudioSource::setQuality(Quality newQuality) { quality.store((int) newQuality); }
+
+TimeStretchAudioSource::Quality TimeStretchAudioSource::getQuality() const { return (Quality) quality.load(); }
+
+float TimeStretchAudioSource::getCpuLoad() const { return cpuLoad.load(); }
+
+juce::String TimeStretchAudioSource::getQualityName(Quality quality) {
+        switch (quality) {
+                case Quality::draft:
+                        return "Draft";
+                case Quality::high:
+                        return "High";
+                case Quality::normal:
+                default:
+                        return "Normal";
+        }
+}
+
+TimeStretchAudioSource::Settings TimeStretchAudioSource::getSettings(Quality quality, double sampleRate) {
+        // frame and search range in milliseconds; a coarser search step is the main saving of the cheaper tiers
+        double frameMs = 40.0, searchMs = 10.0;
+        int step = 2;
+
+        if (quality == Quality::draft) {
+                frameMs = 30.0;
+                searchMs = 5.0;
+                step = 4;
+        } else if (quality == Quality::high) {
+                frameMs = 50.0;
+                searchMs = 15.0;
+                step = 1;
+        }
+
+        Settings settings;
+        settings.frameSize = 2 * juce::jmax(16, juce::roundToInt(sampleRate * frameMs / 2000.0));
+        settings.searchRadius = juce::jmax(1, juce::roundToInt(sampleRate * searchMs / 1000.0));
+        settings.searchStep = step;
+        return settings;
+}
+
+//==============================================================================
+void TimeStretchAudioSource::prepareToPlay(int samplesPerBlockExpected, double _sampleRate) {
+        input->prepareToPlay(samplesPerBlockExpected, _sampleRate);
+
+        sampleRate = _sampleRate;
+        blockSize = juce::jmax(1, samplesPerBlockExpected);
+
+        // sized for the most expensive tier at the fastest tempo, so changing either never allocates
+        const Settings largest = getSettings(Quality::high, sampleRate);
+        const int largestHop = largest.frameSize / 2;
+        const int inputCapacity = largest.frameSize + 2 * largest.searchRadius +
+                                  (int) std::ceil(maxTempo * largestHop) + 2 * blockSize;
+
+        inputBuffer.setSize(numChannels, inputCapacity);
+        monoInput.allocate((size_t) inputCapacity, true);
+        window.allocate((size_t) largest.frameSize, true);
+        accumulator.setSize(numChannels, largest.frameSize);
+        outputBuffer.setSize(numChannels, blockSize + largestHop);
+
+        reset();
+        active = false;
+}
+
+void TimeStretchAudioSource::releaseResources() {
+        input->releaseResources();
+
+        inputBuffer.setSize(0, 0);
+        monoInput.free();
+        window.free();
+        accumulator.setSize(0, 0);
+        outputBuffer.setSize(0, 0);
+}
+
+void TimeStretchAudioSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) {
+        if (!enabled.load() || inputBuffer.getNumSamples() == 0) {
+                active = false;
+                input->getNextAudioBlock(bufferToFill);
+                return;
+        }
+
+        const juce::int64 startTicks = juce::Time::getHighResolutionTicks();
+
+        if (!active || activeQuality != getQuality()) {
+                reset();
+                active = true;
+        }
+
+        for (int done = 0; done < bufferToFill.numSamples;) {
+                const int numSamples = juce::jmin(blockSize, bufferToFill.numSamples - done);
+                render(numSamples);
+
+                for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel) {
+                        bufferToFill.buffer->copyFrom(channel, bufferToFill.startSample + done, outputBuffer,
+                                                      juce::jmin(channel, numChannels - 1), 0, numSamples);
+                }
+
+                outputReady -= numSamples;
+                for (int channel = 0; channel < numChannels; ++channel) {
+                        float* data = outputBuffer.getWritePointer(channel);
+                        std::memmove(data, data + numSamples, (size_t) outputReady * sizeof(float));
+                }
+                done += numSamples;
+        }
+
+        const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        const double blockDuration = bufferToFill.numSamples / sampleRate;
+
+        if (blockDuration > 0) {
+                cpuLoad.store(0.9f * cpuLoad.load() + 0.1f * (float) (elapsed / blockDuration));
+        }
+}
+
+//==============================================================================
+void TimeStretchAudioSource::reset() {
+        activeQuality = getQuality();
+        settings = getSettings(activeQuality, sampleRate);
+        hop = settings.frameSize / 2;
+
+        // periodic Hann, consecutive frames at half a frame apart sum to exactly one
+        for (int i = 0; i < settings.frameSize; ++i) {
+                window[i] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float) i / (float) settings.frameSize);
+        }
+
+        inputBuffer.clear();
+        juce::FloatVectorOperations::clear(monoInput.get(), inputBuffer.getNumSamples());
+        accumulator.clear();
+        outputBuffer.clear();
+        outputReady = 0;
+
+        // start with silence before the input so the first search has room to look back
+        inputEnd = settings.searchRadius;
+        analysisPosition = settings.searchRadius;
+        previousStart = -1;
+}
+
+void TimeStretchAudioSource::render(int numSamples) {
+        while (outputReady < numSamples) {
+                renderFrame();
+        }
+}
+
+void TimeStretchAudioSource::renderFrame() {
+        const int frameSize = settings.frameSize;
+        const int searchRadius = settings.searchRadius;
+
+        // drop input that no later frame or search can reach before pulling more
+        if ((int) analysisPosition + searchRadius + frameSize + blockSize > inputBuffer.getNumSamples()) {
+                const int oldestNeeded = (int) analysisPosition - searchRadius;
+                compactInput(previousStart >= 0 ? juce::jmin(previousStart + hop, oldestNeeded) : oldestNeeded);
+        }
+
+        const int nominalStart = (int) analysisPosition;
+        pullInput(nominalStart + searchRadius + frameSize);
+
+        const int start = previousStart >= 0 ? nominalStart + findBestOffset(nominalStart) : nominalStart;
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+                float* acc = accumulator.getWritePointer(channel);
+                const float* in = inputBuffer.getReadPointer(channel, start);
+
+                for (int i = 0; i < frameSize; ++i) {
+                        acc[i] += window[i] * in[i];
+                }
+
+                // the first hop samples have had both of their frames added and are finished
+                outputBuffer.copyFrom(channel, outputReady, acc, hop);
+                std::memmove(acc, acc + hop, (size_t) (frameSize - hop) * sizeof(float));
+                juce::FloatVectorOperations::clear(acc + frameSize - hop, hop);
+        }
+
+        outputReady += hop;
+        previousStart = start;
+        analysisPosition += hop * tempo.load();
+}
+
+void TimeStretchAudioSource::pullInput(int endSample) {
+        jassert(endSample + blockSize <= inputBuffer.getNumSamples());
+
+        while (inputEnd < endSample) {
+                input->getNextAudioBlock(juce::AudioSourceChannelInfo(&inputBuffer, inputEnd, blockSize));
+
+                float* mono = monoInput.get() + inputEnd;
+                juce::FloatVectorOperations::copy(mono, inputBuffer.getReadPointer(0, inputEnd), blockSize);
+                for (int channel = 1; channel < numChannels; ++channel) {
+                        juce::FloatVectorOperations::add(mono, inputBuffer.getReadPointer(channel, inputEnd), blockSize);
+                }
+
+                inputEnd += blockSize;
+        }
+}
+
+void TimeStretchAudioSource::compactInput(int discardBefore) {
+        if (discardBefore <= 0) {
+                return;
+        }
+
+        const int remaining = inputEnd - discardBefore;
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+                float* data = inputBuffer.getWritePointer(channel);
+                std::memmove(data, data + discardBefore, (size_t) remaining * sizeof(float));
+        }
+        std::memmove(monoInput.get(), monoInput.get() + discardBefore, (size_t) remaining * sizeof(float));
+
+        inputEnd -= discardBefore;
+        analysisPosition -= discardBefore;
+        if (previousStart >= 0) {
+                previousStart -= discardBefore;
+        }
+}
+
+int TimeStretchAudioSource::findBestOffset(int nominalStart) const {
+        // the input that naturally followed the previous frame is what the next frame should resemble
+        const float* target = monoInput.get() + previousStart + hop;
+        const int step = settings.searchStep;
+
+        int bestOffset = 0;
+        float bestScore = -std::numeric_limits<float>::max();
+
+        for (int offset = -settings.searchRadius; offset <= settings.searchRadius; offset += step) {
+                const float* candidate = monoInput.get() + nominalStart + offset;
+                float correlation = 0.0f, energy = 0.0f;
+
+                for (int i = 0; i < hop; i += step) {
+                        correlation += target[i] * candidate[i];
+                        energy += candidate[i] * candidate[i];
+                }
+
+                const float score = correlation / std::sqrt(energy + 1.0e-9f);
+                if (score > bestScore) {
+                        bestScore = score;
+                        bestOffset = offset;
+                }
+        }
+        return bestOffset;
+}
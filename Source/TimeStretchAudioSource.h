@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    TimeStretchAudioSource.h
+    Created: 19/10/2026 16:31:07
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+
+//==============================================================================
+/*
+ * TimeStretchAudioSource changes the tempo of its input without changing the
+ * pitch (key lock), using WSOLA: frames are read from the input every
+ * hop * tempo samples and overlap-added every hop samples, each one shifted
+ * within a small search range to the position that lines up best with the
+ * previous frame.
+ *
+ * The cost per output sample is fixed by the quality tier (frame length,
+ * search range and search step) and does not depend on the tempo. All
+ * buffers are allocated in prepareToPlay. When disabled it passes its input
+ * straight through.
+ */
+class TimeStretchAudioSource : public juce::AudioSource {
+       public:
+        enum class Quality { draft, normal, high };
+
+        explicit TimeStretchAudioSource(juce::AudioSource* input, int numChannels = 2);
+        ~TimeStretchAudioSource() override;
+
+        void setEnabled(bool shouldBeEnabled);
+        bool isEnabled() const;
+        // 1 is the original tempo, limited to 0.1..4
+        void setTempo(double tempo);
+        void setQuality(Quality quality);
+        Quality getQuality() const;
+
+        // smoothed fraction of real time spent stretching, 0.05 means 5% of one core
+        float getCpuLoad() const;
+
+        void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+        void releaseResources() override;
+        void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+        static juce::String getQualityName(Quality quality);
+
+       private:
+        struct Settings {
+                int frameSize = 0;
+                int searchRadius = 0;
+                int searchStep = 1;
+        };
+
+        static Settings getSettings(Quality quality, double sampleRate);
+
+        // back to an empty state with the current quality, audio thread
+        void reset();
+        void render(int numSamples);
+        void renderFrame();
+        void pullInput(int endSample);
+        void compactInput(int discardBefore);
+        int findBestOffset(int nominalStart) const;
+
+        static constexpr double maxTempo = 4.0;
+
+        juce::AudioSource* input;
+        const int numChannels;
+
+        std::atomic<bool> enabled{false};
+        std::atomic<double> tempo{1.0};
+        std::atomic<int> quality{(int) Quality::normal};
+        std::atomic<float> cpuLoad{0.0f};
+
+        double sampleRate = 44100.0;
+        int blockSize = 512;
+
+        // audio thread state
+        bool active = false;
+        Quality activeQuality = Quality::normal;
+        Settings settings;
+        int hop = 0;
+
+        // input history with a mono mix for the similarity search, compacted as it is consumed
+        juce::AudioBuffer<float> inputBuffer;
+        juce::HeapBlock<float> monoInput;
+        int inputEnd = 0;
+        double analysisPosition = 0.0;
+        int previousStart = -1;
+
+        juce::HeapBlock<float> window;
+        juce::AudioBuffer<float> accumulator;
+        juce::AudioBuffer<float> outputBuffer;
+        int outputReady = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimeStretchAudioSource)
+};
@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    Tracer.cpp
+    Created: 19/10/2026 23:38:04
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "Tracer.h"
+
+#if OTODECK_TRACING
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "ThreadSlots.h"
+
+namespace {
+// a few seconds of audio callbacks with every deck stage marked
+constexpr int eventsPerThread = 16384;
+
+// each event is a small seqlock, so an export never reads one half written
+struct Event {
+        std::atomic<juce::uint64> sequence;
+        std::atomic<const char*> name;
+        std::atomic<juce::int64> start;
+        std::atomic<juce::int64> end;
+};
+
+struct ThreadBuffer {
+        std::atomic<juce::uint64> written;
+        // the first event of the slot's current thread, the ones before it belong to a thread that has exited
+        std::atomic<juce::uint64> first;
+        juce::uint32 owner;
+        Event events[eventsPerThread];
+};
+
+// one per thread slot, static and zero-initialised, so no thread ever allocates to record and untouched pages cost nothing
+ThreadBuffer buffers[ThreadSlots::maxSlots];
+
+// markers from threads that found every slot taken
+std::atomic<juce::uint64> untracedEvents{0};
+
+struct ExportedEvent {
+        int thread;
+        const char* name;
+        juce::int64 start;
+        juce::int64 end;
+};
+}        // namespace
+
+//==============================================================================
+void Tracer::record(const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept {
+        const int slot = ThreadSlots::getSlot();
+        if (slot < 0) {
+                untracedEvents.fetch_add(1, std::memory_order_relaxed);
+                return;
+        }
+        ThreadBuffer* buffer = &buffers[slot];
+
+        const juce::uint32 owner = ThreadSlots::getOwner(slot);
+        if (buffer->owner != owner) {
+                buffer->owner = owner;
+                buffer->first.store(buffer->written.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+
+        const juce::uint64 index = buffer->written.load(std::memory_order_relaxed);
+        Event& event = buffer->events[index % eventsPerThread];
+
+        event.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        event.name.store(name, std::memory_order_relaxed);
+        event.start.store(startTicks, std::memory_order_relaxed);
+        event.end.store(endTicks, std::memory_order_relaxed);
+        event.sequence.store(2 * index + 2, std::memory_order_release);
+
+        buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::mark(const char* name) noexcept {
+        const juce::int64 now = juce::Time::getHighResolutionTicks();
+        record(name, now, now);
+}
+
+bool Tracer::exportJson(const juce::File& file) {
+        std::vector<ExportedEvent> events;
+        const int numThreads = ThreadSlots::getNumUsedSlots();
+
+        for (int thread = 0; thread < numThreads; ++thread) {
+                ThreadBuffer& buffer = buffers[thread];
+
+                const juce::uint64 written = buffer.written.load(std::memory_order_acquire);
+                const juce::uint64 first =
+                    juce::jmax(buffer.first.load(std::memory_order_acquire),
+                               written > (juce::uint64) eventsPerThread ? written - eventsPerThread : 0);
+
+                for (juce::uint64 index = first; index < written; ++index) {
+                        const Event& event = buffer.events[index % eventsPerThread];
+
+                        // skipped if the thread has lapped the export and is rewriting this slot
+                        const juce::uint64 before = event.sequence.load(std::memory_order_acquire);
+                        ExportedEvent exported{thread, event.name.load(std::memory_order_relaxed),
+                                               event.start.load(std::memory_order_relaxed),
+                                               event.end.load(std::memory_order_relaxed)};
+                        std::atomic_thread_fence(std::memory_order_acquire);
+
+                        if (before == 2 * index + 2 && event.sequence.load(std::memory_order_relaxed) == before &&
+                            exported.name != nullptr) {
+                                events.push_back(exported);
+                        }
+                }
+        }
+
+        if (events.empty()) {
+                return false;
+        }
+
+        std::sort(events.begin(), events.end(),
+                  [](const ExportedEvent& a, const ExportedEvent& b) { return a.start < b.start; });
+
+        const juce::int64 origin = events.front().start;
+        const double ticksPerMicrosecond = juce::Time::getHighResolutionTicksPerSecond() / 1.0e6;
+        auto toMicroseconds = [&](juce::int64 ticks) { return juce::String((ticks - origin) / ticksPerMicrosecond, 1); };
+
+        file.getParentDirectory().createDirectory();
+        juce::FileOutputStream stream(file);
+        if (!stream.openedOk()) {
+                return false;
+        }
+        stream.setPosition(0);
+        stream.truncate();
+
+        // one complete ("X") or instant ("i") event per marker, and a name for each thread's row
+        stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+        // a global marker at the start, so a trace with gaps says so
+        if (const juce::uint64 untraced = untracedEvents.load(std::memory_order_relaxed)) {
+                stream << "{\"name\":\"Out of trace slots: " << (juce::int64) untraced
+                       << " markers not recorded\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":0},\n";
+        }
+
+        for (int thread = 0; thread < numThreads; ++thread) {
+                char threadName[48];
+                if (!ThreadSlots::getThreadName(thread, threadName, sizeof(threadName))) {
+                        continue;
+                }
+                stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+                       << ",\"args\":{\"name\":" << juce::JSON::toString(juce::String(threadName)) << "}},\n";
+        }
+
+        for (size_t i = 0; i < events.size(); ++i) {
+                const ExportedEvent& event = events[i];
+                stream << "{\"name\":" << juce::JSON::toString(juce::String(event.name)) << ",\"pid\":1,\"tid\":"
+                       << event.thread << ",\"ts\":" << toMicroseconds(event.start);
+
+                if (event.end > event.start) {
+                        stream << ",\"ph\":\"X\",\"dur\":"
+                               << juce::String((event.end - event.start) / ticksPerMicrosecond, 1);
+                } else {
+                        stream << ",\"ph\":\"i\",\"s\":\"t\"";
+                }
+                stream << (i + 1 < events.size() ? "},\n" : "}\n");
+        }
+
+        stream << "]}\n";
+        return true;
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    Tracer.h
+    Created: 19/10/2026 23:38:04
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Set to 0 in the exporter's preprocessor definitions to compile every marker away.
+#ifndef OTODECK_TRACING
+#define OTODECK_TRACING 1
+#endif
+
+//==============================================================================
+/*
+ * Trace markers for the audio, message, disk and analysis threads.
+ *
+ * Each thread that records a marker takes one of a fixed set of ring buffers,
+ * statically allocated, on its first marker, and gives it back when it exits
+ * (see ThreadSlots). Markers from a thread that found none free are counted,
+ * and the export says how many were missed. Recording is two clock reads and
+ * a few relaxed stores into the calling thread's own buffer: no allocation, no
+ * lock, so markers are safe on the audio thread. The buffers always hold the
+ * most recent events, like a flight recorder.
+ *
+ * exportJson() writes whatever the buffers hold as a Chrome trace, which
+ * chrome://tracing and ui.perfetto.dev both open, with one row per thread.
+ */
+namespace Tracer {
+#if OTODECK_TRACING
+// name must outlive the trace, in practice a string literal
+void record(const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+
+// records the time from construction to destruction as one event
+class Scope {
+       public:
+        explicit Scope(const char* _name) noexcept : name(_name), start(juce::Time::getHighResolutionTicks()) {}
+        ~Scope() noexcept { record(name, start, juce::Time::getHighResolutionTicks()); }
+
+       private:
+        const char* name;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+};
+
+// a point in time rather than a span
+void mark(const char* name) noexcept;
+
+// message thread, other threads keep recording while it runs
+bool exportJson(const juce::File& file);
+#else
+class Scope {
+       public:
+        explicit Scope(const char*) noexcept {}
+};
+
+inline void mark(const char*) noexcept {}
+inline bool exportJson(const juce::File&) { return false; }
+#endif
+}        // namespace Tracer
+
+#define OTODECK_TRACE_SCOPE(name) const Tracer::Scope JUCE_JOIN_MACRO(traceScope, __LINE__)(name)
@@ -0,0 +1,349 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.cpp
+    Created: 19/10/2026 12:20:45
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#include "TrackAnalyser.h"
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <vector>
+
+#include "Log.h"
+#include "Tracer.h"
+
+//==============================================================================
+/*
+ * Waits for the track to finish decoding, then analyses it or builds its
+ * waveform. Only a weak reference is kept while waiting, so a pending job does
+ * not stop the cache from cancelling a decode nobody wants any more.
+ */
+class TrackAnalyser::AnalysisJob : public juce::ThreadPoolJob {
+       public:
+        enum class Kind { analysis, waveform };
+
+        AnalysisJob(TrackAnalyser& _owner, const std::shared_ptr<const DecodedTrack>& _track, Kind _kind)
+            : juce::ThreadPoolJob("Analyse " + _track->key), owner(_owner), track(_track), key(_track->key), kind(_kind) {}
+
+        JobStatus runJob() override {
+                OTODECK_TRACE_SCOPE(kind == Kind::analysis ? "Analyse track" : "Track waveform");
+                const juce::File cacheFile = owner.getWaveformCacheFile(key);
+
+                if (kind == Kind::waveform) {
+                        if (std::shared_ptr<const ColouredWaveform> cached = ColouredWaveform::load(cacheFile)) {
+                                owner.storeWaveform(key, cached);
+                                return jobHasFinished;
+                        }
+                }
+
+                while (!shouldExit()) {
+                        std::shared_ptr<const DecodedTrack> decoded = track.lock();
+
+                        if (decoded == nullptr || decoded->hasFailed()) {
+                                finish(nullptr, nullptr);
+                                return jobHasFinished;
+                        }
+
+                        if (decoded->isComplete()) {
+                                if (kind == Kind::analysis) {
+                                        std::shared_ptr<const TrackAnalysis> analysis = analyse(*decoded);
+                                        OTODECK_LOG(debug, "TrackAnalyser", key << " at " << analysis->beatGrid.bpm << " BPM");
+                                        finish(analysis, nullptr);
+                                } else {
+                                        std::shared_ptr<const ColouredWaveform> waveform = ColouredWaveform::compute(*decoded);
+                                        if (waveform != nullptr && !waveform->save(cacheFile)) {
+                                                OTODECK_LOG(warning, "TrackAnalyser", "Could not cache waveform for " << key);
+                                        }
+                                        finish(nullptr, waveform);
+                                }
+                                return jobHasFinished;
+                        }
+
+                        decoded.reset();
+                        juce::Thread::sleep(50);
+                }
+                return jobHasFinished;
+        }
+
+       private:
+        void finish(std::shared_ptr<const TrackAnalysis> analysis, std::shared_ptr<const ColouredWaveform> waveform) {
+                if (kind == Kind::analysis) {
+                        owner.storeResult(key, std::move(analysis));
+                } else {
+                        owner.storeWaveform(key, std::move(waveform));
+                }
+        }
+
+        TrackAnalyser& owner;
+        std::weak_ptr<const DecodedTrack> track;
+        juce::String key;
+        Kind kind;
+};
+
+//==============================================================================
+size_t TrackAnalyser::Entry::getSizeInBytes() const {
+        return sizeof(Entry) + (analysis != nullptr ? analysis->getSizeInBytes() : 0) +
+               (waveform != nullptr ? waveform->getSizeInBytes() : 0);
+}
+
+TrackAnalyser::TrackAnalyser()
+    : waveformCacheDirectory(juce::File::getCurrentWorkingDirectory().getChildFile("waveformCache")) {}
+
+TrackAnalyser::~TrackAnalyser() { analysisPool.removeAllJobs(true, 5000); }
+
+TrackAnalyser::Entry& TrackAnalyser::touchEntry(const juce::String& key) {
+        Entry& entry = entries[key];
+        entry.lastUsed = ++useCounter;
+        return entry;
+}
+
+std::shared_ptr<const TrackAnalysis> TrackAnalyser::requestAnalysis(const std::shared_ptr<const DecodedTrack>& track) {
+        if (track == nullptr) {
+                return nullptr;
+        }
+
+        const juce::ScopedLock sl(lock);
+        Entry& entry = touchEntry(track->key);
+
+        if (!entry.analysisQueued) {
+                entry.analysisQueued = true;
+                analysisPool.addJob(new AnalysisJob(*this, track, AnalysisJob::Kind::analysis), true);
+        }
+        return entry.analysis;
+}
+
+std::shared_ptr<const ColouredWaveform> TrackAnalyser::requestWaveform(const std::shared_ptr<const DecodedTrack>& track) {
+        if (track == nullptr) {
+                return nullptr;
+        }
+
+        const juce::ScopedLock sl(lock);
+        Entry& entry = touchEntry(track->key);
+
+        if (!entry.waveformQueued) {
+                entry.waveformQueued = true;
+                analysisPool.addJob(new AnalysisJob(*this, track, AnalysisJob::Kind::waveform), true);
+        }
+        return entry.waveform;
+}
+
+std::shared_ptr<const ColouredWaveform> TrackAnalyser::findCachedWaveform(const juce::File& file) {
+        const juce::String key = DecodedAudioCache::makeKey(file);
+        {
+                const juce::ScopedLock sl(lock);
+                auto it = entries.find(key);
+                if (it != entries.end() && it->second.waveform != nullptr) {
+                        return it->second.waveform;
+                }
+        }
+        return ColouredWaveform::load(getWaveformCacheFile(key));
+}
+
+void TrackAnalyser::storeResult(const juce::String& key, std::shared_ptr<const TrackAnalysis> analysis) {
+        const juce::ScopedLock sl(lock);
+
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+                // a null result allows a later request to try again
+                it->second.analysisQueued = analysis != nullptr;
+                it->second.analysis = std::move(analysis);
+        }
+}
+
+void TrackAnalyser::storeWaveform(const juce::String& key, std::shared_ptr<const ColouredWaveform> waveform) {
+        const juce::ScopedLock sl(lock);
+
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+                it->second.waveformQueued = waveform != nullptr;
+                it->second.waveform = std::move(waveform);
+        }
+}
+
+juce::File TrackAnalyser::getWaveformCacheFile(const juce::String& key) const {
+        // the key holds path, size and modification time, so an edited file gets a new cache entry
+        return waveformCacheDirectory.getChildFile(juce::String::toHexString(key.hashCode64()) + ".wave");
+}
+
+std::shared_ptr<const TrackAnalysis> TrackAnalyser::analyse(const DecodedTrack& track) {
+        auto analysis = std::make_shared<TrackAnalysis>();
+        analysis->beatGrid = detectBeatGrid(track);
+        analysis->loudnessLufs = measureLoudnessLufs(track);
+        return analysis;
+}
+
+std::shared_ptr<const TrackAnalysis> TrackAnalyser::analyseFile(const juce::File& file,
+                                                                juce::AudioFormatManager& formatManager,
+                                                                double maxSeconds) {
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+        if (reader == nullptr || reader->sampleRate <= 0 || reader->lengthInSamples <= 0) {
+                return nullptr;
+        }
+
+        const int length = (int) juce::jmin<juce::int64>(reader->lengthInSamples, (juce::int64) (reader->sampleRate * maxSeconds));
+
+        DecodedTrack track;
+        track.key = file.getFullPathName();
+        track.sampleRate = reader->sampleRate;
+        track.samples.setSize((int) reader->numChannels, length);
+        reader->read(&track.samples, 0, length, 0, true, true);
+        track.lengthInSamples.store(length);
+        track.samplesReady.store(length);
+        track.complete.store(true);
+
+        return analyse(track);
+}
+
+float TrackAnalyser::measureLoudnessLufs(const DecodedTrack& track) {
+        const int numSamples = (int) track.getLengthInSamples();
+
+        if (numSamples <= 0 || track.sampleRate <= 0) {
+                return LevelMeter::silenceLufs;
+        }
+
+        return LevelMeter::measureIntegratedLufs(track.samples, numSamples, track.sampleRate);
+}
+
+BeatGrid TrackAnalyser::detectBeatGrid(const DecodedTrack& track) {
+        constexpr int hop = 512;
+        const double sampleRate = track.sampleRate;
+
+        // the first two minutes are plenty to lock onto a constant tempo
+        const int numSamples = (int) juce::jmin<juce::int64>(track.getLengthInSamples(), (juce::int64) (sampleRate * 120));
+        const int numFrames = numSamples / hop;
+
+        if (sampleRate <= 0 || numFrames < 256) {
+                return {};
+        }
+
+        // log energy per hop, then its positive difference as the onset envelope
+        std::vector<float> onset((size_t) numFrames, 0.0f);
+        float previousEnergy = 0.0f;
+
+        for (int frame = 0; frame < numFrames; ++frame) {
+                float energy = 0.0f;
+
+                for (int channel = 0; channel < track.samples.getNumChannels(); ++channel) {
+                        const float* data = track.samples.getReadPointer(channel, frame * hop);
+
+                        for (int i = 0; i < hop; ++i) {
+                                energy += data[i] * data[i];
+                        }
+                }
+
+                const float logEnergy = std::log(1.0e-9f + energy);
+                onset[(size_t) frame] = frame > 0 ? juce::jmax(0.0f, logEnergy - previousEnergy) : 0.0f;
+                previousEnergy = logEnergy;
+        }
+
+        float mean = 0.0f;
+        for (float value : onset) {
+                mean += value;
+        }
+        mean /= (float) numFrames;
+        for (float& value : onset) {
+                value -= mean;
+        }
+
+        // autocorrelate over lags covering 70..180 BPM
+        const double framesPerSecond = sampleRate / hop;
+        const int minLag = (int) std::floor(60.0 * framesPerSecond / 180.0);
+        const int maxLag = (int) std::ceil(60.0 * framesPerSecond / 70.0);
+        std::vector<double> correlation((size_t) maxLag + 2, 0.0);
+
+        for (int lag = minLag - 1; lag <= maxLag + 1; ++lag) {
+                double sum = 0.0;
+                for (int i = lag; i < numFrames; ++i) {
+                        sum += (double) onset[(size_t) i] * onset[(size_t) (i - lag)];
+                }
+                correlation[(size_t) lag] = sum / (numFrames - lag);
+        }
+
+        int bestLag = minLag;
+        for (int lag = minLag; lag <= maxLag; ++lag) {
+                if (correlation[(size_t) lag] > correlation[(size_t) bestLag]) {
+                        bestLag = lag;
+                }
+        }
+
+        // parabolic interpolation around the peak for a sub-frame period
+        const double left = correlation[(size_t) bestLag - 1];
+        const double centre = correlation[(size_t) bestLag];
+        const double right = correlation[(size_t) bestLag + 1];
+        const double denominator = left - 2.0 * centre + right;
+        const double offset = denominator != 0.0 ? juce::jlimit(-0.5, 0.5, 0.5 * (left - right) / denominator) : 0.0;
+
+        double bpm = 60.0 * framesPerSecond / (bestLag + offset);
+        while (bpm < 85.0) {
+                bpm *= 2.0;
+        }
+        while (bpm > 170.0) {
+                bpm /= 2.0;
+        }
+
+        // the phase with the strongest onsets on the beat positions
+        const double period = 60.0 * framesPerSecond / bpm;
+        double bestScore = -1.0e30;
+        int bestPhase = 0;
+
+        for (int phase = 0; phase < (int) period; ++phase) {
+                double score = 0.0;
+                for (double position = phase; position < numFrames; position += period) {
+                        score += onset[(size_t) position];
+                }
+
+                if (score > bestScore) {
+                        bestScore = score;
+                        bestPhase = phase;
+                }
+        }
+
+        BeatGrid grid;
+        grid.bpm = bpm;
+        grid.firstBeatSeconds = bestPhase / framesPerSecond;
+        return grid;
+}
+
+MemoryGovernor::Category TrackAnalyser::getMemoryCategory() const { return MemoryGovernor::Category::analysis; }
+
+size_t TrackAnalyser::getMemoryInUse() const {
+        const juce::ScopedLock sl(lock);
+        size_t total = 0;
+
+        for (const auto& [key, entry] : entries) {
+                total += (size_t) key.getNumBytesAsUTF8() + entry.getSizeInBytes();
+        }
+        return total;
+}
+
+size_t TrackAnalyser::releaseMemory(size_t bytesToFree, MemoryGovernor::Priority) {
+        const juce::ScopedLock sl(lock);
+        size_t freed = 0;
+
+        while (freed < bytesToFree) {
+                auto victim = entries.end();
+
+                // pending entries stay, their job still reports into them
+                for (auto it = entries.begin(); it != entries.end(); ++it) {
+                        if (!it->second.isPending() &&
+                            (victim == entries.end() || it->second.lastUsed < victim->second.lastUsed)) {
+                                victim = it;
+                        }
+                }
+
+                if (victim == entries.end()) {
+                        break;
+                }
+
+                freed += (size_t) victim->first.getNumBytesAsUTF8() + victim->second.getSizeInBytes();
+                entries.erase(victim);
+        }
+        return freed;
+}
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.h
+    Created: 19/10/2026 12:20:45
+    Author:  artzhk
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <map>
+#include <memory>
+
+#include "ColouredWaveform.h"
+#include "DecodedAudioCache.h"
+#include "LevelMeter.h"
+#include "MemoryGovernor.h"
+
+//==============================================================================
+// Constant-tempo beat grid: beats fall on firstBeatSeconds + n * 60 / bpm
+struct BeatGrid {
+        double bpm = 0.0;
+        double firstBeatSeconds = 0.0;
+
+        bool isValid() const { return bpm > 0.0; }
+
+        // position in beats, the fractional part is the phase within the beat
+        double getBeatPosition(double seconds) const { return (seconds - firstBeatSeconds) * bpm / 60.0; }
+};
+
+struct TrackAnalysis {
+        BeatGrid beatGrid;
+        // integrated loudness of the analysed audio, BS.1770 gated and K-weighted as on the master meter
+        float loudnessLufs = LevelMeter::silenceLufs;
+
+        size_t getSizeInBytes() const { return sizeof(TrackAnalysis); }
+};
+
+//==============================================================================
+/*
+ * TrackAnalyser runs per-track analysis on a background thread once a track
+ * has finished decoding, and keeps the results keyed by track identity so
+ * each track is only analysed once per session. Overview waveforms are also
+ * kept on disk, so a track seen before gets its waveform before it decodes.
+ */
+class TrackAnalyser : public MemoryGovernor::Client {
+       public:
+        TrackAnalyser();
+        ~TrackAnalyser() override;
+
+        // returns the analysis if it is done, otherwise queues it (once) and returns nullptr
+        std::shared_ptr<const TrackAnalysis> requestAnalysis(const std::shared_ptr<const DecodedTrack>& track);
+        // same for the coloured overview waveform
+        std::shared_ptr<const ColouredWaveform> requestWaveform(const std::shared_ptr<const DecodedTrack>& track);
+        // the overview waveform of a file from memory or the disk cache, without decoding it; nullptr if the
+        // file has never been analysed. Any thread.
+        std::shared_ptr<const ColouredWaveform> findCachedWaveform(const juce::File& file);
+
+        // onset-envelope autocorrelation, tempo folded into 85..170 BPM
+        static BeatGrid detectBeatGrid(const DecodedTrack& track);
+        static float measureLoudnessLufs(const DecodedTrack& track);
+        static std::shared_ptr<const TrackAnalysis> analyse(const DecodedTrack& track);
+
+        // decodes the first maxSeconds of a file on the calling thread and analyses them, nullptr on failure
+        static std::shared_ptr<const TrackAnalysis> analyseFile(const juce::File& file,
+                                                                juce::AudioFormatManager& formatManager,
+                                                                double maxSeconds = 120.0);
+
+        // MemoryGovernor::Client, results are cheap to rebuild so all of them are evictable
+        MemoryGovernor::Category getMemoryCategory() const override;
+        size_t getMemoryInUse() const override;
+        size_t releaseMemory(size_t bytesToFree, MemoryGovernor::Priority maxPriority) override;
+
+       private:
+        class AnalysisJob;
+
+        struct Entry {
+                std::shared_ptr<const TrackAnalysis> analysis;
+                std::shared_ptr<const ColouredWaveform> waveform;
+                bool analysisQueued = false;
+                bool waveformQueued = false;
+                juce::uint64 lastUsed = 0;
+
+                bool isPending() const {
+                        return (analysisQueued && analysis == nullptr) || (waveformQueued && waveform == nullptr);
+                }
+                size_t getSizeInBytes() const;
+        };
+
+        Entry& touchEntry(const juce::String& key);
+
+        // called by AnalysisJob, a null result means the track went away before it decoded
+        void storeResult(const juce::String& key, std::shared_ptr<const TrackAnalysis> analysis);
+        void storeWaveform(const juce::String& key, std::shared_ptr<const ColouredWaveform> waveform);
+        juce::File getWaveformCacheFile(const juce::String& key) const;
+
+        juce::CriticalSection lock;
+        std::map<juce::String, Entry> entries;
+        juce::uint64 useCounter = 0;
+
+        // kept with the library in the working directory
+        const juce::File waveformCacheDirectory;
+
+        // two threads, so a waveform found on disk is not stuck behind a job waiting for a decode
+        juce::ThreadPool analysisPool{2};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackAnalyser)
+};
@@ -11,18 +11,28 @@
 #include "WaveDisplay.h"
 
 #include <JuceHeader.h>
+
+#include <cstdlib>
+
+#include "Log.h"
+#include "Tracer.h"
 #include "juce_graphics/juce_graphics.h"
 
 //==============================================================================
 // constructor
-WaveDisplay::WaveDisplay(juce::AudioFormatManager& formatManagerToUse, juce::AudioThumbnailCache& cacheToUse)
-    : audioThumb(1000, formatManagerToUse, cacheToUse), fileLoaded(false), position(0) {
+WaveDisplay::WaveDisplay(juce::AudioFormatManager& formatManagerToUse, juce::AudioThumbnailCache& cacheToUse,
+                         TrackAnalyser& _trackAnalyser)
+    : audioThumb(samplesPerThumbSample, formatManagerToUse, cacheToUse),
+      trackAnalyser(_trackAnalyser),
+      fileLoaded(false),
+      position(0) {
         audioThumb.addChangeListener(this);
 }
 
 WaveDisplay::~WaveDisplay() {}
 
 void WaveDisplay::paint(juce::Graphics& g) {
+        OTODECK_TRACE_SCOPE("WaveDisplay paint");
         int relativePosition = (getWidth() * position) / 100;
         // background paint
         g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
@@ -32,8 +42,12 @@ void WaveDisplay::paint(juce::Graphics& g) {
         g.drawRect(getLocalBounds(), 1);
         g.setColour(juce::Colours::ghostwhite);
 
-        if (fileLoaded) {
-                audioThumb.drawChannel(g, getLocalBounds(), 0, audioThumb.getTotalLength(), 0, 1.0f);
+        if (waveformImage.isValid() || fileLoaded) {
+                if (waveformImage.isValid()) {
+                        g.drawImageAt(waveformImage, 0, 0);
+                } else {
+                        audioThumb.drawChannel(g, getLocalBounds(), 0, audioThumb.getTotalLength(), 0, 1.0f);
+                }
 
                 g.setOpacity(1);
                 g.setColour(juce::Colours::red);
@@ -51,17 +65,101 @@ void WaveDisplay::paint(juce::Graphics& g) {
         }
 }
 
-void WaveDisplay::resized() {}
+void WaveDisplay::resized() { renderWaveformImage(); }
 
-void WaveDisplay::loadURL(juce::URL audioURL) {
+void WaveDisplay::loadTrack(std::shared_ptr<const DecodedTrack> _track) {
         audioThumb.clear();
-        fileLoaded = audioThumb.setSource(new juce::URLInputSource(audioURL));
-
-        if (fileLoaded) {
-                DBG("Waveform loaded!");
-                repaint();
+        track = std::move(_track);
+        samplesAdded = 0;
+        fileLoaded = false;
+        waveform.reset();
+        waveformImage = {};
+        repaint();
+
+        if (track != nullptr) {
+                startTimer(40);
         } else {
-                DBG("WFD: not loaded....");
+                stopTimer();
+        }
+}
+
+void WaveDisplay::timerCallback() {
+        if (track == nullptr || track->hasFailed()) {
+                OTODECK_LOG(debug, "WaveDisplay", "Not loaded....");
+                stopTimer();
+                return;
+        }
+
+        if (waveform == nullptr) {
+                waveform = trackAnalyser.requestWaveform(track);
+
+                if (waveform != nullptr) {
+                        // the thumbnail is not needed any more
+                        OTODECK_LOG(debug, "WaveDisplay", "Coloured waveform loaded!");
+                        audioThumb.clear();
+                        fileLoaded = false;
+                        stopTimer();
+                        renderWaveformImage();
+                        repaint();
+                        return;
+                }
+        }
+
+        if (!track->isReady()) {
+                return;
+        }
+
+        if (!fileLoaded) {
+                audioThumb.reset(track->samples.getNumChannels(), track->sampleRate, track->getLengthInSamples());
+                fileLoaded = true;
+        }
+
+        const juce::int64 ready = track->getSamplesReady();
+
+        if (ready > samplesAdded) {
+                audioThumb.addBlock(samplesAdded, track->samples, (int) samplesAdded, (int) (ready - samplesAdded));
+                samplesAdded = ready;
+        }
+
+        if (track->isComplete() && samplesAdded >= track->getLengthInSamples()) {
+                // keep polling, slower, until the coloured waveform is ready
+                startTimer(200);
+        }
+}
+
+void WaveDisplay::renderWaveformImage() {
+        const int width = getWidth(), height = getHeight();
+
+        if (waveform == nullptr || width <= 0 || height <= 0) {
+                waveformImage = {};
+                return;
+        }
+
+        waveformImage = juce::Image(juce::Image::RGB, width, height, true);
+        juce::Graphics g(waveformImage);
+        g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+
+        const int numColumns = waveform->getNumColumns();
+        const float centre = height / 2.0f;
+
+        for (int x = 0; x < width; ++x) {
+                const int first = (int) ((juce::int64) x * numColumns / width);
+                const int last = juce::jmax(first + 1, (int) ((juce::int64) (x + 1) * numColumns / width));
+
+                int peak = 0, low = 0, mid = 0, high = 0;
+                for (int column = first; column < last && column < numColumns; ++column) {
+                        peak = juce::jmax(peak, (int) waveform->peaks[(size_t) column]);
+                        low += waveform->lows[(size_t) column];
+                        mid += waveform->mids[(size_t) column];
+                        high += waveform->highs[(size_t) column];
+                }
+
+                // red for bass, green for mids, blue for highs, scaled so the strongest band is at full brightness
+                const float strongest = (float) juce::jmax(1, low, mid, high);
+                g.setColour(juce::Colour::fromFloatRGBA(low / strongest, mid / strongest, high / strongest, 1.0f));
+
+                const float halfHeight = centre * peak / 255.0f;
+                g.drawVerticalLine(x, centre - halfHeight, centre + halfHeight);
         }
 }
 
@@ -69,7 +167,30 @@ void WaveDisplay::changeListenerCallback(juce::ChangeBroadcaster* source) { repa
 
 void WaveDisplay::setPositionRelative(double pos) {
         if (pos != position && pos > 0) {
+                // only the strip between the old and the new playhead changes
+                const int oldX = (int) (getWidth() * position / 100);
+                const int newX = (int) (getWidth() * pos / 100);
                 position = pos;
-                repaint();
+
+                if (oldX != newX) {
+                        repaint(juce::jmin(oldX, newX) - 2, 0, std::abs(newX - oldX) + 6, getHeight());
+                }
         }
 }
+
+MemoryGovernor::Category WaveDisplay::getMemoryCategory() const { return MemoryGovernor::Category::thumbnails; }
+
+size_t WaveDisplay::getMemoryInUse() const {
+        if (waveformImage.isValid()) {
+                return (size_t) waveformImage.getWidth() * (size_t) waveformImage.getHeight() * 3;
+        }
+        if (!fileLoaded) {
+                return 0;
+        }
+
+        // one min/max byte pair per channel for every thumbnail sample
+        const size_t thumbSamples = (size_t) (audioThumb.getNumSamplesFinished() / samplesPerThumbSample) + 1;
+        return (size_t) audioThumb.getNumChannels() * thumbSamples * 2;
+}
+
+size_t WaveDisplay::releaseMemory(size_t, MemoryGovernor::Priority) { return 0; }
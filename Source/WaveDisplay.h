@@ -12,20 +12,33 @@
 
 #include <JuceHeader.h>
 
+#include <memory>
+
+#include "ColouredWaveform.h"
+#include "DecodedAudioCache.h"
+#include "MemoryGovernor.h"
+#include "TrackAnalyser.h"
+
 //==============================================================================
 /*
  * WaveDisplay class is a component that displays the waveform of an audio file
  * using the AudioThumbnail class from JUCE. It also implements the ChangeListener
- * interface to listen for changes in the audio thumbnail.
+ * interface to listen for changes in the audio thumbnail. The thumbnail is fed
+ * from the shared decoded track, so detail fills in while the track decodes.
+ * Once the three-band waveform of the track is available it replaces the
+ * thumbnail, drawn from an image rendered once per size.
  */
 class WaveDisplay : public juce::Component,
                     // add ChangeBroadcaster listener to inheritance definition
-                    public juce::ChangeListener {
+                    public juce::ChangeListener,
+                    public MemoryGovernor::Client,
+                    private juce::Timer {
        public:
         WaveDisplay(juce::AudioFormatManager& formatManagerToUse,
                     juce::AudioThumbnailCache&
                         // constructor with AudioFormatManager and the thumbnail cache
-                        cacheToUse);
+                        cacheToUse,
+                    TrackAnalyser& trackAnalyser);
         ~WaveDisplay() override;
 
         void paint(juce::Graphics&) override;
@@ -33,13 +46,29 @@ class WaveDisplay : public juce::Component,
 
         void changeListenerCallback(juce::ChangeBroadcaster* source) override;
 
-        void loadURL(juce::URL audioURL);
+        void loadTrack(std::shared_ptr<const DecodedTrack> track);
 
         // set the relative position of the playhead
         void setPositionRelative(double pos);
 
+        // MemoryGovernor::Client, the thumbnail is on screen so it is never released
+        MemoryGovernor::Category getMemoryCategory() const override;
+        size_t getMemoryInUse() const override;
+        size_t releaseMemory(size_t bytesToFree, MemoryGovernor::Priority maxPriority) override;
+
        private:
+        // pulls newly decoded samples into the thumbnail, and asks for the coloured waveform
+        void timerCallback() override;
+        void renderWaveformImage();
+
+        static constexpr int samplesPerThumbSample = 1000;
+
         juce::AudioThumbnail audioThumb;
+        TrackAnalyser& trackAnalyser;
+        std::shared_ptr<const ColouredWaveform> waveform;
+        juce::Image waveformImage;
+        std::shared_ptr<const DecodedTrack> track;
+        juce::int64 samplesAdded = 0;
         bool fileLoaded;
         double position;
 